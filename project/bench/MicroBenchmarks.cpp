@@ -0,0 +1,927 @@
+// Microbenchmarks for the hot math, sampling and raster primitives of the software renderer
+// All inputs come from the vehicle scene, so the numbers reflect what a real frame feeds these functions
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+#include "BoundingVolumeHierarchy.h"
+#include "BoundingVolumes.h"
+#include "Camera.h"
+#include "Error.h"
+#include "FastMath.h"
+#include "FrameArena.h"
+#include "JobSystem.h"
+#include "Matrix.h"
+#include "MeshSimplification.h"
+#include "Meshlets.h"
+#include "RadixSort.h"
+#include "Rasterization.h"
+#include "RenderCommands.h"
+#include "Shading.h"
+#include "Texture.h"
+#include "Utils.h"
+#include "VectorStream.h"
+#include "VertexPacking.h"
+
+using namespace dae;
+
+namespace
+{
+constexpr int screenWidth{ 640 };
+constexpr int screenHeight{ 480 };
+
+const std::string resourcesDirectory{ BENCH_RESOURCES_DIR };
+
+// Loaded once, shared by every benchmark
+struct VehicleData final
+{
+	VehicleData();
+
+	std::vector<Vertex> vertices{};
+	std::vector<uint32_t> indices{};
+
+	Camera camera{ { 0.f, 0.f, 0.f }, 45.f, static_cast<float>( screenWidth ) / screenHeight, 0.1f, 100.f };
+	Vector3 lightDirection{ 0.577f, -0.577f, 0.577f };
+
+	std::vector<Matrix> worldMatrices{};	   // Vehicle spinning through a full turn, like in the scene
+	std::vector<Matrix> worldViewMatrices{};   // Same, but in camera space -> what gets inverted
+	std::vector<VertexOut> projectedVertices{}; // Screen space output of the first world matrix
+	std::vector<TriangleOut> visibleTriangles{}; // Front facing and on screen, the triangles that get rasterized
+	std::vector<VertexOut> pixelVertices{};		 // Attributes at the centroid of every visible triangle
+
+	Texture diffuseMap{};
+	Texture normalMap{};
+	Texture specularMap{};
+	Texture glossMap{};
+};
+
+// Mirrors Renderer::Project
+VertexOut ProjectVertex( const Vertex& vertex, const Matrix& world, const Matrix& viewProjection )
+{
+	VertexOut vertexOut{};
+	vertexOut.worldPosition = world.TransformPoint( vertex.position );
+	vertexOut.position = viewProjection.TransformPoint( vertexOut.worldPosition.ToPoint4() );
+	vertexOut.color = vertex.color;
+	vertexOut.uv = vertex.uv;
+	vertexOut.normal = world.TransformVector( vertex.normal ).Normalized();
+	vertexOut.tangent = world.TransformVector( vertex.tangent ).Normalized();
+
+	vertexOut.position.x /= vertexOut.position.w;
+	vertexOut.position.y /= vertexOut.position.w;
+	vertexOut.position.z /= vertexOut.position.w;
+
+	vertexOut.position.x = ( 1.f + vertexOut.position.x ) * 0.5f * screenWidth;
+	vertexOut.position.y = ( 1.f - vertexOut.position.y ) * 0.5f * screenHeight;
+
+	return vertexOut;
+}
+
+// Mirrors Renderer::IsCullable
+bool IsVisible( const TriangleOut& triangle )
+{
+	if ( triangle.normal.z > 0.f )
+	{
+		return false;
+	}
+
+	for ( const VertexOut* pVertex : { &triangle.v0, &triangle.v1, &triangle.v2 } )
+	{
+		const Vector4& position{ pVertex->position };
+		if ( position.z < 0.f || position.z > 1.f || position.x < 0.f || position.x > screenWidth || position.y < 0.f ||
+			 position.y > screenHeight )
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+VehicleData::VehicleData()
+{
+	if ( !Utils::ParseOBJ( resourcesDirectory + "/vehicle.obj", vertices, indices ) )
+	{
+		throw error::file::CouldNotOpenFile();
+	}
+
+	diffuseMap = Texture{ nullptr, resourcesDirectory + "/vehicle_diffuse.png" };
+	normalMap = Texture{ nullptr, resourcesDirectory + "/vehicle_normal.png" };
+	specularMap = Texture{ nullptr, resourcesDirectory + "/vehicle_specular.png" };
+	glossMap = Texture{ nullptr, resourcesDirectory + "/vehicle_gloss.png" };
+
+	const Matrix viewProjection{ camera.GetViewMatrix() * camera.GetProjectionMatrix() };
+
+	constexpr int rotationSteps{ 64 };
+	for ( int step{}; step < rotationSteps; ++step )
+	{
+		const float yaw{ static_cast<float>( step ) / rotationSteps * PI_2 };
+		const Matrix world{ Matrix::CreateRotationY( yaw ) * Matrix::CreateTranslation( 0.f, 0.f, 50.f ) };
+
+		worldMatrices.push_back( world );
+		worldViewMatrices.push_back( world * camera.GetViewMatrix() );
+	}
+
+	projectedVertices.reserve( vertices.size() );
+	for ( const Vertex& vertex : vertices )
+	{
+		projectedVertices.push_back( ProjectVertex( vertex, worldMatrices.front(), viewProjection ) );
+	}
+
+	for ( size_t index{}; index + 2 < indices.size(); index += 3 )
+	{
+		const TriangleOut triangle{ projectedVertices[indices[index + 0]],
+									projectedVertices[indices[index + 1]],
+									projectedVertices[indices[index + 2]] };
+		if ( !IsVisible( triangle ) )
+		{
+			continue;
+		}
+		visibleTriangles.push_back( triangle );
+
+		constexpr float oneThird{ 1.f / 3.f };
+		VertexOut centroid{};
+		centroid.position = ( triangle.v0.position + triangle.v1.position + triangle.v2.position ) * oneThird;
+		centroid.worldPosition =
+			( triangle.v0.worldPosition + triangle.v1.worldPosition + triangle.v2.worldPosition ) * oneThird;
+		centroid.uv = ( triangle.v0.uv + triangle.v1.uv + triangle.v2.uv ) * oneThird;
+		centroid.normal = ( triangle.v0.normal + triangle.v1.normal + triangle.v2.normal ).Normalized();
+		centroid.tangent = ( triangle.v0.tangent + triangle.v1.tangent + triangle.v2.tangent ).Normalized();
+		pixelVertices.push_back( centroid );
+	}
+}
+
+const VehicleData& GetVehicleData()
+{
+	static const VehicleData vehicleData{};
+	return vehicleData;
+}
+
+// Cycles through the inputs without a modulo in the timed loop
+size_t NextIndex( size_t index, size_t count )
+{
+	return ( index + 1 == count ) ? 0 : index + 1;
+}
+} // namespace
+
+// MATH
+static void BM_MatrixMultiply( benchmark::State& state )
+{
+	const VehicleData& data{ GetVehicleData() };
+	const Matrix viewProjection{ data.camera.GetViewMatrix() * data.camera.GetProjectionMatrix() };
+
+	size_t index{};
+	for ( auto _ : state )
+	{
+		benchmark::DoNotOptimize( data.worldMatrices[index] * viewProjection );
+		index = NextIndex( index, data.worldMatrices.size() );
+	}
+	state.SetItemsProcessed( state.iterations() );
+}
+BENCHMARK( BM_MatrixMultiply );
+
+static void BM_MatrixInverse( benchmark::State& state )
+{
+	const VehicleData& data{ GetVehicleData() };
+
+	size_t index{};
+	for ( auto _ : state )
+	{
+		benchmark::DoNotOptimize( Matrix::Inverse( data.worldViewMatrices[index] ) );
+		index = NextIndex( index, data.worldViewMatrices.size() );
+	}
+	state.SetItemsProcessed( state.iterations() );
+}
+BENCHMARK( BM_MatrixInverse );
+
+static void BM_TransformPoint( benchmark::State& state )
+{
+	const VehicleData& data{ GetVehicleData() };
+	const Matrix worldViewProjection{ data.worldMatrices.front() * data.camera.GetViewMatrix() *
+									  data.camera.GetProjectionMatrix() };
+
+	size_t index{};
+	for ( auto _ : state )
+	{
+		benchmark::DoNotOptimize( worldViewProjection.TransformPoint( data.vertices[index].position.ToPoint4() ) );
+		index = NextIndex( index, data.vertices.size() );
+	}
+	state.SetItemsProcessed( state.iterations() );
+}
+BENCHMARK( BM_TransformPoint );
+
+// Whole vehicle per iteration, the batch Renderer::Project runs
+static void BM_TransformPointStream( benchmark::State& state )
+{
+	const VehicleData& data{ GetVehicleData() };
+	const Matrix worldViewProjection{ data.worldMatrices.front() * data.camera.GetViewMatrix() *
+									  data.camera.GetProjectionMatrix() };
+	const VertexStreams streams{ streamUtils::ToStreams( data.vertices ) };
+
+	Vector4Stream projected{};
+	for ( auto _ : state )
+	{
+		streamUtils::TransformPoints( worldViewProjection, streams.positions, projected );
+		benchmark::DoNotOptimize( projected.x.data() );
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed( state.iterations() * static_cast<int64_t>( streams.Size() ) );
+}
+BENCHMARK( BM_TransformPointStream );
+
+// What a mesh costs per frame to be culled: moving its bounds to world space and testing them
+static void BM_MeshFrustumTest( benchmark::State& state )
+{
+	const VehicleData& data{ GetVehicleData() };
+	const Frustum frustum{ Frustum::FromViewProjection( data.camera.GetViewMatrix() *
+														data.camera.GetProjectionMatrix() ) };
+	const BoundingBox localBounds{ BoundingBox::FromVertices( data.vertices ) };
+	const BoundingSphere localSphere{ BoundingSphere::FromVertices( data.vertices ) };
+
+	size_t index{};
+	for ( auto _ : state )
+	{
+		const Matrix& world{ data.worldMatrices[index] };
+		const BoundingSphere worldSphere{ localSphere.Transformed( world ) };
+		const BoundingBox worldBounds{ localBounds.Transformed( world ) };
+		benchmark::DoNotOptimize( frustum.Intersects( worldSphere ) && frustum.Intersects( worldBounds ) );
+		index = NextIndex( index, data.worldMatrices.size() );
+	}
+	state.SetItemsProcessed( state.iterations() );
+}
+BENCHMARK( BM_MeshFrustumTest );
+
+// Per copy cost of culling the vehicle's meshlets, and how many of its vertices never get projected
+static void BM_CullMeshlets( benchmark::State& state )
+{
+	const VehicleData& data{ GetVehicleData() };
+	const Matrix viewProjection{ data.camera.GetViewMatrix() * data.camera.GetProjectionMatrix() };
+	std::vector<Meshlet> meshlets{};
+	std::vector<Vertex> meshletVertices{};
+	std::vector<uint8_t> meshletTriangles{};
+	BuildMeshlets( data.vertices, data.indices, 0, data.indices.size(), meshlets, meshletVertices, meshletTriangles );
+	const BoundingBox localBounds{ BoundingBox::FromVertices( data.vertices ) };
+
+	size_t index{};
+	size_t culledVertexCount{};
+	for ( auto _ : state )
+	{
+		const MeshletCullView view{ MeshletCullView::Create(
+			data.worldMatrices[index], viewProjection, data.camera.GetPosition(), localBounds ) };
+		for ( const Meshlet& meshlet : meshlets )
+		{
+			if ( IsMeshletCullable( meshlet, view ) )
+			{
+				culledVertexCount += meshlet.vertexCount;
+			}
+		}
+		index = NextIndex( index, data.worldMatrices.size() );
+	}
+	state.SetItemsProcessed( state.iterations() * meshlets.size() );
+	state.counters["culledVertices"] =
+		static_cast<double>( culledVertexCount ) / ( state.iterations() * meshletVertices.size() );
+}
+BENCHMARK( BM_CullMeshlets );
+
+// Every meshlet vertex of the vehicle gathered into one batch, copied as floats (0) or decoded from PackedVertex (1)
+static void BM_GatherMeshletVertices( benchmark::State& state )
+{
+	const VehicleData& data{ GetVehicleData() };
+	std::vector<Meshlet> meshlets{};
+	std::vector<Vertex> meshletVertices{};
+	std::vector<uint8_t> meshletTriangles{};
+	BuildMeshlets( data.vertices, data.indices, 0, data.indices.size(), meshlets, meshletVertices, meshletTriangles );
+
+	const bool isPacked{ state.range( 0 ) == 1 };
+	const PositionDequantization dequantization{ PositionDequantization::FromBounds(
+		BoundingBox::FromVertices( data.vertices ) ) };
+	const VertexStreams streams{ streamUtils::ToStreams( meshletVertices ) };
+	const std::vector<PackedVertex> packed{ PackVertices( meshletVertices, dequantization ) };
+
+	VertexStreams gathered{};
+	gathered.Resize( meshletVertices.size() );
+	for ( auto _ : state )
+	{
+		for ( const Meshlet& meshlet : meshlets )
+		{
+			if ( isPacked )
+			{
+				UnpackRange( packed, meshlet.firstVertex, meshlet.vertexCount, dequantization, gathered, meshlet.firstVertex );
+			}
+			else
+			{
+				streamUtils::CopyRange( streams, meshlet.firstVertex, meshlet.vertexCount, gathered, meshlet.firstVertex );
+			}
+		}
+		benchmark::DoNotOptimize( gathered.positions.x.data() );
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed( state.iterations() * static_cast<int64_t>( meshletVertices.size() ) );
+	state.counters["bytesPerVertex"] = static_cast<double>( isPacked ? sizeof( PackedVertex ) : 14 * sizeof( float ) );
+}
+BENCHMARK( BM_GatherMeshletVertices )->ArgName( "packed" )->Arg( 0 )->Arg( 1 );
+
+// Mesh sized boxes scattered around the camera, the frustum sees roughly a tenth of them
+std::vector<BoundingBox> CreateScatteredBounds( size_t count )
+{
+	std::mt19937 generator{ 1234 };
+	std::uniform_real_distribution<float> positionDistribution{ -100.f, 100.f };
+	std::uniform_real_distribution<float> sizeDistribution{ 0.5f, 4.f };
+
+	std::vector<BoundingBox> bounds{};
+	bounds.reserve( count );
+	for ( size_t boundsIdx{}; boundsIdx < count; ++boundsIdx )
+	{
+		const Vector3 center{ positionDistribution( generator ),
+							  positionDistribution( generator ),
+							  positionDistribution( generator ) };
+		const Vector3 extents{ sizeDistribution( generator ),
+							   sizeDistribution( generator ),
+							   sizeDistribution( generator ) };
+		bounds.push_back( { center - extents, center + extents } );
+	}
+	return bounds;
+}
+
+static void BM_CullLinear( benchmark::State& state )
+{
+	const VehicleData& data{ GetVehicleData() };
+	const Frustum& frustum{ data.camera.GetFrustum() };
+	const std::vector<BoundingBox> bounds{ CreateScatteredBounds( static_cast<size_t>( state.range( 0 ) ) ) };
+
+	std::vector<uint32_t> visibleIndices{};
+	for ( auto _ : state )
+	{
+		visibleIndices.clear();
+		for ( uint32_t boundsIdx{}; boundsIdx < bounds.size(); ++boundsIdx )
+		{
+			if ( frustum.Intersects( bounds[boundsIdx] ) )
+			{
+				visibleIndices.push_back( boundsIdx );
+			}
+		}
+		benchmark::DoNotOptimize( visibleIndices.data() );
+	}
+	state.SetItemsProcessed( state.iterations() * state.range( 0 ) );
+}
+BENCHMARK( BM_CullLinear )->ArgName( "objects" )->Arg( 100 )->Arg( 1000 )->Arg( 10000 );
+
+static void BM_CullHierarchy( benchmark::State& state )
+{
+	const VehicleData& data{ GetVehicleData() };
+	const Frustum& frustum{ data.camera.GetFrustum() };
+	BoundingVolumeHierarchy hierarchy{};
+	hierarchy.Build( CreateScatteredBounds( static_cast<size_t>( state.range( 0 ) ) ) );
+
+	std::vector<uint32_t> visibleIndices{};
+	for ( auto _ : state )
+	{
+		visibleIndices.clear();
+		hierarchy.QueryFrustum( frustum, visibleIndices );
+		benchmark::DoNotOptimize( visibleIndices.data() );
+	}
+	state.SetItemsProcessed( state.iterations() * state.range( 0 ) );
+}
+BENCHMARK( BM_CullHierarchy )->ArgName( "objects" )->Arg( 100 )->Arg( 1000 )->Arg( 10000 );
+
+// One object moving per frame
+static void BM_HierarchyRefit( benchmark::State& state )
+{
+	const std::vector<BoundingBox> bounds{ CreateScatteredBounds( static_cast<size_t>( state.range( 0 ) ) ) };
+	BoundingVolumeHierarchy hierarchy{};
+	hierarchy.Build( bounds );
+
+	uint32_t boundsIdx{};
+	for ( auto _ : state )
+	{
+		hierarchy.UpdateItem( boundsIdx, bounds[boundsIdx] );
+		boundsIdx = static_cast<uint32_t>( NextIndex( boundsIdx, bounds.size() ) );
+	}
+	state.SetItemsProcessed( state.iterations() );
+}
+BENCHMARK( BM_HierarchyRefit )->ArgName( "objects" )->Arg( 100 )->Arg( 1000 )->Arg( 10000 );
+
+// A frame worth of draws: a few materials, depths all over the view, a tenth of them transparent
+RenderCommandList CreateRenderCommands( uint32_t count )
+{
+	std::mt19937 generator{ 1234 };
+	std::uniform_real_distribution<float> depthDistribution{ 0.f, 1.f };
+	std::uniform_int_distribution<int> materialDistribution{ 0, 31 };
+
+	RenderCommandList commands{};
+	for ( uint32_t meshIdx{}; meshIdx < count; ++meshIdx )
+	{
+		const float depth{ depthDistribution( generator ) };
+		if ( meshIdx % 10 == 0 )
+		{
+			commands.Add( { RenderCommandList::MakeTransparentKey( depth ),
+							meshIdx,
+							0,
+							RenderPass::transparent } );
+			continue;
+		}
+
+		const uint16_t materialId{ static_cast<uint16_t>( materialDistribution( generator ) ) };
+		commands.Add( { RenderCommandList::MakeOpaqueKey( materialId, depth ),
+						meshIdx,
+						materialId,
+						RenderPass::opaque } );
+	}
+	return commands;
+}
+
+static void BM_SortCommandsRadix( benchmark::State& state )
+{
+	const RenderCommandList unsorted{ CreateRenderCommands( static_cast<uint32_t>( state.range( 0 ) ) ) };
+	RenderCommandList commands{};
+	for ( auto _ : state )
+	{
+		commands = unsorted; // Same copy in both sort benchmarks, pausing the timer costs more than it
+		commands.Sort();
+		benchmark::DoNotOptimize( commands.GetCommands().data() );
+	}
+	state.SetItemsProcessed( state.iterations() * state.range( 0 ) );
+}
+BENCHMARK( BM_SortCommandsRadix )->ArgName( "commands" )->Arg( 100 )->Arg( 1000 )->Arg( 10000 );
+
+static void BM_SortCommandsStd( benchmark::State& state )
+{
+	const RenderCommandList unsorted{ CreateRenderCommands( static_cast<uint32_t>( state.range( 0 ) ) ) };
+	std::vector<RenderCommand> commands{};
+	for ( auto _ : state )
+	{
+		commands = unsorted.GetCommands();
+		std::stable_sort( commands.begin(), commands.end(), []( const RenderCommand& lhs, const RenderCommand& rhs ) {
+			return lhs.sortKey < rhs.sortKey;
+		} );
+		benchmark::DoNotOptimize( commands.data() );
+	}
+	state.SetItemsProcessed( state.iterations() * state.range( 0 ) );
+}
+BENCHMARK( BM_SortCommandsStd )->ArgName( "commands" )->Arg( 100 )->Arg( 1000 )->Arg( 10000 );
+
+static void BM_Vector3Normalize( benchmark::State& state )
+{
+	const VehicleData& data{ GetVehicleData() };
+	const MathPrecision precision{ static_cast<MathPrecision>( state.range( 0 ) ) };
+
+	// Interpolated normals are never unit length, scale the mesh normals to match
+	std::vector<Vector3> normals{};
+	normals.reserve( data.vertices.size() );
+	for ( size_t vertexIdx{}; vertexIdx < data.vertices.size(); ++vertexIdx )
+	{
+		normals.push_back( data.vertices[vertexIdx].normal * ( 0.5f + ( vertexIdx % 7 ) * 0.1f ) );
+	}
+
+	size_t index{};
+	for ( auto _ : state )
+	{
+		Vector3 normal{ normals[index] };
+		fastMath::Normalize( normal, precision );
+		benchmark::DoNotOptimize( normal );
+		index = NextIndex( index, normals.size() );
+	}
+	state.SetItemsProcessed( state.iterations() );
+}
+BENCHMARK( BM_Vector3Normalize )->ArgName( "precision" )->DenseRange( 0, static_cast<int>( MathPrecision::count ) - 1 );
+
+// Phong lobe: closing factors in [0, 1] raised to gloss * shininess
+static void BM_PhongPow( benchmark::State& state )
+{
+	const MathPrecision precision{ static_cast<MathPrecision>( state.range( 0 ) ) };
+
+	constexpr size_t sampleCount{ 1024 };
+	std::vector<float> bases( sampleCount );
+	std::vector<float> exponents( sampleCount );
+	for ( size_t sampleIdx{}; sampleIdx < sampleCount; ++sampleIdx )
+	{
+		bases[sampleIdx] = static_cast<float>( ( sampleIdx * 37 ) % sampleCount ) / sampleCount;
+		exponents[sampleIdx] = 25.f * static_cast<float>( ( sampleIdx * 91 ) % sampleCount ) / sampleCount;
+	}
+
+	size_t index{};
+	for ( auto _ : state )
+	{
+		benchmark::DoNotOptimize( fastMath::Pow( bases[index], exponents[index], precision ) );
+		index = NextIndex( index, sampleCount );
+	}
+	state.SetItemsProcessed( state.iterations() );
+}
+BENCHMARK( BM_PhongPow )->ArgName( "precision" )->DenseRange( 0, static_cast<int>( MathPrecision::count ) - 1 );
+
+// SAMPLING
+static void BM_TextureSample( benchmark::State& state )
+{
+	const VehicleData& data{ GetVehicleData() };
+	const FilterMode filterMode{ static_cast<FilterMode>( state.range( 0 ) ) };
+
+	size_t index{};
+	for ( auto _ : state )
+	{
+		benchmark::DoNotOptimize( data.diffuseMap.Sample( data.pixelVertices[index].uv, filterMode ) );
+		index = NextIndex( index, data.pixelVertices.size() );
+	}
+	state.SetItemsProcessed( state.iterations() );
+}
+BENCHMARK( BM_TextureSample )
+	->ArgName( "filter" )
+	->Arg( static_cast<int>( FilterMode::point ) )
+	->Arg( static_cast<int>( FilterMode::linear ) );
+
+static void BM_GetPixelColor( benchmark::State& state )
+{
+	const VehicleData& data{ GetVehicleData() };
+	const LightingMode lightingMode{ static_cast<LightingMode>( state.range( 0 ) ) };
+	const bool useNormalMap{ state.range( 1 ) != 0 };
+	const MathPrecision precision{ static_cast<MathPrecision>( state.range( 2 ) ) };
+
+	size_t index{};
+	for ( auto _ : state )
+	{
+		benchmark::DoNotOptimize( GetPixelColor( data.pixelVertices[index],
+												 data.diffuseMap,
+												 data.normalMap,
+												 data.specularMap,
+												 data.glossMap,
+												 data.camera,
+												 data.lightDirection,
+												 lightingMode,
+												 useNormalMap,
+												 FilterMode::point,
+												 precision ) );
+		index = NextIndex( index, data.pixelVertices.size() );
+	}
+	state.SetItemsProcessed( state.iterations() );
+}
+BENCHMARK( BM_GetPixelColor )
+	->ArgNames( { "lighting", "normalMap", "precision" } )
+	->ArgsProduct( { benchmark::CreateDenseRange( 0, static_cast<int>( LightingMode::count ) - 1, 1 ),
+					 { 0, 1 },
+					 benchmark::CreateDenseRange( 0, static_cast<int>( MathPrecision::count ) - 1, 1 ) } );
+
+// RASTERIZATION
+static void BM_TriangleOutConstruction( benchmark::State& state )
+{
+	const VehicleData& data{ GetVehicleData() };
+
+	size_t index{};
+	for ( auto _ : state )
+	{
+		benchmark::DoNotOptimize( TriangleOut{ data.projectedVertices[data.indices[index + 0]],
+											   data.projectedVertices[data.indices[index + 1]],
+											   data.projectedVertices[data.indices[index + 2]] } );
+		index = ( index + 3 < data.indices.size() - 2 ) ? index + 3 : 0;
+	}
+	state.SetItemsProcessed( state.iterations() );
+}
+BENCHMARK( BM_TriangleOutConstruction );
+
+// Tests every pixel in the bounds of one visible triangle per iteration, like the raster loop does
+static void BM_IsInPixel( benchmark::State& state )
+{
+	const VehicleData& data{ GetVehicleData() };
+
+	int64_t pixelCount{};
+	size_t index{};
+	for ( auto _ : state )
+	{
+		const TriangleOut& triangle{ data.visibleTriangles[index] };
+		const Rectangle bounds{ triangle.GetBounds() };
+		const int boundsLeft{ static_cast<int>( std::floor( bounds.left ) ) };
+		const int boundsRight{ static_cast<int>( std::ceil( bounds.right ) ) };
+		const int boundsTop{ static_cast<int>( std::floor( bounds.top ) ) };
+		const int boundsBottom{ static_cast<int>( std::ceil( bounds.bottom ) ) };
+
+		for ( int px{ boundsLeft }; px < boundsRight; ++px )
+		{
+			for ( int py{ boundsTop }; py < boundsBottom; ++py )
+			{
+				Vector3 baryCentricPosition{};
+				benchmark::DoNotOptimize( IsInPixel( triangle, px, py, baryCentricPosition ) );
+				benchmark::DoNotOptimize( baryCentricPosition );
+			}
+		}
+		pixelCount += static_cast<int64_t>( boundsRight - boundsLeft ) * ( boundsBottom - boundsTop );
+		index = NextIndex( index, data.visibleTriangles.size() );
+	}
+	state.SetItemsProcessed( pixelCount );
+}
+BENCHMARK( BM_IsInPixel );
+
+// Same triangles as BM_IsInPixel, but every pixel gets a coverage mask over the 4x sample pattern
+static void BM_SampleCoverage( benchmark::State& state )
+{
+	const VehicleData& data{ GetVehicleData() };
+
+	int64_t pixelCount{};
+	size_t index{};
+	for ( auto _ : state )
+	{
+		const TriangleOut& triangle{ data.visibleTriangles[index] };
+		const Rectangle bounds{ triangle.GetBounds() };
+		const int boundsLeft{ static_cast<int>( std::floor( bounds.left ) ) };
+		const int boundsRight{ static_cast<int>( std::ceil( bounds.right ) ) };
+		const int boundsTop{ static_cast<int>( std::floor( bounds.top ) ) };
+		const int boundsBottom{ static_cast<int>( std::ceil( bounds.bottom ) ) };
+
+		for ( int px{ boundsLeft }; px < boundsRight; ++px )
+		{
+			for ( int py{ boundsTop }; py < boundsBottom; ++py )
+			{
+				uint32_t coverage{};
+				for ( int sampleIdx{}; sampleIdx < msaaSampleCount; ++sampleIdx )
+				{
+					Vector3 baryCentricPosition{};
+					const Vector2 samplePosition{ px + msaaSampleOffsetsX[sampleIdx],
+												  py + msaaSampleOffsetsY[sampleIdx] };
+					if ( GetBarycentricWeights( triangle, samplePosition, baryCentricPosition ) &&
+						 baryCentricPosition.x >= 0.f && baryCentricPosition.y >= 0.f && baryCentricPosition.z >= 0.f )
+					{
+						coverage |= 1u << sampleIdx;
+					}
+				}
+				benchmark::DoNotOptimize( coverage );
+			}
+		}
+		pixelCount += static_cast<int64_t>( boundsRight - boundsLeft ) * ( boundsBottom - boundsTop );
+		index = NextIndex( index, data.visibleTriangles.size() );
+	}
+	state.SetItemsProcessed( pixelCount );
+}
+BENCHMARK( BM_SampleCoverage );
+
+// Full screen of samples, one pixel in 8 on an edge with differing samples
+static void BM_ResolveSamples( benchmark::State& state )
+{
+	constexpr int pixelCount{ screenWidth * screenHeight };
+	std::mt19937 generator{ 1234 };
+	std::uniform_int_distribution<uint32_t> pixelDistribution{};
+
+	std::vector<uint32_t> samples( pixelCount * msaaSampleCount );
+	for ( int pixelIndex{}; pixelIndex < pixelCount; ++pixelIndex )
+	{
+		const uint32_t interiorColor{ pixelDistribution( generator ) };
+		for ( int sampleIdx{}; sampleIdx < msaaSampleCount; ++sampleIdx )
+		{
+			samples[pixelIndex * msaaSampleCount + sampleIdx] =
+				pixelIndex % 8 == 0 ? pixelDistribution( generator ) : interiorColor;
+		}
+	}
+
+	std::vector<uint32_t> pixels( pixelCount );
+	for ( auto _ : state )
+	{
+		ResolveSamples( samples.data(), pixels.data(), pixelCount );
+		benchmark::DoNotOptimize( pixels.data() );
+	}
+	state.SetItemsProcessed( state.iterations() * pixelCount );
+}
+BENCHMARK( BM_ResolveSamples );
+
+// The same resolve split into row chunks over the job system, thread count includes the calling thread
+static void BM_ParallelForResolve( benchmark::State& state )
+{
+	constexpr int pixelCount{ screenWidth * screenHeight };
+	constexpr size_t rowsPerJob{ 32 };
+	std::mt19937 generator{ 1234 };
+	std::uniform_int_distribution<uint32_t> pixelDistribution{};
+
+	std::vector<uint32_t> samples( pixelCount * msaaSampleCount );
+	for ( uint32_t& sample : samples )
+	{
+		sample = pixelDistribution( generator );
+	}
+
+	JobSystem jobSystem{ static_cast<int>( state.range( 0 ) ) };
+	std::vector<uint32_t> pixels( pixelCount );
+	for ( auto _ : state )
+	{
+		jobSystem.ParallelFor( screenHeight, rowsPerJob, [&]( size_t firstRow, size_t rowEnd ) {
+			const size_t firstPixel{ firstRow * screenWidth };
+			ResolveSamples( samples.data() + firstPixel * msaaSampleCount,
+							pixels.data() + firstPixel,
+							static_cast<int>( ( rowEnd - firstRow ) * screenWidth ) );
+		} );
+		benchmark::DoNotOptimize( pixels.data() );
+	}
+	state.SetItemsProcessed( state.iterations() * pixelCount );
+}
+BENCHMARK( BM_ParallelForResolve )->ArgName( "threads" )->Arg( 1 )->Arg( 2 )->Arg( 4 )->Arg( 8 )->UseRealTime();
+
+// Building and running a graph shaped like the software frame's, vertex -> bin -> raster for every copy
+// Without the arena every task and every dependency list goes through the heap, every frame
+static void BM_FrameGraph( benchmark::State& state )
+{
+	constexpr size_t copyCount{ 256 };
+	const bool useArena{ state.range( 0 ) != 0 };
+
+	JobSystem jobSystem{ 2 };
+	FrameArena arena{ jobSystem };
+	TaskGraph graph{ useArena ? static_cast<std::pmr::memory_resource*>( &arena ) : std::pmr::get_default_resource() };
+	std::vector<uint64_t> stageSums( copyCount * 3 );
+	for ( auto _ : state )
+	{
+		graph.Clear();
+		arena.Reset();
+
+		TaskGraph::TaskId lastRasterTask{};
+		for ( size_t copyIdx{}; copyIdx < copyCount; ++copyIdx )
+		{
+			// Captures as wide as the frame's, too wide for std::function to keep inline
+			uint64_t* pSums{ stageSums.data() + copyIdx * 3 };
+			const TaskGraph::TaskId vertexTask{ graph.Add( "Vertex", [pSums, copyIdx, &stageSums]() {
+				pSums[0] += copyIdx + stageSums.size();
+			} ) };
+			const TaskGraph::TaskId binTask{ graph.Add( "Bin", [pSums, copyIdx, &stageSums]() {
+				pSums[1] += pSums[0] + copyIdx + stageSums.size();
+			} ) };
+			const TaskGraph::TaskId rasterTask{ graph.Add( "Raster", [pSums, copyIdx, &stageSums]() {
+				pSums[2] += pSums[1] + copyIdx + stageSums.size();
+			} ) };
+			graph.AddDependency( binTask, vertexTask );
+			graph.AddDependency( rasterTask, binTask );
+			if ( copyIdx )
+			{
+				graph.AddDependency( rasterTask, lastRasterTask );
+			}
+			lastRasterTask = rasterTask;
+		}
+		graph.Run( jobSystem );
+		benchmark::DoNotOptimize( stageSums.data() );
+	}
+	state.SetItemsProcessed( state.iterations() * copyCount * 3 );
+	state.counters["arenaChunks"] = static_cast<double>( arena.GetChunkAllocationCount() );
+}
+BENCHMARK( BM_FrameGraph )->ArgName( "arena" )->Arg( 0 )->Arg( 1 )->UseRealTime();
+
+// Render scale per axis in percent to the full screen, what dynamic resolution adds to a frame
+static void BM_UpscaleBilinear( benchmark::State& state )
+{
+	const int sourceWidth{ static_cast<int>( screenWidth * state.range( 0 ) / 100 ) };
+	const int sourceHeight{ static_cast<int>( screenHeight * state.range( 0 ) / 100 ) };
+	std::mt19937 generator{ 1234 };
+	std::uniform_int_distribution<uint32_t> pixelDistribution{};
+
+	std::vector<uint32_t> source( sourceWidth * sourceHeight );
+	for ( uint32_t& pixel : source )
+	{
+		pixel = pixelDistribution( generator );
+	}
+
+	std::vector<uint32_t> destination( screenWidth * screenHeight );
+	std::vector<uint32_t> rowScratch( 2 * screenWidth );
+	const PixelRect screenRect{ 0, 0, screenWidth, screenHeight };
+	for ( auto _ : state )
+	{
+		UpscaleBilinear( source.data(),
+						 sourceWidth,
+						 sourceHeight,
+						 destination.data(),
+						 screenWidth,
+						 screenHeight,
+						 screenRect,
+						 rowScratch.data() );
+		benchmark::DoNotOptimize( destination.data() );
+	}
+	state.SetItemsProcessed( state.iterations() * screenWidth * screenHeight );
+}
+BENCHMARK( BM_UpscaleBilinear )->Arg( 50 )->Arg( 75 );
+
+// One screen row per iteration, a quarter of the pixels uncovered like the corners of a triangle span
+struct BlendRows final
+{
+	std::vector<uint32_t> destination{};
+	std::vector<uint32_t> source{};
+	std::vector<uint8_t> alpha{};
+};
+
+BlendRows CreateBlendRows()
+{
+	std::mt19937 generator{ 1234 };
+	std::uniform_int_distribution<uint32_t> pixelDistribution{};
+	std::uniform_int_distribution<int> alphaDistribution{ 1, 255 };
+
+	BlendRows rows{};
+	for ( int px{}; px < screenWidth; ++px )
+	{
+		rows.destination.push_back( pixelDistribution( generator ) );
+		rows.source.push_back( pixelDistribution( generator ) );
+		rows.alpha.push_back( px % 4 == 0 ? 0 : static_cast<uint8_t>( alphaDistribution( generator ) ) );
+	}
+	return rows;
+}
+
+static void BM_BlendSpan( benchmark::State& state )
+{
+	BlendRows rows{ CreateBlendRows() };
+	for ( auto _ : state )
+	{
+		BlendSpan( rows.destination.data(), rows.source.data(), rows.alpha.data(), screenWidth );
+		benchmark::DoNotOptimize( rows.destination.data() );
+	}
+	state.SetItemsProcessed( state.iterations() * screenWidth );
+}
+BENCHMARK( BM_BlendSpan );
+
+static void BM_BlendPixel( benchmark::State& state )
+{
+	BlendRows rows{ CreateBlendRows() };
+	for ( auto _ : state )
+	{
+		for ( int px{}; px < screenWidth; ++px )
+		{
+			if ( rows.alpha[px] != 0 )
+			{
+				rows.destination[px] = BlendPixel( rows.destination[px], rows.source[px], rows.alpha[px] );
+			}
+		}
+		benchmark::DoNotOptimize( rows.destination.data() );
+	}
+	state.SetItemsProcessed( state.iterations() * screenWidth );
+}
+BENCHMARK( BM_BlendPixel );
+
+// Back to front keys of every visible vehicle triangle, built the way Renderer::RasterizeTransparentMesh does
+struct DepthSortedTriangle final
+{
+	uint32_t sortKey{};
+	uint32_t triangleIdx{};
+};
+
+std::vector<DepthSortedTriangle> CreateDepthSortedTriangles()
+{
+	const VehicleData& data{ GetVehicleData() };
+
+	std::vector<DepthSortedTriangle> triangles{};
+	for ( const TriangleOut& triangle : data.visibleTriangles )
+	{
+		const float depthSum{ triangle.v0.position.w + triangle.v1.position.w + triangle.v2.position.w };
+		triangles.push_back( { ~std::bit_cast<uint32_t>( depthSum ), static_cast<uint32_t>( triangles.size() ) } );
+	}
+	return triangles;
+}
+
+static void BM_SortTrianglesRadix( benchmark::State& state )
+{
+	const std::vector<DepthSortedTriangle> unsorted{ CreateDepthSortedTriangles() };
+	std::vector<DepthSortedTriangle> triangles{};
+	std::vector<DepthSortedTriangle> scratch{};
+	for ( auto _ : state )
+	{
+		triangles = unsorted;
+		RadixSort( triangles, scratch, []( const DepthSortedTriangle& triangle ) { return triangle.sortKey; } );
+		benchmark::DoNotOptimize( triangles.data() );
+	}
+	state.SetItemsProcessed( state.iterations() * unsorted.size() );
+}
+BENCHMARK( BM_SortTrianglesRadix );
+
+static void BM_SortTrianglesStd( benchmark::State& state )
+{
+	const std::vector<DepthSortedTriangle> unsorted{ CreateDepthSortedTriangles() };
+	std::vector<DepthSortedTriangle> triangles{};
+	for ( auto _ : state )
+	{
+		triangles = unsorted;
+		std::stable_sort( triangles.begin(),
+						  triangles.end(),
+						  []( const DepthSortedTriangle& lhs, const DepthSortedTriangle& rhs ) {
+							  return lhs.sortKey < rhs.sortKey;
+						  } );
+		benchmark::DoNotOptimize( triangles.data() );
+	}
+	state.SetItemsProcessed( state.iterations() * unsorted.size() );
+}
+BENCHMARK( BM_SortTrianglesStd );
+
+// Load time cost of the vehicle's LOD chain
+static void BM_BuildLodChain( benchmark::State& state )
+{
+	const VehicleData& data{ GetVehicleData() };
+	for ( auto _ : state )
+	{
+		std::vector<std::vector<uint32_t>> levels{ BuildLodChain( data.vertices, data.indices, { 0.5f, 0.25f, 0.125f } ) };
+		benchmark::DoNotOptimize( levels.data() );
+	}
+	state.SetItemsProcessed( state.iterations() * data.indices.size() / 3 );
+}
+BENCHMARK( BM_BuildLodChain )->Unit( benchmark::kMillisecond );
+
+int main( int argc, char** argv )
+{
+	// Load up front, so a missing resource fails loudly instead of inside a timed loop
+	if ( error::utils::HandleThrowingFunction( []() { GetVehicleData(); } ) )
+	{
+		return 1;
+	}
+
+	benchmark::Initialize( &argc, argv );
+	if ( benchmark::ReportUnrecognizedArguments( argc, argv ) )
+	{
+		return 1;
+	}
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+	return 0;
+}
@@ -31,7 +31,10 @@ DepthStencilState gDepthStencilState
 // Camera & Worldspace
 float4x4 gWorldViewProj : WorldViewProjection;
 float4x4 gWorld : World;
+float4x4 gViewProj : ViewProjection; // Instanced only, the world part differs per instance
 float4 gCameraOrigin : CameraOrigin;
+float4 gPositionOffset : PositionOffset; // Packed only, model space position = offset + packed position * scale
+float4 gPositionScale : PositionScale;
 
 // Textures
 Texture2D gDiffuseMap : DiffuseMap;
@@ -52,6 +55,41 @@ struct VS_INPUT
 	float3 Tangent : TANGENT;
 };
 
+// Per-instance world matrix, one row per element, applied before gWorld
+struct VS_INSTANCED_INPUT
+{
+	float3 Position : POSITION;
+	float3 Color : COLOR;
+	float2 UV : TEXCOORD;
+	float3 Normal : NORMAL;
+	float3 Tangent : TANGENT;
+	float4 InstanceWorld0 : INSTANCEWORLD0;
+	float4 InstanceWorld1 : INSTANCEWORLD1;
+	float4 InstanceWorld2 : INSTANCEWORLD2;
+	float4 InstanceWorld3 : INSTANCEWORLD3;
+};
+
+// PackedVertex: position normalized within the mesh bounds, octahedral normal and tangent, half float uv
+struct VS_PACKED_INPUT
+{
+	float4 Position : POSITION;
+	float2 Normal : NORMAL;
+	float2 Tangent : TANGENT;
+	float2 UV : TEXCOORD;
+};
+
+struct VS_PACKED_INSTANCED_INPUT
+{
+	float4 Position : POSITION;
+	float2 Normal : NORMAL;
+	float2 Tangent : TANGENT;
+	float2 UV : TEXCOORD;
+	float4 InstanceWorld0 : INSTANCEWORLD0;
+	float4 InstanceWorld1 : INSTANCEWORLD1;
+	float4 InstanceWorld2 : INSTANCEWORLD2;
+	float4 InstanceWorld3 : INSTANCEWORLD3;
+};
+
 struct VS_OUTPUT
 {
 	float4 Position : SV_POSITION;
@@ -81,6 +119,25 @@ float3 GetSampledNormal(float2 uv, float3 normal, float3 tangent)
 	return mul(sampledNormal, TBN);
 }
 
+float3 DecodeOctahedral(float2 encoded)
+{
+	float3 direction = float3(encoded, 1.f - abs(encoded.x) - abs(encoded.y));
+	const float fold = saturate(-direction.z);
+	direction.xy += (direction.xy >= 0.f) ? -fold : fold;
+	return normalize(direction);
+}
+
+// Color is not packed, nothing shades with it
+VS_INPUT UnpackVertex(float4 position, float2 normal, float2 tangent, float2 uv)
+{
+	VS_INPUT vertex = (VS_INPUT)0;
+	vertex.Position = gPositionOffset.xyz + position.xyz * gPositionScale.xyz;
+	vertex.UV = uv;
+	vertex.Normal = DecodeOctahedral(normal);
+	vertex.Tangent = DecodeOctahedral(tangent);
+	return vertex;
+}
+
 float3 MultColor(float3 a, float3 b)
 {
 	return float3(a.r * b.r, a.g * b.g, a.b * b.b);
@@ -122,6 +179,44 @@ VS_OUTPUT VtxShader(VS_INPUT input)
 	return output;
 }
 
+// Instanced Vertex Shader
+VS_OUTPUT InstancedVtxShader(VS_INSTANCED_INPUT input)
+{
+	const float4x4 instanceWorld = float4x4( input.InstanceWorld0, input.InstanceWorld1, input.InstanceWorld2, input.InstanceWorld3 );
+	const float4x4 world = mul( instanceWorld, gWorld );
+
+	VS_OUTPUT output = (VS_OUTPUT)0;
+	output.WorldPosition = mul( float4( input.Position, 1.f ), world );
+	output.Position = mul( output.WorldPosition, gViewProj );
+	output.Color = input.Color;
+	output.UV = input.UV;
+	output.Normal = normalize( mul( input.Normal, (float3x3)world ).xyz );
+	output.Tangent = normalize( mul( input.Tangent, (float3x3)world ).xyz );
+	return output;
+}
+
+// Packed Vertex Shaders: decode, then the same as the two above
+VS_OUTPUT PackedVtxShader(VS_PACKED_INPUT input)
+{
+	return VtxShader(UnpackVertex(input.Position, input.Normal, input.Tangent, input.UV));
+}
+
+VS_OUTPUT PackedInstancedVtxShader(VS_PACKED_INSTANCED_INPUT input)
+{
+	const VS_INPUT vertex = UnpackVertex(input.Position, input.Normal, input.Tangent, input.UV);
+
+	VS_INSTANCED_INPUT instanced = (VS_INSTANCED_INPUT)0;
+	instanced.Position = vertex.Position;
+	instanced.UV = vertex.UV;
+	instanced.Normal = vertex.Normal;
+	instanced.Tangent = vertex.Tangent;
+	instanced.InstanceWorld0 = input.InstanceWorld0;
+	instanced.InstanceWorld1 = input.InstanceWorld1;
+	instanced.InstanceWorld2 = input.InstanceWorld2;
+	instanced.InstanceWorld3 = input.InstanceWorld3;
+	return InstancedVtxShader(instanced);
+}
+
 // Pixel Shader
 float4 PxlShader(VS_OUTPUT input) : SV_TARGET
 {
@@ -165,3 +260,44 @@ technique11 DefaultTechnique
 		SetPixelShader( CompileShader( ps_5_0, PxlShader() ) );
 	}
 }
+
+// Same pixel shader, vertices placed by the per-instance world matrices
+technique11 InstancedTechnique
+{
+	pass P0
+	{
+		SetRasterizerState(gRasterizerState);
+		SetDepthStencilState(gDepthStencilState, 0);
+		SetBlendState(gBlendState, float4(0.f, 0.f, 0.f, 0.f), -1);
+		SetVertexShader( CompileShader( vs_5_0, InstancedVtxShader() ) );
+		SetGeometryShader( NULL );
+		SetPixelShader( CompileShader( ps_5_0, PxlShader() ) );
+	}
+}
+
+// The two above, reading PackedVertex
+technique11 PackedTechnique
+{
+	pass P0
+	{
+		SetRasterizerState(gRasterizerState);
+		SetDepthStencilState(gDepthStencilState, 0);
+		SetBlendState(gBlendState, float4(0.f, 0.f, 0.f, 0.f), -1);
+		SetVertexShader( CompileShader( vs_5_0, PackedVtxShader() ) );
+		SetGeometryShader( NULL );
+		SetPixelShader( CompileShader( ps_5_0, PxlShader() ) );
+	}
+}
+
+technique11 PackedInstancedTechnique
+{
+	pass P0
+	{
+		SetRasterizerState(gRasterizerState);
+		SetDepthStencilState(gDepthStencilState, 0);
+		SetBlendState(gBlendState, float4(0.f, 0.f, 0.f, 0.f), -1);
+		SetVertexShader( CompileShader( vs_5_0, PackedInstancedVtxShader() ) );
+		SetGeometryShader( NULL );
+		SetPixelShader( CompileShader( ps_5_0, PxlShader() ) );
+	}
+}
\ No newline at end of file
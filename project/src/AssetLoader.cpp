@@ -0,0 +1,98 @@
+#include "AssetLoader.h"
+#include <thread>
+#include <utility>
+#include <vector>
+#include "Error.h"
+#include "Utils.h"
+
+namespace dae
+{
+namespace
+{
+void ParseOBJOrThrow( const std::string& objPath, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices )
+{
+	if ( !Utils::ParseOBJ( objPath, vertices, indices ) )
+	{
+		throw error::file::CouldNotOpenFile();
+	}
+}
+} // namespace
+
+AssetLoader::AssetLoader( JobSystem& jobSystem )
+	: m_pJobSystem( &jobSystem )
+{
+}
+
+AssetLoader::~AssetLoader() noexcept
+{
+	WaitIdle();
+}
+
+AssetHandle<Mesh> AssetLoader::LoadMesh( const std::string& objPath,
+										 D3D11_PRIMITIVE_TOPOLOGY topology,
+										 VertexFormat vertexFormat )
+{
+	return Start<Mesh>( [objPath, topology, vertexFormat]() {
+		std::vector<Vertex> vertices{};
+		std::vector<uint32_t> indices{};
+		ParseOBJOrThrow( objPath, vertices, indices );
+		return Mesh{ vertices, indices, topology, vertexFormat };
+	} );
+}
+
+AssetHandle<TransparentMesh> AssetLoader::LoadTransparentMesh( const std::string& objPath,
+															   D3D11_PRIMITIVE_TOPOLOGY topology )
+{
+	return Start<TransparentMesh>( [objPath, topology]() {
+		std::vector<Vertex> vertices{};
+		std::vector<uint32_t> indices{};
+		ParseOBJOrThrow( objPath, vertices, indices );
+		return TransparentMesh{ vertices, indices, topology };
+	} );
+}
+
+AssetHandle<Texture> AssetLoader::LoadTexture( const std::string& path )
+{
+	return Start<Texture>( [path]() { return Texture{ nullptr, path }; } );
+}
+
+bool AssetLoader::IsIdle() const
+{
+	return !m_RunningLoadCount.load( std::memory_order_acquire );
+}
+
+void AssetLoader::WaitIdle()
+{
+	while ( !IsIdle() )
+	{
+		if ( !m_pJobSystem->RunBackgroundJob() )
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+template <typename Asset, typename Load>
+AssetHandle<Asset> AssetLoader::Start( Load load )
+{
+	AssetHandle<Asset> handle{};
+	handle.m_pState = std::make_shared<typename AssetHandle<Asset>::State>();
+
+	m_RunningLoadCount.fetch_add( 1, std::memory_order_relaxed );
+	// Background, a frame waiting on its own jobs would otherwise end up parsing a whole mesh
+	m_pJobSystem->PushBackground( [this, pState = handle.m_pState, load]() {
+		// Jobs must not throw, the handle hands it to whoever takes the asset
+		try
+		{
+			pState->asset.emplace( load() );
+		}
+		catch ( ... )
+		{
+			pState->pException = std::current_exception();
+		}
+		pState->isReady.store( true, std::memory_order_release );
+		m_RunningLoadCount.fetch_sub( 1, std::memory_order_acq_rel );
+	} );
+	return handle;
+}
+} // namespace dae
@@ -0,0 +1,91 @@
+#ifndef ASSETLOADER_H
+#define ASSETLOADER_H
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <string>
+#include "JobSystem.h"
+#include "Mesh.h"
+#include "Texture.h"
+
+// Loads assets as background jobs on the workers, so startup takes as long as the slowest asset instead of all of them
+// Workers parse, decode and build everything that lives on the CPU, the thread that owns the device finishes the rest
+// Handles are polled between frames, until one is ready the scene draws without it or with a placeholder
+
+namespace dae
+{
+template <typename Asset>
+class AssetHandle final
+{
+public:
+	AssetHandle() = default; // Not loading anything
+
+	bool IsValid() const
+	{
+		return m_pState != nullptr;
+	}
+
+	// Loaded or failed, Take tells which
+	bool IsReady() const
+	{
+		return m_pState && m_pState->isReady.load( std::memory_order_acquire );
+	}
+
+	// Only once ready, rethrows what the load threw, the handle is invalid after
+	Asset Take()
+	{
+		const std::shared_ptr<State> pState{ std::move( m_pState ) };
+		if ( pState->pException )
+		{
+			std::rethrow_exception( pState->pException );
+		}
+		return std::move( *pState->asset );
+	}
+
+private:
+	friend class AssetLoader;
+
+	struct State final
+	{
+		std::atomic<bool> isReady{ false };
+		std::optional<Asset> asset{};
+		std::exception_ptr pException{};
+	};
+
+	// Shared with the job, which may finish after every copy of the handle is gone
+	std::shared_ptr<State> m_pState{};
+};
+
+class AssetLoader final
+{
+public:
+	explicit AssetLoader( JobSystem& jobSystem );
+	~AssetLoader() noexcept; // Waits for the loads still running
+
+	AssetLoader( const AssetLoader& ) = delete;
+	AssetLoader( AssetLoader&& ) noexcept = delete;
+	AssetLoader& operator=( const AssetLoader& ) = delete;
+	AssetLoader& operator=( AssetLoader&& ) noexcept = delete;
+
+	// Parsed and built up to what Mesh::FinishLoading does, maps are placeholders
+	AssetHandle<Mesh> LoadMesh( const std::string& objPath,
+								D3D11_PRIMITIVE_TOPOLOGY topology,
+								VertexFormat vertexFormat = VertexFormat::full );
+	AssetHandle<TransparentMesh> LoadTransparentMesh( const std::string& objPath, D3D11_PRIMITIVE_TOPOLOGY topology );
+	AssetHandle<Texture> LoadTexture( const std::string& path ); // Decoded, not on the device yet
+
+	bool IsIdle() const;
+	// Returns once every load started so far finished, runs queued loads meanwhile
+	// With a single thread the loads only ever run in here
+	void WaitIdle();
+
+private:
+	JobSystem* m_pJobSystem{};
+	std::atomic<uint32_t> m_RunningLoadCount{};
+
+	template <typename Asset, typename Load>
+	AssetHandle<Asset> Start( Load load );
+};
+} // namespace dae
+#endif
@@ -0,0 +1,252 @@
+#include "Benchmark.h"
+#include <SDL.h>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include "Error.h"
+#include "FrameTimings.h"
+#include "Headless.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+#include "Timer.h"
+
+namespace dae
+{
+namespace
+{
+// Slow arc around the origin of the vehicle while dollying in and bobbing up and down
+// Only depends on progress in [0, 1] -> every run sees exactly the same views
+void PlaceBenchmarkCamera( Camera& camera, float progress )
+{
+	const Vector3 target{ 0.f, 0.f, 50.f };
+	constexpr float maxArcAngle{ 35.f * TO_RADIANS };
+
+	const float arcAngle{ std::sin( progress * PI_2 ) * maxArcAngle };
+	const float distance{ Lerpf( 50.f, 25.f, progress ) };
+	const float height{ 8.f * std::sin( progress * PI_2 * 2.f ) };
+
+	const Vector3 position{ target.x - std::sin( arcAngle ) * distance, height, target.z - std::cos( arcAngle ) * distance };
+	const Vector3 toTarget{ target - position };
+
+	camera.SetPos( position );
+	camera.SetRotation( std::atan2( toTarget.x, toTarget.z ),
+						std::atan2( toTarget.y, std::sqrt( Square( toTarget.x ) + Square( toTarget.z ) ) ) );
+}
+
+void WriteStatistics( std::ofstream& file, const char* name, const std::vector<int64_t>& samples, bool isLast )
+{
+	const TimingStatistics statistics{ TimingStatistics::Compute( samples ) };
+	file << "\t\t\"" << name << "\": { \"mean\": " << statistics.mean << ", \"median\": " << statistics.median
+		 << ", \"p95\": " << statistics.p95 << ", \"p99\": " << statistics.p99 << ", \"max\": " << statistics.max
+		 << " }" << ( isLast ? "\n" : ",\n" );
+}
+
+const char* GetLightingModeName( LightingMode lightingMode )
+{
+	switch ( lightingMode )
+	{
+	case LightingMode::observedArea:
+		return "observedArea";
+	case LightingMode::diffuse:
+		return "diffuse";
+	case LightingMode::specular:
+		return "specular";
+	case LightingMode::combined:
+		return "combined";
+	default:
+		return "unknown";
+	}
+}
+
+const char* GetFilterModeName( FilterMode filterMode )
+{
+	switch ( filterMode )
+	{
+	case FilterMode::point:
+		return "point";
+	case FilterMode::linear:
+		return "linear";
+	case FilterMode::anisotropic:
+		return "anisotropic";
+	default:
+		return "unknown";
+	}
+}
+} // namespace
+
+TimingStatistics TimingStatistics::Compute( std::vector<int64_t> samples )
+{
+	TimingStatistics statistics{};
+	if ( samples.empty() )
+	{
+		return statistics;
+	}
+
+	std::sort( samples.begin(), samples.end() );
+
+	// Nearest rank
+	auto getPercentile{ [&]( double percentile ) {
+		const size_t rank{ static_cast<size_t>( std::ceil( percentile * samples.size() ) ) };
+		return static_cast<double>( samples[std::clamp<size_t>( rank, 1, samples.size() ) - 1] );
+	} };
+
+	statistics.mean = std::accumulate( samples.begin(), samples.end(), 0.0 ) / samples.size();
+	statistics.median = getPercentile( 0.5 );
+	statistics.p95 = getPercentile( 0.95 );
+	statistics.p99 = getPercentile( 0.99 );
+	statistics.max = static_cast<double>( samples.back() );
+
+	return statistics;
+}
+
+int RunBenchmark( const LaunchOptions& options )
+{
+	SDL_Init( SDL_INIT_TIMER );
+	profiler::SetThreadName( "Main" );
+
+	JobSystem jobSystem{ options.threadCount };
+	Renderer renderer{ options.width, options.height, jobSystem };
+	std::unique_ptr<Scene> pScene{ CreateHeadlessScene( renderer, options ) };
+	if ( !pScene )
+	{
+		SDL_Quit();
+		return 1;
+	}
+
+	// Mesh animation advances by a fixed step, independent of how long frames take
+	Timer timer{};
+	timer.SetFixedElapsed( options.timeStep );
+	timer.Start();
+
+	constexpr size_t stageCount{ static_cast<size_t>( RenderStage::count ) };
+	std::vector<int64_t> frameSamples{};
+	std::vector<int64_t> updateSamples{};
+	std::vector<std::vector<int64_t>> stageSamples( stageCount );
+
+	frameSamples.reserve( options.frameCount );
+	updateSamples.reserve( options.frameCount );
+	for ( auto& samples : stageSamples )
+	{
+		samples.reserve( options.frameCount );
+	}
+
+	std::cout << "**BENCHMARK STARTED** (" << options.warmupFrameCount << " warmup + " << options.frameCount
+			  << " frames)\n";
+
+	const bool failed{ error::utils::HandleThrowingFunction( [&]() {
+		const int totalFrameCount{ options.warmupFrameCount + options.frameCount };
+		int64_t updateNanoseconds{};
+		auto updateFrame{ [&]( int frameIdx ) {
+			const auto updateStart{ FrameClock::now() };
+			PlaceBenchmarkCamera( pScene->GetCamera(), static_cast<float>( frameIdx ) / totalFrameCount );
+			pScene->Update( &timer );
+			updateNanoseconds =
+				std::chrono::duration_cast<std::chrono::nanoseconds>( FrameClock::now() - updateStart ).count();
+		} };
+
+		// Pipelined: the update of the next frame runs inside this frame's render, so the frame time covers both
+		if ( options.usePipelining )
+		{
+			updateFrame( 0 );
+		}
+
+		for ( int frameIdx{}; frameIdx < totalFrameCount; ++frameIdx )
+		{
+			const auto frameStart{ FrameClock::now() };
+			if ( options.usePipelining )
+			{
+				renderer.Render( pScene.get(), [&]() { updateFrame( frameIdx + 1 ); } );
+			}
+			else
+			{
+				updateFrame( frameIdx );
+				renderer.Render( pScene.get() );
+			}
+			const auto frameEnd{ FrameClock::now() };
+			timer.Update();
+
+			if ( frameIdx < options.warmupFrameCount )
+			{
+				continue;
+			}
+
+			frameSamples.push_back(
+				std::chrono::duration_cast<std::chrono::nanoseconds>( frameEnd - frameStart ).count() );
+			updateSamples.push_back( updateNanoseconds );
+			for ( size_t stageIdx{}; stageIdx < stageCount; ++stageIdx )
+			{
+				stageSamples[stageIdx].push_back( renderer.GetFrameTimings().stageNanoseconds[stageIdx] );
+			}
+		}
+
+		std::ofstream file( options.benchmarkPath );
+		if ( !file )
+		{
+			throw error::file::CouldNotOpenFile();
+		}
+
+		file << std::fixed;
+		file << "{\n"
+			 << "\t\"scene\": \"" << options.sceneName << "\",\n"
+			 << "\t\"width\": " << options.width << ",\n"
+			 << "\t\"height\": " << options.height << ",\n"
+			 << "\t\"frames\": " << options.frameCount << ",\n"
+			 << "\t\"warmupFrames\": " << options.warmupFrameCount << ",\n"
+			 << "\t\"timeStep\": " << options.timeStep << ",\n"
+			 << "\t\"lighting\": \"" << GetLightingModeName( options.lightingMode ) << "\",\n"
+			 << "\t\"sampler\": \"" << GetFilterModeName( options.filterMode ) << "\",\n"
+			 << "\t\"precision\": \"" << ( options.mathPrecision == MathPrecision::fast ? "fast" : "exact" ) << "\",\n"
+			 << "\t\"msaa\": \"" << ( options.useMultisampling ? "4x" : "off" ) << "\",\n"
+			 << "\t\"incremental\": \"" << ( options.useIncrementalRendering ? "on" : "off" ) << "\",\n"
+			 << "\t\"vrs\": \"" << ( options.useVariableRateShading ? "on" : "off" ) << "\",\n"
+			 << "\t\"frameBudgetMs\": " << options.frameBudgetMs << ",\n"
+			 << "\t\"threads\": " << jobSystem.GetThreadCount() << ",\n"
+			 << "\t\"pipelined\": \"" << ( options.usePipelining ? "on" : "off" ) << "\",\n"
+			 << "\t\"vertices\": \"" << ( options.vertexFormat == VertexFormat::packed ? "packed" : "full" ) << "\",\n"
+			 << "\t\"unit\": \"ns\",\n"
+			 << "\t\"stages\": {\n";
+
+		WriteStatistics( file, "frame", frameSamples, false );
+		WriteStatistics( file, "update", updateSamples, false );
+		for ( size_t stageIdx{}; stageIdx < stageCount; ++stageIdx )
+		{
+			WriteStatistics( file,
+							 FrameTimings::GetStageName( static_cast<RenderStage>( stageIdx ) ),
+							 stageSamples[stageIdx],
+							 stageIdx + 1 == stageCount );
+		}
+
+		file << "\t},\n"
+			 << "\t\"frameTimes\": [";
+		for ( size_t sampleIdx{}; sampleIdx < frameSamples.size(); ++sampleIdx )
+		{
+			file << ( sampleIdx == 0 ? "" : ", " ) << frameSamples[sampleIdx];
+		}
+		file << "]\n"
+			 << "}\n";
+	} ) };
+	timer.Stop();
+
+	if ( !failed )
+	{
+		const TimingStatistics frameStatistics{ TimingStatistics::Compute( frameSamples ) };
+		std::cout << "**BENCHMARK FINISHED**\n";
+		std::cout << ">> MEAN = " << frameStatistics.mean / 1'000'000.0 << " ms\n";
+		std::cout << ">> P99 = " << frameStatistics.p99 / 1'000'000.0 << " ms\n";
+		std::cout << ">> MAX = " << frameStatistics.max / 1'000'000.0 << " ms\n";
+		std::cout << "Results written to " << options.benchmarkPath << "\n";
+	}
+
+	if ( !options.tracePath.empty() )
+	{
+		profiler::DumpChromeTrace( options.tracePath );
+	}
+
+	pScene.reset();
+	SDL_Quit();
+
+	return failed ? 1 : 0;
+}
+} // namespace dae
@@ -0,0 +1,26 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+#include <cstdint>
+#include <vector>
+#include "CommandLine.h"
+
+namespace dae
+{
+// Summary of a series of nanosecond samples
+struct TimingStatistics final
+{
+	double mean{};
+	double median{};
+	double p95{};
+	double p99{};
+	double max{};
+
+	static TimingStatistics Compute( std::vector<int64_t> samples );
+};
+
+// Renders a fixed number of frames headless along a deterministic camera path and
+// writes frame and per-stage statistics to options.benchmarkPath as JSON
+// Returns the process exit code
+int RunBenchmark( const LaunchOptions& options );
+} // namespace dae
+#endif
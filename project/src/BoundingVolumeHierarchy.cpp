@@ -0,0 +1,350 @@
+#include "BoundingVolumeHierarchy.h"
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <numeric>
+#include <utility>
+
+namespace dae
+{
+bool BoundingVolumeHierarchy::Node::IsLeaf() const
+{
+	return itemCount > 0;
+}
+
+void BoundingVolumeHierarchy::Build( const std::vector<BoundingBox>& itemBounds )
+{
+	const uint32_t itemCount{ static_cast<uint32_t>( itemBounds.size() ) };
+
+	m_ItemBounds = itemBounds;
+	m_ItemOrder.resize( itemCount );
+	std::iota( m_ItemOrder.begin(), m_ItemOrder.end(), 0 );
+	m_ItemLeafIndices.assign( itemCount, 0 );
+
+	m_Nodes.clear();
+	if ( itemCount == 0 )
+	{
+		return;
+	}
+
+	// A binary tree with n leaves has 2n - 1 nodes
+	m_Nodes.reserve( 2 * static_cast<size_t>( itemCount ) - 1 );
+	m_Nodes.push_back( Node{ {}, 0, itemCount, 0 } );
+	UpdateNodeBounds( 0 );
+	Subdivide( 0, 0 );
+}
+
+void BoundingVolumeHierarchy::UpdateItem( uint32_t itemIndex, const BoundingBox& bounds )
+{
+	m_ItemBounds[itemIndex] = bounds;
+
+	// Refit the leaf and every ancestor, the root is its own parent
+	uint32_t nodeIndex{ m_ItemLeafIndices[itemIndex] };
+	while ( true )
+	{
+		UpdateNodeBounds( nodeIndex );
+		if ( nodeIndex == 0 )
+		{
+			break;
+		}
+		nodeIndex = m_Nodes[nodeIndex].parentIndex;
+	}
+}
+
+void BoundingVolumeHierarchy::QueryFrustum( const Frustum& frustum, std::vector<uint32_t>& itemIndices ) const
+{
+	if ( m_Nodes.empty() )
+	{
+		return;
+	}
+
+	// On the stack, this runs every frame and must not allocate
+	NodeStack<uint32_t> nodeStack{ 0 };
+	size_t stackSize{ 1 };
+	while ( stackSize > 0 )
+	{
+		const uint32_t nodeIndex{ nodeStack[--stackSize] };
+		const Node& node{ m_Nodes[nodeIndex] };
+
+		if ( !frustum.Intersects( node.bounds ) )
+		{
+			continue;
+		}
+
+		if ( !node.IsLeaf() )
+		{
+			// Everything under a node that is fully inside is visible, no more plane tests
+			if ( frustum.Contains( node.bounds ) )
+			{
+				const auto [firstIndex, itemCount]{ GetItemRange( nodeIndex ) };
+				itemIndices.insert( itemIndices.end(),
+									m_ItemOrder.begin() + firstIndex,
+									m_ItemOrder.begin() + firstIndex + itemCount );
+				continue;
+			}
+
+			nodeStack[stackSize++] = node.firstIndex + 1;
+			nodeStack[stackSize++] = node.firstIndex;
+			continue;
+		}
+
+		for ( uint32_t orderIdx{ node.firstIndex }; orderIdx < node.firstIndex + node.itemCount; ++orderIdx )
+		{
+			const uint32_t itemIndex{ m_ItemOrder[orderIdx] };
+			if ( node.itemCount == 1 || frustum.Intersects( m_ItemBounds[itemIndex] ) )
+			{
+				itemIndices.push_back( itemIndex );
+			}
+		}
+	}
+}
+
+bool BoundingVolumeHierarchy::QueryRay( const Ray& ray, float maxDistance, RayHit& hit ) const
+{
+	float rootDistance{};
+	if ( m_Nodes.empty() || !m_Nodes[0].bounds.IntersectsRay( ray, maxDistance, rootDistance ) )
+	{
+		return false;
+	}
+
+	bool isHit{ false };
+	float closestDistance{ maxDistance };
+
+	NodeStack<std::pair<uint32_t, float>> nodeStack{};
+	nodeStack[0] = { 0, rootDistance };
+	size_t stackSize{ 1 };
+	while ( stackSize > 0 )
+	{
+		const auto [nodeIndex, entryDistance]{ nodeStack[--stackSize] };
+
+		// Something closer was found since this node was pushed
+		if ( entryDistance > closestDistance )
+		{
+			continue;
+		}
+
+		const Node& node{ m_Nodes[nodeIndex] };
+		if ( node.IsLeaf() )
+		{
+			for ( uint32_t orderIdx{ node.firstIndex }; orderIdx < node.firstIndex + node.itemCount; ++orderIdx )
+			{
+				const uint32_t itemIndex{ m_ItemOrder[orderIdx] };
+				float itemDistance{};
+				if ( m_ItemBounds[itemIndex].IntersectsRay( ray, closestDistance, itemDistance ) )
+				{
+					closestDistance = itemDistance;
+					hit = { itemIndex, itemDistance };
+					isHit = true;
+				}
+			}
+			continue;
+		}
+
+		// Visit the nearer child first so the farther one is more likely to be pruned
+		float leftDistance{};
+		float rightDistance{};
+		const bool isLeftHit{ m_Nodes[node.firstIndex].bounds.IntersectsRay( ray, closestDistance, leftDistance ) };
+		const bool isRightHit{ m_Nodes[node.firstIndex + 1].bounds.IntersectsRay(
+			ray, closestDistance, rightDistance ) };
+
+		if ( isLeftHit && isRightHit )
+		{
+			if ( leftDistance <= rightDistance )
+			{
+				nodeStack[stackSize++] = { node.firstIndex + 1, rightDistance };
+				nodeStack[stackSize++] = { node.firstIndex, leftDistance };
+			}
+			else
+			{
+				nodeStack[stackSize++] = { node.firstIndex, leftDistance };
+				nodeStack[stackSize++] = { node.firstIndex + 1, rightDistance };
+			}
+		}
+		else if ( isLeftHit )
+		{
+			nodeStack[stackSize++] = { node.firstIndex, leftDistance };
+		}
+		else if ( isRightHit )
+		{
+			nodeStack[stackSize++] = { node.firstIndex + 1, rightDistance };
+		}
+	}
+
+	return isHit;
+}
+
+size_t BoundingVolumeHierarchy::GetItemCount() const
+{
+	return m_ItemBounds.size();
+}
+
+size_t BoundingVolumeHierarchy::GetNodeCount() const
+{
+	return m_Nodes.size();
+}
+
+void BoundingVolumeHierarchy::Subdivide( uint32_t nodeIndex, uint32_t depth )
+{
+	const uint32_t firstIndex{ m_Nodes[nodeIndex].firstIndex };
+	const uint32_t itemCount{ m_Nodes[nodeIndex].itemCount };
+
+	auto makeLeaf{ [&]() {
+		for ( uint32_t orderIdx{ firstIndex }; orderIdx < firstIndex + itemCount; ++orderIdx )
+		{
+			m_ItemLeafIndices[m_ItemOrder[orderIdx]] = nodeIndex;
+		}
+	} };
+
+	if ( itemCount == 1 || depth == maxDepth )
+	{
+		makeLeaf();
+		return;
+	}
+
+	// Items are binned by the center of their box
+	BoundingBox centerBounds{ BoundingBox::CreateEmpty() };
+	for ( uint32_t orderIdx{ firstIndex }; orderIdx < firstIndex + itemCount; ++orderIdx )
+	{
+		centerBounds.Grow( m_ItemBounds[m_ItemOrder[orderIdx]].GetCenter() );
+	}
+
+	struct Bin final
+	{
+		BoundingBox bounds{ BoundingBox::CreateEmpty() };
+		uint32_t itemCount{};
+	};
+
+	// Cost of a split is the expected number of tests: the two children plus the items per side, weighted by area
+	float bestCost{ std::numeric_limits<float>::max() };
+	int bestAxis{ -1 };
+	int bestSplitBin{};
+	for ( int axis{}; axis < 3; ++axis )
+	{
+		const float axisMin{ centerBounds.min[axis] };
+		const float axisExtent{ centerBounds.max[axis] - axisMin };
+		if ( axisExtent <= 0.f )
+		{
+			continue;
+		}
+
+		std::array<Bin, binCount> bins{};
+		const float binScale{ binCount / axisExtent };
+		for ( uint32_t orderIdx{ firstIndex }; orderIdx < firstIndex + itemCount; ++orderIdx )
+		{
+			const BoundingBox& itemBounds{ m_ItemBounds[m_ItemOrder[orderIdx]] };
+			const int binIdx{ std::min( binCount - 1,
+										static_cast<int>( ( itemBounds.GetCenter()[axis] - axisMin ) * binScale ) ) };
+			bins[binIdx].bounds.Grow( itemBounds );
+			++bins[binIdx].itemCount;
+		}
+
+		// Sweep from both ends, split i puts bins [0, i] on the left
+		std::array<float, binCount - 1> leftCosts{};
+		BoundingBox leftBounds{ BoundingBox::CreateEmpty() };
+		uint32_t leftCount{};
+		for ( int splitIdx{}; splitIdx < binCount - 1; ++splitIdx )
+		{
+			leftBounds.Grow( bins[splitIdx].bounds );
+			leftCount += bins[splitIdx].itemCount;
+			leftCosts[splitIdx] = leftCount > 0 ? leftCount * leftBounds.GetSurfaceArea() : 0.f;
+		}
+
+		BoundingBox rightBounds{ BoundingBox::CreateEmpty() };
+		uint32_t rightCount{};
+		for ( int splitIdx{ binCount - 2 }; splitIdx >= 0; --splitIdx )
+		{
+			rightBounds.Grow( bins[splitIdx + 1].bounds );
+			rightCount += bins[splitIdx + 1].itemCount;
+			if ( rightCount == 0 || rightCount == itemCount )
+			{
+				continue;
+			}
+
+			const float cost{ traversalCost * m_Nodes[nodeIndex].bounds.GetSurfaceArea() + leftCosts[splitIdx] +
+							  rightCount * rightBounds.GetSurfaceArea() };
+			if ( cost < bestCost )
+			{
+				bestCost = cost;
+				bestAxis = axis;
+				bestSplitBin = splitIdx;
+			}
+		}
+	}
+
+	// Every center in the same spot, or splitting is not worth it for a small leaf
+	const float leafCost{ static_cast<float>( itemCount ) * m_Nodes[nodeIndex].bounds.GetSurfaceArea() };
+	if ( bestAxis < 0 || ( itemCount <= maxLeafItemCount && bestCost >= leafCost ) )
+	{
+		makeLeaf();
+		return;
+	}
+
+	const float axisMin{ centerBounds.min[bestAxis] };
+	const float binScale{ binCount / ( centerBounds.max[bestAxis] - axisMin ) };
+	const auto splitIt{ std::partition( m_ItemOrder.begin() + firstIndex,
+										m_ItemOrder.begin() + firstIndex + itemCount,
+										[&]( uint32_t itemIndex ) {
+											const int binIdx{ std::min(
+												binCount - 1,
+												static_cast<int>( ( m_ItemBounds[itemIndex].GetCenter()[bestAxis] -
+																	axisMin ) *
+																  binScale ) ) };
+											return binIdx <= bestSplitBin;
+										} ) };
+	const uint32_t leftCount{ static_cast<uint32_t>( splitIt - ( m_ItemOrder.begin() + firstIndex ) ) };
+	if ( leftCount == 0 || leftCount == itemCount )
+	{
+		makeLeaf();
+		return;
+	}
+
+	// Children are always allocated as a pair, the right one right after the left one
+	const uint32_t leftIndex{ static_cast<uint32_t>( m_Nodes.size() ) };
+	m_Nodes.push_back( Node{ {}, firstIndex, leftCount, nodeIndex } );
+	m_Nodes.push_back( Node{ {}, firstIndex + leftCount, itemCount - leftCount, nodeIndex } );
+	m_Nodes[nodeIndex].firstIndex = leftIndex;
+	m_Nodes[nodeIndex].itemCount = 0;
+
+	UpdateNodeBounds( leftIndex );
+	UpdateNodeBounds( leftIndex + 1 );
+	Subdivide( leftIndex, depth + 1 );
+	Subdivide( leftIndex + 1, depth + 1 );
+}
+
+std::pair<uint32_t, uint32_t> BoundingVolumeHierarchy::GetItemRange( uint32_t nodeIndex ) const
+{
+	// Subdivide partitions in place, so a subtree owns the items from its leftmost to its rightmost leaf
+	uint32_t leftmostIndex{ nodeIndex };
+	while ( !m_Nodes[leftmostIndex].IsLeaf() )
+	{
+		leftmostIndex = m_Nodes[leftmostIndex].firstIndex;
+	}
+
+	uint32_t rightmostIndex{ nodeIndex };
+	while ( !m_Nodes[rightmostIndex].IsLeaf() )
+	{
+		rightmostIndex = m_Nodes[rightmostIndex].firstIndex + 1;
+	}
+
+	const uint32_t firstIndex{ m_Nodes[leftmostIndex].firstIndex };
+	const Node& rightmostLeaf{ m_Nodes[rightmostIndex] };
+	return { firstIndex, rightmostLeaf.firstIndex + rightmostLeaf.itemCount - firstIndex };
+}
+
+void BoundingVolumeHierarchy::UpdateNodeBounds( uint32_t nodeIndex )
+{
+	Node& node{ m_Nodes[nodeIndex] };
+	if ( !node.IsLeaf() )
+	{
+		node.bounds = m_Nodes[node.firstIndex].bounds;
+		node.bounds.Grow( m_Nodes[node.firstIndex + 1].bounds );
+		return;
+	}
+
+	node.bounds = BoundingBox::CreateEmpty();
+	for ( uint32_t orderIdx{ node.firstIndex }; orderIdx < node.firstIndex + node.itemCount; ++orderIdx )
+	{
+		node.bounds.Grow( m_ItemBounds[m_ItemOrder[orderIdx]] );
+	}
+}
+} // namespace dae
@@ -0,0 +1,68 @@
+#ifndef BOUNDINGVOLUMEHIERARCHY_H
+#define BOUNDINGVOLUMEHIERARCHY_H
+#include <array>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "BoundingVolumes.h"
+
+namespace dae
+{
+// Binary tree of boxes over items identified by their index in whatever container owns them
+// Built top-down with the binned surface area heuristic, moving items only refit the path to the root
+// Refitting keeps queries correct but lets the tree quality decay, Build again after large changes
+class BoundingVolumeHierarchy final
+{
+public:
+	struct RayHit final
+	{
+		uint32_t itemIndex{};
+		float distance{}; // Entry distance into the box of the item
+	};
+
+	// Item i gets the bounds itemBounds[i], replaces whatever was built before
+	void Build( const std::vector<BoundingBox>& itemBounds );
+	// Moves a single item, O(depth)
+	void UpdateItem( uint32_t itemIndex, const BoundingBox& bounds );
+
+	// Appends every item whose box is not fully outside the frustum, in no particular order
+	void QueryFrustum( const Frustum& frustum, std::vector<uint32_t>& itemIndices ) const;
+	// Closest item box the ray enters within maxDistance
+	bool QueryRay( const Ray& ray, float maxDistance, RayHit& hit ) const;
+
+	size_t GetItemCount() const;
+	size_t GetNodeCount() const;
+
+private:
+	// Internal nodes: firstIndex is the left child, the right child directly follows it
+	// Leaves: items m_ItemOrder[firstIndex, firstIndex + itemCount)
+	struct Node final
+	{
+		BoundingBox bounds{};
+		uint32_t firstIndex{};
+		uint32_t itemCount{};
+		uint32_t parentIndex{};
+
+		bool IsLeaf() const;
+	};
+
+	static constexpr uint32_t maxLeafItemCount{ 4 };
+	static constexpr uint32_t maxDepth{ 32 }; // Deeper nodes become leaves, however many items they hold
+	static constexpr int binCount{ 12 };
+	static constexpr float traversalCost{ 1.f }; // Visiting the two children of a node, relative to one item test
+
+	std::vector<Node> m_Nodes{};
+	std::vector<BoundingBox> m_ItemBounds{};
+	std::vector<uint32_t> m_ItemOrder{};
+	std::vector<uint32_t> m_ItemLeafIndices{};
+
+	// Traversal never holds more than one pending sibling per level plus the two children just pushed
+	template <typename Entry>
+	using NodeStack = std::array<Entry, maxDepth + 1>;
+
+	void Subdivide( uint32_t nodeIndex, uint32_t depth );
+	void UpdateNodeBounds( uint32_t nodeIndex );
+	std::pair<uint32_t, uint32_t> GetItemRange( uint32_t nodeIndex ) const; // First index into m_ItemOrder, count
+};
+} // namespace dae
+#endif
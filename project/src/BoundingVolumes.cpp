@@ -0,0 +1,208 @@
+#include "BoundingVolumes.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include "Error.h"
+
+namespace dae
+{
+BoundingBox BoundingBox::FromVertices( const std::vector<Vertex>& vertices )
+{
+	if ( vertices.empty() )
+	{
+		throw error::mesh::BufferIsEmpty();
+	}
+
+	BoundingBox box{ vertices.front().position, vertices.front().position };
+	for ( const Vertex& vertex : vertices )
+	{
+		box.min.x = std::min( box.min.x, vertex.position.x );
+		box.min.y = std::min( box.min.y, vertex.position.y );
+		box.min.z = std::min( box.min.z, vertex.position.z );
+		box.max.x = std::max( box.max.x, vertex.position.x );
+		box.max.y = std::max( box.max.y, vertex.position.y );
+		box.max.z = std::max( box.max.z, vertex.position.z );
+	}
+	return box;
+}
+
+BoundingBox BoundingBox::CreateEmpty()
+{
+	constexpr float infinity{ std::numeric_limits<float>::infinity() };
+	return { { infinity, infinity, infinity }, { -infinity, -infinity, -infinity } };
+}
+
+Vector3 BoundingBox::GetCenter() const
+{
+	return ( min + max ) * 0.5f;
+}
+
+Vector3 BoundingBox::GetExtents() const
+{
+	return ( max - min ) * 0.5f;
+}
+
+float BoundingBox::GetSurfaceArea() const
+{
+	const Vector3 size{ max - min };
+	return 2.f * ( size.x * size.y + size.y * size.z + size.z * size.x );
+}
+
+void BoundingBox::Grow( const Vector3& point )
+{
+	min = { std::min( min.x, point.x ), std::min( min.y, point.y ), std::min( min.z, point.z ) };
+	max = { std::max( max.x, point.x ), std::max( max.y, point.y ), std::max( max.z, point.z ) };
+}
+
+void BoundingBox::Grow( const BoundingBox& box )
+{
+	// Corner by corner, so growing by an empty box changes nothing
+	min = { std::min( min.x, box.min.x ), std::min( min.y, box.min.y ), std::min( min.z, box.min.z ) };
+	max = { std::max( max.x, box.max.x ), std::max( max.y, box.max.y ), std::max( max.z, box.max.z ) };
+}
+
+bool BoundingBox::IntersectsRay( const Ray& ray, float maxDistance, float& hitDistance ) const
+{
+	// Slab test, a zero direction component gives infinities that compare correctly
+	float entry{ 0.f };
+	float exit{ maxDistance };
+	for ( int axis{}; axis < 3; ++axis )
+	{
+		const float inverseDirection{ 1.f / ray.direction[axis] };
+		float slabEntry{ ( min[axis] - ray.origin[axis] ) * inverseDirection };
+		float slabExit{ ( max[axis] - ray.origin[axis] ) * inverseDirection };
+		if ( slabEntry > slabExit )
+		{
+			std::swap( slabEntry, slabExit );
+		}
+
+		entry = std::max( entry, slabEntry );
+		exit = std::min( exit, slabExit );
+		if ( entry > exit )
+		{
+			return false;
+		}
+	}
+
+	hitDistance = entry;
+	return true;
+}
+
+BoundingBox BoundingBox::Transformed( const Matrix& transform ) const
+{
+	// Transform the center, then project the extents onto the new axes
+	const Vector3 center{ transform.TransformPoint( GetCenter() ) };
+	const Vector3 extents{ GetExtents() };
+	const Vector3 axisX{ transform.GetAxisX() };
+	const Vector3 axisY{ transform.GetAxisY() };
+	const Vector3 axisZ{ transform.GetAxisZ() };
+
+	const Vector3 transformedExtents{
+		std::abs( axisX.x ) * extents.x + std::abs( axisY.x ) * extents.y + std::abs( axisZ.x ) * extents.z,
+		std::abs( axisX.y ) * extents.x + std::abs( axisY.y ) * extents.y + std::abs( axisZ.y ) * extents.z,
+		std::abs( axisX.z ) * extents.x + std::abs( axisY.z ) * extents.y + std::abs( axisZ.z ) * extents.z,
+	};
+	return { center - transformedExtents, center + transformedExtents };
+}
+
+BoundingSphere BoundingSphere::FromVertices( const std::vector<Vertex>& vertices )
+{
+	const Vector3 center{ BoundingBox::FromVertices( vertices ).GetCenter() };
+
+	float sqrRadius{};
+	for ( const Vertex& vertex : vertices )
+	{
+		sqrRadius = std::max( sqrRadius, ( vertex.position - center ).SqrMagnitude() );
+	}
+	return { center, std::sqrt( sqrRadius ) };
+}
+
+BoundingSphere BoundingSphere::Transformed( const Matrix& transform ) const
+{
+	const float maxSqrScale{ std::max( { transform.GetAxisX().SqrMagnitude(),
+										 transform.GetAxisY().SqrMagnitude(),
+										 transform.GetAxisZ().SqrMagnitude() } ) };
+	return { transform.TransformPoint( center ), radius * std::sqrt( maxSqrScale ) };
+}
+
+float Plane::GetSignedDistance( const Vector3& point ) const
+{
+	return Vector3::Dot( normal, point ) + distance;
+}
+
+Frustum Frustum::FromViewProjection( const Matrix& viewProjection )
+{
+	// Row vectors -> clip = point * matrix, so every clip coordinate is a dot product with a column
+	auto getColumn{ [&]( int index ) {
+		return Vector4{ viewProjection[0][index],
+						viewProjection[1][index],
+						viewProjection[2][index],
+						viewProjection[3][index] };
+	} };
+	const Vector4 column0{ getColumn( 0 ) };
+	const Vector4 column1{ getColumn( 1 ) };
+	const Vector4 column2{ getColumn( 2 ) };
+	const Vector4 column3{ getColumn( 3 ) };
+
+	// -w <= x <= w, -w <= y <= w, 0 <= z <= w
+	const std::array<Vector4, 6> clipPlanes{
+		column3 + column0, column3 - column0, column3 + column1, column3 - column1, column2, column3 - column2,
+	};
+
+	Frustum frustum{};
+	for ( size_t planeIdx{}; planeIdx < clipPlanes.size(); ++planeIdx )
+	{
+		// Normalized so sphere radii can be compared against the distances
+		const Vector4& clipPlane{ clipPlanes[planeIdx] };
+		const Vector3 normal{ clipPlane.GetXYZ() };
+		const float inverseLength{ 1.f / normal.Magnitude() };
+		frustum.planes[planeIdx] = { normal * inverseLength, clipPlane.w * inverseLength };
+	}
+	return frustum;
+}
+
+bool Frustum::Intersects( const BoundingSphere& sphere ) const
+{
+	for ( const Plane& plane : planes )
+	{
+		if ( plane.GetSignedDistance( sphere.center ) < -sphere.radius )
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool Frustum::Intersects( const BoundingBox& box ) const
+{
+	for ( const Plane& plane : planes )
+	{
+		// Only the corner furthest along the normal has to be tested
+		const Vector3 furthestCorner{ plane.normal.x >= 0.f ? box.max.x : box.min.x,
+									  plane.normal.y >= 0.f ? box.max.y : box.min.y,
+									  plane.normal.z >= 0.f ? box.max.z : box.min.z };
+		if ( plane.GetSignedDistance( furthestCorner ) < 0.f )
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool Frustum::Contains( const BoundingBox& box ) const
+{
+	for ( const Plane& plane : planes )
+	{
+		// Mirror of Intersects, the nearest corner decides
+		const Vector3 nearestCorner{ plane.normal.x >= 0.f ? box.min.x : box.max.x,
+									 plane.normal.y >= 0.f ? box.min.y : box.max.y,
+									 plane.normal.z >= 0.f ? box.min.z : box.max.z };
+		if ( plane.GetSignedDistance( nearestCorner ) < 0.f )
+		{
+			return false;
+		}
+	}
+	return true;
+}
+} // namespace dae
@@ -0,0 +1,79 @@
+#ifndef BOUNDINGVOLUMES_H
+#define BOUNDINGVOLUMES_H
+#include <array>
+#include <vector>
+#include "Matrix.h"
+
+// Conservative volumes for whole-mesh visibility tests
+// All tests may report a volume as visible when it is not, never the other way around
+
+namespace dae
+{
+// Direction does not have to be normalized, hit distances are in multiples of it
+struct Ray final
+{
+	Vector3 origin{};
+	Vector3 direction{};
+};
+
+struct BoundingBox final
+{
+	Vector3 min{};
+	Vector3 max{};
+
+	// Throws error::mesh::BufferIsEmpty on an empty vertex list
+	static BoundingBox FromVertices( const std::vector<Vertex>& vertices );
+	// Inverted box that any Grow replaces
+	static BoundingBox CreateEmpty();
+
+	Vector3 GetCenter() const;
+	Vector3 GetExtents() const; // Half the size on every axis
+	float GetSurfaceArea() const;
+
+	void Grow( const Vector3& point );
+	void Grow( const BoundingBox& box );
+
+	// Entry distance along the ray, 0 when the origin is inside
+	bool IntersectsRay( const Ray& ray, float maxDistance, float& hitDistance ) const;
+
+	// Box around the transformed box, grows under rotation
+	BoundingBox Transformed( const Matrix& transform ) const;
+};
+
+struct BoundingSphere final
+{
+	Vector3 center{};
+	float radius{};
+
+	// Centered on the box around the vertices, tighter than the sphere around that box
+	static BoundingSphere FromVertices( const std::vector<Vertex>& vertices );
+
+	// Scaled by the largest axis scale of the transform
+	BoundingSphere Transformed( const Matrix& transform ) const;
+};
+
+// Points with a positive signed distance are on the side the normal points to
+struct Plane final
+{
+	Vector3 normal{};
+	float distance{};
+
+	float GetSignedDistance( const Vector3& point ) const;
+};
+
+// Planes point inwards, in the order left, right, bottom, top, near, far
+struct Frustum final
+{
+	std::array<Plane, 6> planes{};
+
+	// Planes of the clip volume of a row vector view * projection matrix, D3D style depth in [0, 1]
+	static Frustum FromViewProjection( const Matrix& viewProjection );
+
+	// A default constructed frustum has all planes at zero and contains everything
+	bool Intersects( const BoundingSphere& sphere ) const;
+	bool Intersects( const BoundingBox& box ) const;
+	// True only when the whole box is inside, everything in it is visible without further tests
+	bool Contains( const BoundingBox& box ) const;
+};
+} // namespace dae
+#endif
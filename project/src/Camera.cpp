@@ -11,6 +11,7 @@ Camera::Camera( const Vector3& origin, float fovAngle, float aspectRatio, float
 	, m_Far{ far }
 {
 	SetFovAngleDegrees( fovAngle );
+	UpdateMatrices(); // Valid before the first Update
 }
 
 // Getters
@@ -19,9 +20,19 @@ const Matrix& Camera::GetViewMatrix() const
 	return m_ViewMatrix;
 }
 
-Matrix Camera::GetProjectionMatrix() const
+const Matrix& Camera::GetProjectionMatrix() const
 {
-	return Matrix::CreatePerspectiveFovLH( m_Fov, m_AspectRatio, m_Near, m_Far );
+	return m_ProjectionMatrix;
+}
+
+const Frustum& Camera::GetFrustum() const
+{
+	return m_Frustum;
+}
+
+uint32_t Camera::GetVersion() const
+{
+	return m_Version;
 }
 
 const Vector3& Camera::GetPosition() const
@@ -49,16 +60,32 @@ float Camera::GetFar() const
 	return m_Far;
 }
 
+Ray Camera::GetRay( float ndcX, float ndcY ) const
+{
+	// The view matrix is rotation + translation only, its inverse has the camera axes as rows
+	const Matrix cameraToWorld{ Matrix::InverseRigid( m_ViewMatrix ) };
+	const Vector3 cameraDirection{ ndcX * m_AspectRatio * m_Fov, ndcY * m_Fov, 1.f };
+	return { m_Origin, cameraToWorld.TransformVector( cameraDirection ).Normalized() };
+}
+
 // Setters
 void Camera::SetPos( const Vector3& newPos )
 {
 	m_Origin = newPos;
+	m_IsViewDirty = true;
 }
 
 void Camera::SetFovAngleDegrees( float newFovAngle )
 {
 	m_FovAngle = newFovAngle / 180.f * PI;
 	m_Fov = tanf( m_FovAngle * 0.5f );
+	m_ProjectionMatrix = Matrix::CreatePerspectiveFovLH( m_Fov, m_AspectRatio, m_Near, m_Far );
+	m_IsFrustumDirty = true;
+}
+
+void Camera::SetInputEnabled( bool isEnabled )
+{
+	m_IsInputEnabled = isEnabled;
 }
 
 // Methods
@@ -67,6 +94,12 @@ void Camera::Update( Timer* pTimer )
 	constexpr float radianConstant{ 1.f / 180.f * PI };
 	constexpr float sensitivity{ 0.25f };
 
+	if ( !m_IsInputEnabled )
+	{
+		UpdateMatrices();
+		return;
+	}
+
 	const float deltaTime = pTimer->GetElapsed();
 	float speedMultiplier{ 10.f };
 
@@ -136,27 +169,51 @@ void Camera::Update( Timer* pTimer )
 	}
 
 	// Update ONB if needed
-	m_ViewMatrix = CalculateViewMatrix();
+	UpdateMatrices();
 }
 
 void Camera::Move( const Vector3& change )
 {
 	m_Origin += change;
+	m_IsViewDirty = true;
 }
 
 void Camera::Rotate( float yaw, float pitch )
 {
-	m_TotalPitch = std::clamp( m_TotalPitch + pitch, -PI * 0.49999f, PI * 0.49999f );
-	m_TotalYaw += yaw;
+	SetRotation( m_TotalYaw + yaw, m_TotalPitch + pitch );
+}
+
+void Camera::SetRotation( float yaw, float pitch )
+{
+	m_TotalPitch = std::clamp( pitch, -PI * 0.49999f, PI * 0.49999f );
+	m_TotalYaw = yaw;
 
 	const Matrix yawRotation{ Matrix::CreateRotationY( m_TotalYaw ) };
 	const Matrix pitchRotation{ Matrix::CreateRotationX( m_TotalPitch ) };
 	const Matrix rotation{ pitchRotation * yawRotation };
 
 	m_Forward = rotation.TransformVector( Vector3::UnitZ );
+	m_IsViewDirty = true;
 }
 
 Matrix Camera::CalculateViewMatrix()
 {
 	return Matrix::CreateLookAtLH( m_Origin, m_Forward );
 }
+
+void Camera::UpdateMatrices()
+{
+	if ( m_IsViewDirty )
+	{
+		m_ViewMatrix = CalculateViewMatrix();
+		m_IsViewDirty = false;
+		m_IsFrustumDirty = true;
+	}
+
+	if ( m_IsFrustumDirty )
+	{
+		m_Frustum = Frustum::FromViewProjection( m_ViewMatrix * m_ProjectionMatrix );
+		m_IsFrustumDirty = false;
+		++m_Version;
+	}
+}
@@ -1,6 +1,7 @@
 #ifndef CAMERA_H
 #define CAMERA_H
 #include <SDL_mouse.h>
+#include "BoundingVolumes.h"
 #include "Timer.h"
 #include "Matrix.h"
 
@@ -18,16 +19,22 @@ public:
 
 	// Getters
 	const Matrix& GetViewMatrix() const;
-	Matrix GetProjectionMatrix() const;
+	const Matrix& GetProjectionMatrix() const;
+	const Frustum& GetFrustum() const; // World space, as of the last Update
+	uint32_t GetVersion() const;	   // Changes whenever the view or projection matrix does
 	const Vector3& GetPosition() const;
 	float GetFov() const;
 	float GetFovAngle() const;
 	float GetNear() const;
 	float GetFar() const;
+	// World space ray through a point on the near plane, x and y in [-1, 1] with y pointing up
+	Ray GetRay( float ndcX, float ndcY ) const;
 
 	// Setters
 	void SetPos( const Vector3& newPos );
 	void SetFovAngleDegrees( float newFovAngle );
+	void SetInputEnabled( bool isEnabled ); // Disable for headless/scripted cameras
+	void SetRotation( float yaw, float pitch ); // Absolute, in radians
 
 	// Methods
 	void Update( Timer* pTimer );
@@ -49,10 +56,20 @@ private:
 	float m_Near{};
 	float m_Far{};
 
+	bool m_IsInputEnabled{ true };
+
+	// Cached, only rebuilt when the camera moves or the projection changes
 	Matrix m_ViewMatrix{};
+	Matrix m_ProjectionMatrix{};
+	Frustum m_Frustum{};
+	bool m_IsViewDirty{ true };
+	bool m_IsFrustumDirty{ true };
+	uint32_t m_Version{};
+	//
 
 	// Methods
 	Matrix CalculateViewMatrix();
+	void UpdateMatrices();
 };
 } // namespace dae
 #endif
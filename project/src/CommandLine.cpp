@@ -0,0 +1,274 @@
+#include "CommandLine.h"
+#include <charconv>
+#include <iostream>
+#include <string_view>
+#include "Error.h"
+
+namespace dae
+{
+namespace
+{
+int ParseInt( std::string_view value, int minValue = 1 )
+{
+	int result{};
+	const auto [pEnd, errorCode]{ std::from_chars( value.data(), value.data() + value.size(), result ) };
+	if ( errorCode != std::errc{} || pEnd != value.data() + value.size() || result < minValue )
+	{
+		throw error::cli::InvalidValue();
+	}
+	return result;
+}
+
+float ParseFloat( std::string_view value )
+{
+	float result{};
+	const auto [pEnd, errorCode]{ std::from_chars( value.data(), value.data() + value.size(), result ) };
+	if ( errorCode != std::errc{} || pEnd != value.data() + value.size() || result <= 0.f )
+	{
+		throw error::cli::InvalidValue();
+	}
+	return result;
+}
+
+LightingMode ParseLightingMode( std::string_view value )
+{
+	if ( value == "observedArea" )
+		return LightingMode::observedArea;
+	if ( value == "diffuse" )
+		return LightingMode::diffuse;
+	if ( value == "specular" )
+		return LightingMode::specular;
+	if ( value == "combined" )
+		return LightingMode::combined;
+
+	throw error::cli::InvalidValue();
+}
+
+FilterMode ParseFilterMode( std::string_view value )
+{
+	if ( value == "point" )
+		return FilterMode::point;
+	if ( value == "linear" )
+		return FilterMode::linear;
+	if ( value == "anisotropic" )
+		return FilterMode::anisotropic;
+
+	throw error::cli::InvalidValue();
+}
+
+MathPrecision ParseMathPrecision( std::string_view value )
+{
+	if ( value == "exact" )
+		return MathPrecision::exact;
+	if ( value == "fast" )
+		return MathPrecision::fast;
+
+	throw error::cli::InvalidValue();
+}
+
+bool ParseMultisampling( std::string_view value )
+{
+	if ( value == "off" )
+		return false;
+	if ( value == "4x" )
+		return true;
+
+	throw error::cli::InvalidValue();
+}
+
+bool ParseSwitch( std::string_view value )
+{
+	if ( value == "off" )
+		return false;
+	if ( value == "on" )
+		return true;
+
+	throw error::cli::InvalidValue();
+}
+
+VertexFormat ParseVertexFormat( std::string_view value )
+{
+	if ( value == "full" )
+		return VertexFormat::full;
+	if ( value == "packed" )
+		return VertexFormat::packed;
+
+	throw error::cli::InvalidValue();
+}
+
+FrameOutput ParseFrameOutput( std::string_view value )
+{
+	if ( value == "png" )
+		return FrameOutput::png;
+	if ( value == "raw" )
+		return FrameOutput::raw;
+
+	throw error::cli::InvalidValue();
+}
+} // namespace
+
+LaunchOptions ParseCommandLine( int argc, char* argv[] )
+{
+	LaunchOptions options{};
+
+	bool hasFormat{ false };
+	for ( int argIdx{ 1 }; argIdx < argc; ++argIdx )
+	{
+		const std::string_view option{ argv[argIdx] };
+
+		// Flags
+		if ( option == "--headless" )
+		{
+			options.isHeadless = true;
+			continue;
+		}
+		if ( option == "--compare-precision" )
+		{
+			options.isPrecisionComparison = true;
+			options.isHeadless = true;
+			continue;
+		}
+		if ( option == "--help" || option == "-h" )
+		{
+			options.showHelp = true;
+			continue;
+		}
+
+		// Everything else takes a value
+		if ( argIdx + 1 >= argc )
+		{
+			throw error::cli::MissingValue();
+		}
+		const std::string_view value{ argv[++argIdx] };
+
+		if ( option == "--width" )
+		{
+			options.width = ParseInt( value );
+		}
+		else if ( option == "--height" )
+		{
+			options.height = ParseInt( value );
+		}
+		else if ( option == "--scene" )
+		{
+			options.sceneName = value;
+		}
+		else if ( option == "--frames" )
+		{
+			options.frameCount = ParseInt( value );
+		}
+		else if ( option == "--timestep" )
+		{
+			options.timeStep = ParseFloat( value );
+		}
+		else if ( option == "--lighting" )
+		{
+			options.lightingMode = ParseLightingMode( value );
+		}
+		else if ( option == "--sampler" )
+		{
+			options.filterMode = ParseFilterMode( value );
+		}
+		else if ( option == "--precision" )
+		{
+			options.mathPrecision = ParseMathPrecision( value );
+		}
+		else if ( option == "--msaa" )
+		{
+			options.useMultisampling = ParseMultisampling( value );
+		}
+		else if ( option == "--incremental" )
+		{
+			options.useIncrementalRendering = ParseSwitch( value );
+		}
+		else if ( option == "--vrs" )
+		{
+			options.useVariableRateShading = ParseSwitch( value );
+		}
+		else if ( option == "--frame-budget" )
+		{
+			options.frameBudgetMs = ParseFloat( value );
+		}
+		else if ( option == "--threads" )
+		{
+			options.threadCount = ParseInt( value, 0 );
+		}
+		else if ( option == "--pipelined" )
+		{
+			options.usePipelining = ParseSwitch( value );
+		}
+		else if ( option == "--vertices" )
+		{
+			options.vertexFormat = ParseVertexFormat( value );
+		}
+		else if ( option == "--output" )
+		{
+			options.outputDirectory = value;
+			if ( !hasFormat )
+			{
+				options.frameOutput = FrameOutput::png;
+			}
+		}
+		else if ( option == "--format" )
+		{
+			options.frameOutput = ParseFrameOutput( value );
+			hasFormat = true;
+		}
+		else if ( option == "--benchmark" )
+		{
+			options.isBenchmark = true;
+			options.isHeadless = true;
+			options.benchmarkPath = value;
+		}
+		else if ( option == "--warmup" )
+		{
+			options.warmupFrameCount = ParseInt( value, 0 );
+		}
+		else if ( option == "--trace" )
+		{
+			options.tracePath = value;
+		}
+		else
+		{
+			throw error::cli::UnknownOption();
+		}
+	}
+
+	return options;
+}
+
+void DisplayUsage()
+{
+	std::cout << "Usage: GP1_DirectX [options]\n"
+			  << "  --headless                Render without a window or GPU, software renderer only\n"
+			  << "  --width <px>              Render width (default 640)\n"
+			  << "  --height <px>             Render height (default 480)\n"
+			  << "  --scene <name>            Scene to load: vehicle, fleet (default vehicle)\n"
+			  << "  --lighting <mode>         observedArea | diffuse | specular | combined (default combined)\n"
+			  << "  --sampler <mode>          point | linear | anisotropic (default point)\n"
+			  << "  --precision <mode>        exact | fast, software shading math (default exact)\n"
+			  << "  --msaa <mode>             off | 4x, software anti-aliasing (default off)\n"
+			  << "  --incremental <mode>      on | off, software only redraws what moved (default on)\n"
+			  << "  --vrs <mode>              on | off, software shades flat areas per 2x2 or 4x4 (default off)\n"
+			  << "  --frame-budget <ms>       Scale the software render resolution to fit each frame in <ms>\n"
+			  << "  --threads <count>         Job system threads including the main one, 0 -> one per core (default 0)\n"
+			  << "  --pipelined <mode>        on | off, update the next frame while software renders this one (default off)\n"
+			  << "  --vertices <format>       full | packed, 20 byte quantized vertices for both renderers (default full)\n"
+			  << "  --trace <file.json>       Write profiler zones as a Chrome trace on exit (ENABLE_PROFILING builds)\n"
+			  << "  --help                    Show this\n\n"
+
+			  << "Headless only:\n"
+			  << "  --frames <count>          Number of frames to render (default 60)\n"
+			  << "  --timestep <seconds>      Fixed simulation step per frame (default 1/60)\n"
+			  << "  --output <directory>      Write every frame to <directory>/frame_NNNN.<format>\n"
+			  << "  --format <png|raw>        Frame file format, raw is headerless ARGB8888 (default png)\n\n"
+
+			  << "Benchmark (headless, deterministic camera path):\n"
+			  << "  --benchmark <file.json>   Time --frames frames and write per-stage statistics as JSON\n"
+			  << "  --warmup <count>          Untimed frames before measuring (default 10)\n\n"
+
+			  << "Precision comparison (headless):\n"
+			  << "  --compare-precision       Render --frames frames with exact and fast math and compare the images\n"
+			  << "                            Fails when a channel is off by more than 2 or the PSNR drops below 50 dB\n";
+}
+} // namespace dae
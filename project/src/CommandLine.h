@@ -0,0 +1,58 @@
+#ifndef COMMANDLINE_H
+#define COMMANDLINE_H
+#include <string>
+#include "FilterMode.h"
+#include "Shading.h"
+#include "VertexPacking.h"
+
+namespace dae
+{
+enum class FrameOutput
+{
+	none,
+	png,
+	raw, // Tightly packed 32-bit ARGB8888 rows, no header
+};
+
+struct LaunchOptions final
+{
+	bool isHeadless{ false };
+	bool isBenchmark{ false }; // Implies headless
+	bool isPrecisionComparison{ false }; // Implies headless
+	bool showHelp{ false };
+
+	int width{ 640 };
+	int height{ 480 };
+	std::string sceneName{ "vehicle" };
+
+	// Headless only
+	int frameCount{ 60 };
+	float timeStep{ 1.f / 60.f };
+	FrameOutput frameOutput{ FrameOutput::none };
+	std::string outputDirectory{ "." };
+	//
+
+	// Benchmark only
+	int warmupFrameCount{ 10 };
+	std::string benchmarkPath{ "benchmark.json" };
+	//
+
+	std::string tracePath{}; // Empty -> no trace, needs a build with ENABLE_PROFILING
+
+	LightingMode lightingMode{ LightingMode::combined };
+	FilterMode filterMode{ FilterMode::point };
+	MathPrecision mathPrecision{ MathPrecision::exact };
+	bool useMultisampling{ false };
+	bool useIncrementalRendering{ true };
+	float frameBudgetMs{}; // 0 -> software always renders at full resolution
+	bool useVariableRateShading{ false };
+	int threadCount{}; // Job system threads, the main thread included, 0 -> one per hardware thread
+	bool usePipelining{ false }; // Update the next frame while the software renderer draws this one
+	VertexFormat vertexFormat{ VertexFormat::full };
+};
+
+// Throws error::cli errors on unknown options or malformed values
+LaunchOptions ParseCommandLine( int argc, char* argv[] );
+void DisplayUsage();
+} // namespace dae
+#endif
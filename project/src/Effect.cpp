@@ -1,5 +1,7 @@
 #include <sstream>
+#include <algorithm>
 #include <array>
+#include <cstddef>
 #include <d3dx11effect.h>
 #include <d3dcompiler.h>
 #include "Effect.h"
@@ -9,6 +11,12 @@ using namespace dae;
 
 Effect::Effect( ID3D11Device* pDevice, const std::wstring& assetFile )
 {
+	// No device -> software rendering only, nothing to load
+	if ( !pDevice )
+	{
+		return;
+	}
+
 	m_pEffect = Effect::LoadEffect( pDevice, assetFile );
 
 	if ( !m_pEffect )
@@ -73,6 +81,106 @@ Effect::Effect( ID3D11Device* pDevice, const std::wstring& assetFile )
 	}
 	//
 
+	// Create Instanced Input Layout: same vertex, plus the rows of a world matrix stepping once per instance
+	m_pInstancedTechnique = m_pEffect->GetTechniqueByName( "InstancedTechnique" );
+
+	if ( !m_pInstancedTechnique->IsValid() )
+	{
+		throw error::effect::InvalidTechnique();
+	}
+
+	constexpr int matrixRowCount{ 4 };
+	std::array<D3D11_INPUT_ELEMENT_DESC, elementCount + matrixRowCount> instancedVertexDesc{};
+	std::copy( vertexDesc.begin(), vertexDesc.end(), instancedVertexDesc.begin() );
+	for ( int rowIdx{}; rowIdx < matrixRowCount; ++rowIdx )
+	{
+		D3D11_INPUT_ELEMENT_DESC& rowDesc{ instancedVertexDesc[elementCount + rowIdx] };
+		rowDesc.SemanticName = "INSTANCEWORLD";
+		rowDesc.SemanticIndex = rowIdx;
+		rowDesc.Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
+		rowDesc.InputSlot = 1;
+		rowDesc.AlignedByteOffset = rowIdx * sizeof( Vector4 );
+		rowDesc.InputSlotClass = D3D11_INPUT_PER_INSTANCE_DATA;
+		rowDesc.InstanceDataStepRate = 1;
+	}
+
+	D3DX11_PASS_DESC instancedPassDesc{};
+	m_pInstancedTechnique->GetPassByIndex( 0 )->GetDesc( &instancedPassDesc );
+
+	result = pDevice->CreateInputLayout( instancedVertexDesc.data(),
+										 instancedVertexDesc.size(),
+										 instancedPassDesc.pIAInputSignature,
+										 instancedPassDesc.IAInputSignatureSize,
+										 &m_pInstancedInputLayout );
+	if ( FAILED( result ) )
+	{
+		throw error::effect::LayoutCreateFail();
+	}
+	//
+
+	// Create Packed Input Layouts: PackedVertex for the shader to decode, the instanced one with the same matrix rows
+	m_pPackedTechnique = m_pEffect->GetTechniqueByName( "PackedTechnique" );
+	m_pPackedInstancedTechnique = m_pEffect->GetTechniqueByName( "PackedInstancedTechnique" );
+
+	if ( !m_pPackedTechnique->IsValid() || !m_pPackedInstancedTechnique->IsValid() )
+	{
+		throw error::effect::InvalidTechnique();
+	}
+
+	constexpr int packedElementCount{ 4 };
+	std::array<D3D11_INPUT_ELEMENT_DESC, packedElementCount + matrixRowCount> packedVertexDesc{};
+
+	packedVertexDesc[0].SemanticName = "POSITION";
+	packedVertexDesc[0].Format = DXGI_FORMAT_R16G16B16A16_UNORM;
+	packedVertexDesc[0].AlignedByteOffset = offsetof( PackedVertex, position );
+	packedVertexDesc[0].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+
+	packedVertexDesc[1].SemanticName = "NORMAL";
+	packedVertexDesc[1].Format = DXGI_FORMAT_R16G16_SNORM;
+	packedVertexDesc[1].AlignedByteOffset = offsetof( PackedVertex, normal );
+	packedVertexDesc[1].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+
+	packedVertexDesc[2].SemanticName = "TANGENT";
+	packedVertexDesc[2].Format = DXGI_FORMAT_R16G16_SNORM;
+	packedVertexDesc[2].AlignedByteOffset = offsetof( PackedVertex, tangent );
+	packedVertexDesc[2].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+
+	packedVertexDesc[3].SemanticName = "TEXCOORD";
+	packedVertexDesc[3].Format = DXGI_FORMAT_R16G16_FLOAT;
+	packedVertexDesc[3].AlignedByteOffset = offsetof( PackedVertex, uv );
+	packedVertexDesc[3].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+
+	std::copy( instancedVertexDesc.begin() + elementCount,
+			   instancedVertexDesc.end(),
+			   packedVertexDesc.begin() + packedElementCount );
+
+	D3DX11_PASS_DESC packedPassDesc{};
+	m_pPackedTechnique->GetPassByIndex( 0 )->GetDesc( &packedPassDesc );
+
+	result = pDevice->CreateInputLayout( packedVertexDesc.data(),
+										 packedElementCount,
+										 packedPassDesc.pIAInputSignature,
+										 packedPassDesc.IAInputSignatureSize,
+										 &m_pPackedInputLayout );
+	if ( FAILED( result ) )
+	{
+		throw error::effect::LayoutCreateFail();
+	}
+
+	D3DX11_PASS_DESC packedInstancedPassDesc{};
+	m_pPackedInstancedTechnique->GetPassByIndex( 0 )->GetDesc( &packedInstancedPassDesc );
+
+	result = pDevice->CreateInputLayout( packedVertexDesc.data(),
+										 packedVertexDesc.size(),
+										 packedInstancedPassDesc.pIAInputSignature,
+										 packedInstancedPassDesc.IAInputSignatureSize,
+										 &m_pPackedInstancedInputLayout );
+	if ( FAILED( result ) )
+	{
+		throw error::effect::LayoutCreateFail();
+	}
+	//
+
 	// Get pointers to shader variables
 	m_pWorldViewProjection = m_pEffect->GetVariableByName( "gWorldViewProj" )->AsMatrix();
 	if ( !m_pWorldViewProjection->IsValid() )
@@ -86,12 +194,25 @@ Effect::Effect( ID3D11Device* pDevice, const std::wstring& assetFile )
 		throw error::effect::InvalidWorld();
 	}
 
+	m_pViewProjection = m_pEffect->GetVariableByName( "gViewProj" )->AsMatrix();
+	if ( !m_pViewProjection->IsValid() )
+	{
+		throw error::effect::InvalidViewProjection();
+	}
+
 	m_pCameraOrigin = m_pEffect->GetVariableByName( "gCameraOrigin" )->AsVector();
 	if ( !m_pCameraOrigin->IsValid() )
 	{
 		throw error::effect::InvalidCameraOrigin();
 	}
 
+	m_pPositionOffset = m_pEffect->GetVariableByName( "gPositionOffset" )->AsVector();
+	m_pPositionScale = m_pEffect->GetVariableByName( "gPositionScale" )->AsVector();
+	if ( !m_pPositionOffset->IsValid() || !m_pPositionScale->IsValid() )
+	{
+		throw error::effect::InvalidPositionDequantization();
+	}
+
 	m_pDiffuseMap = m_pEffect->GetVariableByName( "gDiffuseMap" )->AsShaderResource();
 	if ( !m_pDiffuseMap->IsValid() )
 	{
@@ -136,6 +257,15 @@ Effect::Effect( Effect&& rhs )
 	m_pInputLayout = rhs.m_pInputLayout;
 	rhs.m_pInputLayout = nullptr;
 
+	m_pInstancedInputLayout = rhs.m_pInstancedInputLayout;
+	rhs.m_pInstancedInputLayout = nullptr;
+
+	m_pPackedInputLayout = rhs.m_pPackedInputLayout;
+	rhs.m_pPackedInputLayout = nullptr;
+
+	m_pPackedInstancedInputLayout = rhs.m_pPackedInstancedInputLayout;
+	rhs.m_pPackedInstancedInputLayout = nullptr;
+
 	m_Sampler = std::move( rhs.m_Sampler );
 	//
 
@@ -143,15 +273,33 @@ Effect::Effect( Effect&& rhs )
 	m_pTechnique = rhs.m_pTechnique;
 	rhs.m_pTechnique = nullptr;
 
+	m_pInstancedTechnique = rhs.m_pInstancedTechnique;
+	rhs.m_pInstancedTechnique = nullptr;
+
+	m_pPackedTechnique = rhs.m_pPackedTechnique;
+	rhs.m_pPackedTechnique = nullptr;
+
+	m_pPackedInstancedTechnique = rhs.m_pPackedInstancedTechnique;
+	rhs.m_pPackedInstancedTechnique = nullptr;
+
 	m_pWorldViewProjection = rhs.m_pWorldViewProjection;
 	rhs.m_pWorldViewProjection = nullptr;
 
 	m_pWorld = rhs.m_pWorld;
 	rhs.m_pWorld = nullptr;
 
+	m_pViewProjection = rhs.m_pViewProjection;
+	rhs.m_pViewProjection = nullptr;
+
 	m_pCameraOrigin = rhs.m_pCameraOrigin;
 	rhs.m_pCameraOrigin = nullptr;
 
+	m_pPositionOffset = rhs.m_pPositionOffset;
+	rhs.m_pPositionOffset = nullptr;
+
+	m_pPositionScale = rhs.m_pPositionScale;
+	rhs.m_pPositionScale = nullptr;
+
 	m_pDiffuseMap = rhs.m_pDiffuseMap;
 	rhs.m_pDiffuseMap = nullptr;
 
@@ -180,6 +328,15 @@ Effect& Effect::operator=( Effect&& rhs )
 	m_pInputLayout = rhs.m_pInputLayout;
 	rhs.m_pInputLayout = nullptr;
 
+	m_pInstancedInputLayout = rhs.m_pInstancedInputLayout;
+	rhs.m_pInstancedInputLayout = nullptr;
+
+	m_pPackedInputLayout = rhs.m_pPackedInputLayout;
+	rhs.m_pPackedInputLayout = nullptr;
+
+	m_pPackedInstancedInputLayout = rhs.m_pPackedInstancedInputLayout;
+	rhs.m_pPackedInstancedInputLayout = nullptr;
+
 	m_Sampler = std::move( rhs.m_Sampler );
 	//
 
@@ -187,15 +344,33 @@ Effect& Effect::operator=( Effect&& rhs )
 	m_pTechnique = rhs.m_pTechnique;
 	rhs.m_pTechnique = nullptr;
 
+	m_pInstancedTechnique = rhs.m_pInstancedTechnique;
+	rhs.m_pInstancedTechnique = nullptr;
+
+	m_pPackedTechnique = rhs.m_pPackedTechnique;
+	rhs.m_pPackedTechnique = nullptr;
+
+	m_pPackedInstancedTechnique = rhs.m_pPackedInstancedTechnique;
+	rhs.m_pPackedInstancedTechnique = nullptr;
+
 	m_pWorldViewProjection = rhs.m_pWorldViewProjection;
 	rhs.m_pWorldViewProjection = nullptr;
 
 	m_pWorld = rhs.m_pWorld;
 	rhs.m_pWorld = nullptr;
 
+	m_pViewProjection = rhs.m_pViewProjection;
+	rhs.m_pViewProjection = nullptr;
+
 	m_pCameraOrigin = rhs.m_pCameraOrigin;
 	rhs.m_pCameraOrigin = nullptr;
 
+	m_pPositionOffset = rhs.m_pPositionOffset;
+	rhs.m_pPositionOffset = nullptr;
+
+	m_pPositionScale = rhs.m_pPositionScale;
+	rhs.m_pPositionScale = nullptr;
+
 	m_pDiffuseMap = rhs.m_pDiffuseMap;
 	rhs.m_pDiffuseMap = nullptr;
 
@@ -223,6 +398,21 @@ Effect::~Effect() noexcept
 	{
 		m_pInputLayout->Release();
 	}
+
+	if ( m_pInstancedInputLayout )
+	{
+		m_pInstancedInputLayout->Release();
+	}
+
+	if ( m_pPackedInputLayout )
+	{
+		m_pPackedInputLayout->Release();
+	}
+
+	if ( m_pPackedInstancedInputLayout )
+	{
+		m_pPackedInstancedInputLayout->Release();
+	}
 }
 
 ID3DX11Effect* Effect::operator->()
@@ -235,6 +425,11 @@ void Effect::CycleFilteringMode()
 	m_Sampler.Cycle();
 }
 
+void Effect::SetFilteringMode( FilterMode filterMode )
+{
+	m_Sampler.SetFilterMode( filterMode );
+}
+
 void Effect::SetWorldViewProjection( const Matrix& wvp )
 {
 	m_pWorldViewProjection->SetMatrix( reinterpret_cast<const float*>( &wvp ) );
@@ -245,12 +440,25 @@ void Effect::SetWorld( const Matrix& w )
 	m_pWorld->SetMatrix( reinterpret_cast<const float*>( &w ) );
 }
 
+void Effect::SetViewProjection( const Matrix& vp )
+{
+	m_pViewProjection->SetMatrix( reinterpret_cast<const float*>( &vp ) );
+}
+
 void Effect::SetCameraOrigin( const Vector3& o )
 {
 	const Vector4 input{ o, 1.f };
 	m_pCameraOrigin->SetFloatVector( reinterpret_cast<const float*>( &input ) );
 }
 
+void Effect::SetPositionDequantization( const PositionDequantization& dequantization )
+{
+	const Vector4 offset{ dequantization.offset, 0.f };
+	const Vector4 scale{ dequantization.scale, 0.f };
+	m_pPositionOffset->SetFloatVector( reinterpret_cast<const float*>( &offset ) );
+	m_pPositionScale->SetFloatVector( reinterpret_cast<const float*>( &scale ) );
+}
+
 void Effect::SetDiffuseMap( const Texture& diffuseMap )
 {
 	m_pDiffuseMap->SetResource( diffuseMap.GetSRV() );
@@ -281,8 +489,49 @@ ID3D11InputLayout* Effect::GetInputLayoutPtr() const
 	return m_pInputLayout;
 }
 
+ID3DX11EffectTechnique* Effect::GetInstancedTechniquePtr() const
+{
+	return m_pInstancedTechnique;
+}
+
+ID3D11InputLayout* Effect::GetInstancedInputLayoutPtr() const
+{
+	return m_pInstancedInputLayout;
+}
+
+ID3DX11EffectTechnique* Effect::GetPackedTechniquePtr() const
+{
+	return m_pPackedTechnique;
+}
+
+ID3D11InputLayout* Effect::GetPackedInputLayoutPtr() const
+{
+	return m_pPackedInputLayout;
+}
+
+ID3DX11EffectTechnique* Effect::GetPackedInstancedTechniquePtr() const
+{
+	return m_pPackedInstancedTechnique;
+}
+
+ID3D11InputLayout* Effect::GetPackedInstancedInputLayoutPtr() const
+{
+	return m_pPackedInstancedInputLayout;
+}
+
+bool Effect::IsInitialized() const
+{
+	return m_pEffect != nullptr;
+}
+
 TransparentEffect::TransparentEffect( ID3D11Device* pDevice, const std::wstring& assetFile )
 {
+	// No device -> software rendering only, nothing to load
+	if ( !pDevice )
+	{
+		return;
+	}
+
 	m_pEffect = Effect::LoadEffect( pDevice, assetFile );
 
 	if ( !m_pEffect )
@@ -449,6 +698,11 @@ void TransparentEffect::CycleFilteringMode()
 	m_Sampler.Cycle();
 }
 
+void TransparentEffect::SetFilteringMode( FilterMode filterMode )
+{
+	m_Sampler.SetFilterMode( filterMode );
+}
+
 void TransparentEffect::SetWorldViewProjection( const Matrix& wvp )
 {
 	m_pWorldViewProjection->SetMatrix( reinterpret_cast<const float*>( &wvp ) );
@@ -469,6 +723,11 @@ ID3D11InputLayout* TransparentEffect::GetInputLayoutPtr() const
 	return m_pInputLayout;
 }
 
+bool TransparentEffect::IsInitialized() const
+{
+	return m_pEffect != nullptr;
+}
+
 ID3DX11Effect* Effect::LoadEffect( ID3D11Device* pDevice, const std::wstring& assetFile )
 {
 	HRESULT result{};
@@ -6,6 +6,7 @@
 #include "Matrix.h"
 #include "Sampler.h"
 #include "Texture.h"
+#include "VertexPacking.h"
 
 namespace dae
 {
@@ -26,10 +27,13 @@ public:
 
 	// Methods
 	void CycleFilteringMode();
+	void SetFilteringMode( FilterMode filterMode );
 
 	// Setters
 	void SetWorldViewProjection( const Matrix& wvp );
 	void SetWorld( const Matrix& w );
+	void SetViewProjection( const Matrix& vp ); // Instanced technique only
+	void SetPositionDequantization( const PositionDequantization& dequantization ); // Packed techniques only
 	void SetCameraOrigin( const Vector3& o );
 	void SetDiffuseMap( const Texture& diffuseMap );
 	void SetNormalMap( const Texture& normalMap );
@@ -39,6 +43,15 @@ public:
 	// Getters
 	ID3DX11EffectTechnique* GetTechniquePtr() const;
 	ID3D11InputLayout* GetInputLayoutPtr() const;
+	// Second vertex buffer slot holds one world matrix per instance
+	ID3DX11EffectTechnique* GetInstancedTechniquePtr() const;
+	ID3D11InputLayout* GetInstancedInputLayoutPtr() const;
+	// Same techniques reading PackedVertex
+	ID3DX11EffectTechnique* GetPackedTechniquePtr() const;
+	ID3D11InputLayout* GetPackedInputLayoutPtr() const;
+	ID3DX11EffectTechnique* GetPackedInstancedTechniquePtr() const;
+	ID3D11InputLayout* GetPackedInstancedInputLayoutPtr() const;
+	bool IsInitialized() const; // False for software-only effects created without a device
 
 	static ID3DX11Effect* LoadEffect( ID3D11Device* pDevice, const std::wstring& assetFile );
 
@@ -46,14 +59,23 @@ private:
 	// HARDWARE RESOURCES: OWNING
 	ID3DX11Effect* m_pEffect{};
 	ID3D11InputLayout* m_pInputLayout{};
+	ID3D11InputLayout* m_pInstancedInputLayout{};
+	ID3D11InputLayout* m_pPackedInputLayout{};
+	ID3D11InputLayout* m_pPackedInstancedInputLayout{};
 	Sampler m_Sampler{};
 	//
 
 	// HARDWARE RESOURCES: NON-OWNING
 	ID3DX11EffectTechnique* m_pTechnique{};
+	ID3DX11EffectTechnique* m_pInstancedTechnique{};
+	ID3DX11EffectTechnique* m_pPackedTechnique{};
+	ID3DX11EffectTechnique* m_pPackedInstancedTechnique{};
 	ID3DX11EffectMatrixVariable* m_pWorldViewProjection{};
 	ID3DX11EffectMatrixVariable* m_pWorld{};
+	ID3DX11EffectMatrixVariable* m_pViewProjection{};
 	ID3DX11EffectVectorVariable* m_pCameraOrigin{};
+	ID3DX11EffectVectorVariable* m_pPositionOffset{};
+	ID3DX11EffectVectorVariable* m_pPositionScale{};
 	ID3DX11EffectShaderResourceVariable* m_pDiffuseMap{};
 	ID3DX11EffectShaderResourceVariable* m_pNormalMap{};
 	ID3DX11EffectShaderResourceVariable* m_pSpecularMap{};
@@ -77,6 +99,7 @@ public:
 
 	// Methods
 	void CycleFilteringMode();
+	void SetFilteringMode( FilterMode filterMode );
 
 	// Setters
 	void SetWorldViewProjection( const Matrix& wvp );
@@ -85,6 +108,7 @@ public:
 	// Getters
 	ID3DX11EffectTechnique* GetTechniquePtr() const;
 	ID3D11InputLayout* GetInputLayoutPtr() const;
+	bool IsInitialized() const;
 
 private:
 	// HARDWARE RESOURCES: OWNING
@@ -7,8 +7,10 @@
 #include <iostream>
 #include <string>
 
-#define WIN32_LEAN_AND_MEAN
-#include <windows.h>
+#ifndef SOFTWARE_ONLY
+#	define WIN32_LEAN_AND_MEAN
+#	include <windows.h>
+#endif
 
 namespace error
 {
@@ -102,6 +104,15 @@ public:
 	}
 };
 
+class InvalidViewProjection : public EffectError
+{
+public:
+	virtual std::string what() const override
+	{
+		return "InvalidViewProjection";
+	}
+};
+
 class InvalidWorld : public EffectError
 {
 public:
@@ -120,6 +131,15 @@ public:
 	}
 };
 
+class InvalidPositionDequantization : public EffectError
+{
+public:
+	virtual std::string what() const override
+	{
+		return "InvalidPositionDequantization";
+	}
+};
+
 class InvalidMap : public EffectError
 {
 public:
@@ -236,8 +256,56 @@ public:
 		return "SceneIsEmpty";
 	}
 };
+
+class UnknownScene : public SceneError
+{
+public:
+	virtual std::string what() const override
+	{
+		return "UnknownScene";
+	}
+};
 } // namespace scene
 
+namespace cli
+{
+class CommandLineError : public Error
+{
+public:
+	virtual std::string category() const override
+	{
+		return "CLI_ERR";
+	}
+};
+
+class UnknownOption : public CommandLineError
+{
+public:
+	virtual std::string what() const override
+	{
+		return "UnknownOption";
+	}
+};
+
+class MissingValue : public CommandLineError
+{
+public:
+	virtual std::string what() const override
+	{
+		return "MissingValue";
+	}
+};
+
+class InvalidValue : public CommandLineError
+{
+public:
+	virtual std::string what() const override
+	{
+		return "InvalidValue";
+	}
+};
+} // namespace cli
+
 namespace rendering
 {
 class RenderError : public Error
@@ -336,6 +404,15 @@ public:
 
 namespace utils
 {
+// Console colors are Windows only, software only targets print without them
+inline void SetConsoleColor( [[maybe_unused]] int color )
+{
+#ifndef SOFTWARE_ONLY
+	HANDLE consoleHandle{ GetStdHandle( STD_OUTPUT_HANDLE ) };
+	SetConsoleTextAttribute( consoleHandle, color );
+#endif
+}
+
 template <typename Function>
 bool HandleThrowingFunction( Function f ) noexcept // All exceptions are contained within this function -> doesn't throw
 {
@@ -345,62 +422,56 @@ bool HandleThrowingFunction( Function f ) noexcept // All exceptions are contain
 	}
 	catch ( const Error& e )
 	{
-		HANDLE consoleHandle{ GetStdHandle( STD_OUTPUT_HANDLE ) };
-		SetConsoleTextAttribute( consoleHandle, 12 );
+		SetConsoleColor( 12 );
 
 		std::cout << "[" << e.category() << "]: " << e.what() << "\n";
 
-		SetConsoleTextAttribute( consoleHandle, 7 );
+		SetConsoleColor( 7 );
 		return true;
 	}
 	catch ( const std::exception& e )
 	{
-		HANDLE consoleHandle{ GetStdHandle( STD_OUTPUT_HANDLE ) };
-		SetConsoleTextAttribute( consoleHandle, 12 );
+		SetConsoleColor( 12 );
 
 		std::cout << "Caught exception: " << e.what() << "\n";
 
-		SetConsoleTextAttribute( consoleHandle, 7 );
+		SetConsoleColor( 7 );
 		return true;
 	}
 	catch ( const std::string& eString )
 	{
-		HANDLE consoleHandle{ GetStdHandle( STD_OUTPUT_HANDLE ) };
-		SetConsoleTextAttribute( consoleHandle, 12 );
+		SetConsoleColor( 12 );
 
 		std::cout << "Caught exception: " << eString << "\n";
 
-		SetConsoleTextAttribute( consoleHandle, 7 );
+		SetConsoleColor( 7 );
 		return true;
 	}
 	catch ( int eCode )
 	{
-		HANDLE consoleHandle{ GetStdHandle( STD_OUTPUT_HANDLE ) };
-		SetConsoleTextAttribute( consoleHandle, 12 );
+		SetConsoleColor( 12 );
 
 		std::cout << "Caught exception: CODE=[0x" << std::hex << eCode << "]\n";
 
-		SetConsoleTextAttribute( consoleHandle, 7 );
+		SetConsoleColor( 7 );
 		return true;
 	}
 	catch ( uint32_t eCode )
 	{
-		HANDLE consoleHandle{ GetStdHandle( STD_OUTPUT_HANDLE ) };
-		SetConsoleTextAttribute( consoleHandle, 12 );
+		SetConsoleColor( 12 );
 
 		std::cout << "Caught exception: CODE=[0x" << std::hex << eCode << "]\n";
 
-		SetConsoleTextAttribute( consoleHandle, 7 );
+		SetConsoleColor( 7 );
 		return true;
 	}
 	catch ( ... )
 	{
-		HANDLE consoleHandle{ GetStdHandle( STD_OUTPUT_HANDLE ) };
-		SetConsoleTextAttribute( consoleHandle, 12 );
+		SetConsoleColor( 12 );
 
 		std::cout << "Caught unhandled exception\n";
 
-		SetConsoleTextAttribute( consoleHandle, 7 );
+		SetConsoleColor( 7 );
 		return true;
 	}
 
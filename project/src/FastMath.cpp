@@ -0,0 +1,60 @@
+#include "FastMath.h"
+#include <array>
+
+namespace dae::fastMath
+{
+namespace
+{
+// Enough entries that the steepest part of the curve, right above 0, moves less than half a step between them
+constexpr int linearTableSize{ 4096 };
+
+float SrgbToLinearExact( float srgb )
+{
+	return srgb <= 0.04045f ? srgb / 12.92f : std::pow( ( srgb + 0.055f ) / 1.055f, 2.4f );
+}
+
+float LinearToSrgbExact( float linear )
+{
+	return linear <= 0.0031308f ? linear * 12.92f : 1.055f * std::pow( linear, 1.f / 2.4f ) - 0.055f;
+}
+
+const std::array<float, 256>& GetSrgbToLinearTable()
+{
+	static const std::array<float, 256> table{ []() {
+		std::array<float, 256> result{};
+		for ( int index{}; index < 256; ++index )
+		{
+			result[index] = SrgbToLinearExact( index / 255.f );
+		}
+		return result;
+	}() };
+	return table;
+}
+
+const std::array<uint8_t, linearTableSize>& GetLinearToSrgbTable()
+{
+	static const std::array<uint8_t, linearTableSize> table{ []() {
+		std::array<uint8_t, linearTableSize> result{};
+		for ( int index{}; index < linearTableSize; ++index )
+		{
+			const float linear{ static_cast<float>( index ) / ( linearTableSize - 1 ) };
+			result[index] = static_cast<uint8_t>( LinearToSrgbExact( linear ) * 255.f + 0.5f );
+		}
+		return result;
+	}() };
+	return table;
+}
+} // namespace
+
+float SrgbToLinear( uint8_t srgb ) noexcept
+{
+	return GetSrgbToLinearTable()[srgb];
+}
+
+uint8_t LinearToSrgb( float linear ) noexcept
+{
+	// Saturate also maps NaN to 0
+	const float saturated{ linear > 0.f ? ( linear < 1.f ? linear : 1.f ) : 0.f };
+	return GetLinearToSrgbTable()[static_cast<int>( saturated * ( linearTableSize - 1 ) + 0.5f )];
+}
+} // namespace dae::fastMath
@@ -0,0 +1,143 @@
+#ifndef FASTMATH_H
+#define FASTMATH_H
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include "Structs.h"
+
+// SSE is part of the x64 baseline, other targets fall back to the bit tricks
+#if defined( __SSE__ ) || defined( _M_X64 ) || defined( _M_AMD64 )
+#	define FASTMATH_SIMD
+#	include <xmmintrin.h>
+#endif
+
+// Approximations for the software shading path
+// Every function documents its worst error, measured over its whole useful input range
+// The exact path stays the reference: anything here has to be selected through MathPrecision
+
+namespace dae
+{
+enum class MathPrecision
+{
+	exact, // <cmath> and the Vector3 members
+	fast,  // The approximations below
+	count,
+};
+} // namespace dae
+
+namespace dae::fastMath
+{
+// 1 / sqrt( x ) for x > 0
+// Max relative error: 2.8e-7 with SSE, 4.8e-6 without
+inline float Rsqrt( float x ) noexcept
+{
+#ifdef FASTMATH_SIMD
+	// 12 bit estimate + one Newton-Raphson step
+	const float estimate{ _mm_cvtss_f32( _mm_rsqrt_ss( _mm_set_ss( x ) ) ) };
+	return estimate * ( 1.5f - 0.5f * x * estimate * estimate );
+#else
+	// Bit level estimate + two Newton-Raphson steps
+	float estimate{ std::bit_cast<float>( 0x5f375a86u - ( std::bit_cast<uint32_t>( x ) >> 1 ) ) };
+	estimate *= 1.5f - 0.5f * x * estimate * estimate;
+	return estimate * ( 1.5f - 0.5f * x * estimate * estimate );
+#endif
+}
+
+// 1 / x for 2^-126 < |x| < 2^126, SSE flushes the result to 0 outside that range
+// Max relative error: 2.1e-7 with SSE, 0.5 ulp without
+inline float Reciprocal( float x ) noexcept
+{
+#ifdef FASTMATH_SIMD
+	// 12 bit estimate + one Newton-Raphson step
+	const float estimate{ _mm_cvtss_f32( _mm_rcp_ss( _mm_set_ss( x ) ) ) };
+	return estimate * ( 2.f - x * estimate );
+#else
+	return 1.f / x;
+#endif
+}
+
+// log2( x ) for normal x > 0
+// Max absolute error: 5.4e-7 for x in [2^-20, 2^20], beyond that rounding of the result itself dominates
+inline float Log2( float x ) noexcept
+{
+	// x = mantissa * 2^exponent with mantissa in [sqrt(0.5), sqrt(2))
+	// Offsetting by the bits of sqrt(0.5) picks the exponent without a branch, those mispredict on shading input
+	const int32_t bits{ std::bit_cast<int32_t>( x ) };
+	const int32_t exponent{ ( bits - 0x3f3504f3 ) >> 23 };
+	const float mantissa{ std::bit_cast<float>( bits - ( exponent << 23 ) ) };
+
+	// log2( 1 + t ) ~= t * q( t ), q fitted to the minimax error over the mantissa range
+	// Evaluated in pairs instead of one long Horner chain, keeps the latency down
+	const float t{ mantissa - 1.f };
+	const float t2{ t * t };
+	const float q{ ( 1.44270073f - 0.72136732f * t ) + t2 * ( 0.48041208f - 0.35923923f * t ) +
+				   ( t2 * t2 ) * ( ( 0.29819853f - 0.27064949f * t ) + t2 * 0.16500475f ) };
+	return static_cast<float>( exponent ) + t * q;
+}
+
+// 2^x, clamped to the normal float range
+// Max relative error: 3.4e-6
+inline float Exp2( float x ) noexcept
+{
+	x = std::min( std::max( x, -126.f ), 127.f );
+
+	// 2^x = 2^whole * 2^fraction with fraction in [-0.5, 0.5]
+	// The biased exponent is positive -> truncating rounds to nearest without a call to nearbyint
+	const int biasedWhole{ static_cast<int>( x + 127.5f ) };
+	const float f{ x - static_cast<float>( biasedWhole - 127 ) };
+
+	// Taylor series of 2^f, paired up like in Log2
+	const float f2{ f * f };
+	const float fraction{ ( 1.f + f * 0.69314718f ) + f2 * ( ( 0.24022651f + f * 0.05550411f ) +
+															 f2 * ( 0.00961813f + f * 0.00133336f ) ) };
+	return fraction * std::bit_cast<float>( static_cast<uint32_t>( biasedWhole ) << 23 );
+}
+
+// base^exponent for base >= 0, pow( 0, 0 ) is 1 like std::pow
+// Max relative error: 3.4e-6 + 3.7e-7 * |exponent|, 1.2e-5 at the full Phong exponent of 25
+inline float Pow( float base, float exponent ) noexcept
+{
+	if ( base < 1.17549435e-38f ) // Denormals and zero
+	{
+		return exponent == 0.f ? 1.f : 0.f;
+	}
+	return Exp2( exponent * Log2( base ) );
+}
+
+// Same error as Rsqrt, the zero vector becomes NaN like Vector3::Normalize
+inline Vector3 Normalized( const Vector3& v ) noexcept
+{
+	return v * Rsqrt( v.x * v.x + v.y * v.y + v.z * v.z );
+}
+
+// sRGB encoded 8 bit value -> linear [0, 1], exact up to float rounding
+float SrgbToLinear( uint8_t srgb ) noexcept;
+
+// Linear value -> sRGB encoded 8 bit value, input is saturated first
+// Max error: 1 step of 255
+uint8_t LinearToSrgb( float linear ) noexcept;
+
+// Dispatchers for code that is selected at runtime
+inline void Normalize( Vector3& v, MathPrecision precision ) noexcept
+{
+	if ( precision == MathPrecision::fast )
+	{
+		v = Normalized( v );
+		return;
+	}
+	v.Normalize();
+}
+
+inline Vector3 Normalized( const Vector3& v, MathPrecision precision ) noexcept
+{
+	return precision == MathPrecision::fast ? Normalized( v ) : v.Normalized();
+}
+
+inline float Pow( float base, float exponent, MathPrecision precision ) noexcept
+{
+	return precision == MathPrecision::fast ? Pow( base, exponent ) : std::pow( base, exponent );
+}
+} // namespace dae::fastMath
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef FILTERMODE_H
+#define FILTERMODE_H
+// Shared between the hardware sampler states and software texture sampling
+// Kept free of DirectX headers so software-only code can use it
+
+enum class FilterMode
+{
+	point,
+	linear,
+	anisotropic, // Software sampling treats this as linear
+	count,
+};
+
+#endif
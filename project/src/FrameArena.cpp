@@ -0,0 +1,102 @@
+#include "FrameArena.h"
+#include <algorithm>
+#include <numeric>
+
+namespace dae
+{
+FrameArena::FrameArena( const JobSystem& jobSystem, size_t chunkSize )
+	: m_pJobSystem( &jobSystem )
+	, m_ChunkSize( std::max( chunkSize, size_t{ 1 } ) )
+	, m_SubArenas( jobSystem.GetThreadCount() )
+{
+}
+
+void FrameArena::Reset()
+{
+	for ( SubArena& subArena : m_SubArenas )
+	{
+		if ( subArena.chunks.size() > 1 )
+		{
+			const size_t frameSize{ std::accumulate( subArena.chunkSizes.begin(), subArena.chunkSizes.end(), size_t{} ) };
+			subArena.chunks.clear();
+			subArena.chunkSizes.clear();
+			AddChunk( subArena, frameSize );
+		}
+
+		if ( !subArena.chunks.empty() )
+		{
+			subArena.pCurrent = subArena.chunks.front().get();
+			subArena.pEnd = subArena.pCurrent + subArena.chunkSizes.front();
+		}
+		subArena.usedSize = 0;
+	}
+}
+
+size_t FrameArena::GetUsedSize() const
+{
+	size_t usedSize{};
+	for ( const SubArena& subArena : m_SubArenas )
+	{
+		usedSize += subArena.usedSize;
+		if ( !subArena.chunks.empty() )
+		{
+			usedSize += subArena.pCurrent - subArena.chunks.back().get();
+		}
+	}
+	return usedSize;
+}
+
+size_t FrameArena::GetChunkAllocationCount() const
+{
+	size_t chunkAllocationCount{};
+	for ( const SubArena& subArena : m_SubArenas )
+	{
+		chunkAllocationCount += subArena.chunkAllocationCount;
+	}
+	return chunkAllocationCount;
+}
+
+void* FrameArena::do_allocate( size_t bytes, size_t alignment )
+{
+	SubArena& subArena{ m_SubArenas[m_pJobSystem->GetThreadIndex()] };
+
+	void* pMemory{ subArena.pCurrent };
+	size_t space{ static_cast<size_t>( subArena.pEnd - subArena.pCurrent ) };
+	if ( !pMemory || !std::align( alignment, bytes, pMemory, space ) )
+	{
+		// Room for the worst case padding, chunks are only aligned like new
+		AddChunk( subArena, bytes + alignment );
+		pMemory = subArena.pCurrent;
+		space = static_cast<size_t>( subArena.pEnd - subArena.pCurrent );
+		std::align( alignment, bytes, pMemory, space );
+	}
+
+	subArena.pCurrent = static_cast<std::byte*>( pMemory ) + bytes;
+	return pMemory;
+}
+
+void FrameArena::do_deallocate( void*, size_t, size_t )
+{
+}
+
+bool FrameArena::do_is_equal( const std::pmr::memory_resource& other ) const noexcept
+{
+	return this == &other;
+}
+
+void FrameArena::AddChunk( SubArena& subArena, size_t minSize )
+{
+	size_t chunkSize{ std::max( m_ChunkSize, minSize ) };
+	if ( !subArena.chunks.empty() )
+	{
+		subArena.usedSize += subArena.pCurrent - subArena.chunks.back().get();
+		chunkSize = std::max( chunkSize, subArena.chunkSizes.back() * 2 ); // Fewer chunks before a frame fits
+	}
+
+	subArena.chunks.push_back( std::make_unique_for_overwrite<std::byte[]>( chunkSize ) );
+	subArena.chunkSizes.push_back( chunkSize );
+	subArena.pCurrent = subArena.chunks.back().get();
+	subArena.pEnd = subArena.pCurrent + chunkSize;
+	++subArena.chunkAllocationCount;
+}
+} // namespace dae
@@ -0,0 +1,56 @@
+#ifndef FRAMEARENA_H
+#define FRAMEARENA_H
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+#include "JobSystem.h"
+
+// Memory for what lives a single frame, handed out by bumping a pointer and all taken back at once by Reset
+// Every job system thread bumps its own sub-arena, so tasks allocate without locks and without sharing cache lines
+// Deallocating does nothing, a container that grows leaves its old buffer behind until the next reset
+
+namespace dae
+{
+class FrameArena final : public std::pmr::memory_resource
+{
+public:
+	explicit FrameArena( const JobSystem& jobSystem, size_t chunkSize = size_t{ 1 } << 16 );
+	~FrameArena() noexcept override = default;
+
+	FrameArena( const FrameArena& ) = delete;
+	FrameArena( FrameArena&& ) noexcept = delete;
+	FrameArena& operator=( const FrameArena& ) = delete;
+	FrameArena& operator=( FrameArena&& ) noexcept = delete;
+
+	// Nothing allocated before may be touched after, and no thread may be allocating meanwhile
+	// A sub-arena that ran into more chunks gets one as large as all of them, so the next frame fits in it
+	void Reset();
+
+	size_t GetUsedSize() const;				// Bytes handed out since the last reset, over every thread
+	size_t GetChunkAllocationCount() const; // Heap allocations since construction, stops growing once frames fit
+
+private:
+	// Sub-arena 0 belongs to every thread outside the pool, of those only the thread that resets may allocate
+	struct alignas( 64 ) SubArena final
+	{
+		std::vector<std::unique_ptr<std::byte[]>> chunks{};
+		std::vector<size_t> chunkSizes{};
+		std::byte* pCurrent{};
+		std::byte* pEnd{};
+		size_t usedSize{}; // Of the chunks before the current one
+		size_t chunkAllocationCount{};
+	};
+
+	const JobSystem* m_pJobSystem{};
+	size_t m_ChunkSize{};
+	std::vector<SubArena> m_SubArenas{};
+
+	void* do_allocate( size_t bytes, size_t alignment ) override;
+	void do_deallocate( void* pMemory, size_t bytes, size_t alignment ) override;
+	bool do_is_equal( const std::pmr::memory_resource& other ) const noexcept override;
+
+	void AddChunk( SubArena& subArena, size_t minSize );
+};
+} // namespace dae
+#endif
@@ -0,0 +1,74 @@
+#ifndef FRAMETIMINGS_H
+#define FRAMETIMINGS_H
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+namespace dae
+{
+using FrameClock = std::chrono::steady_clock;
+
+// Stages of the software pipeline, timed every frame
+// Stages run as tasks on the job system and overlap, so together they can take longer than the frame
+enum class RenderStage
+{
+	clear,
+	project,
+	bin, // Culled triangles into screen tiles, one copy of a mesh at a time
+	raster,
+	shade,
+	blend,	 // Transparent meshes: triangle sort, raster and blend
+	upscale, // Render resolution to window resolution, 0 at full resolution
+	present,
+	count,
+};
+
+struct FrameTimings final
+{
+	std::array<int64_t, static_cast<size_t>( RenderStage::count )> stageNanoseconds{};
+
+	void Reset()
+	{
+		stageNanoseconds.fill( 0 );
+	}
+
+	// Accumulates, a stage can run once per mesh
+	// Tasks of one stage never overlap each other, different stages write different entries
+	void AddSince( RenderStage stage, FrameClock::time_point start )
+	{
+		stageNanoseconds[static_cast<size_t>( stage )] +=
+			std::chrono::duration_cast<std::chrono::nanoseconds>( FrameClock::now() - start ).count();
+	}
+
+	int64_t Get( RenderStage stage ) const
+	{
+		return stageNanoseconds[static_cast<size_t>( stage )];
+	}
+
+	static const char* GetStageName( RenderStage stage )
+	{
+		switch ( stage )
+		{
+		case RenderStage::clear:
+			return "clear";
+		case RenderStage::project:
+			return "project";
+		case RenderStage::bin:
+			return "bin";
+		case RenderStage::raster:
+			return "raster";
+		case RenderStage::shade:
+			return "shade";
+		case RenderStage::blend:
+			return "blend";
+		case RenderStage::upscale:
+			return "upscale";
+		case RenderStage::present:
+			return "present";
+		default:
+			return "unknown";
+		}
+	}
+};
+} // namespace dae
+#endif
@@ -0,0 +1,243 @@
+#include "Headless.h"
+#include <SDL.h>
+#include <SDL_image.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <vector>
+#include "Error.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+#include "Timer.h"
+
+namespace dae
+{
+namespace
+{
+void WriteFrame( SDL_Surface* pFrame, const LaunchOptions& options, int frameIdx )
+{
+	std::stringstream pathStream{};
+	pathStream << options.outputDirectory << "/frame_" << std::setw( 4 ) << std::setfill( '0' ) << frameIdx;
+
+	if ( options.frameOutput == FrameOutput::png )
+	{
+		pathStream << ".png";
+		if ( IMG_SavePNG( pFrame, pathStream.str().c_str() ) != 0 )
+		{
+			throw error::file::CouldNotOpenFile();
+		}
+		return;
+	}
+
+	pathStream << ".raw";
+	std::ofstream file( pathStream.str(), std::ios::binary );
+	if ( !file )
+	{
+		throw error::file::CouldNotOpenFile();
+	}
+
+	// Row by row, the surface pitch may be padded
+	const char* pPixels{ reinterpret_cast<const char*>( pFrame->pixels ) };
+	const std::streamsize rowSize{ pFrame->w * pFrame->format->BytesPerPixel };
+	for ( int row{}; row < pFrame->h; ++row )
+	{
+		file.write( pPixels + row * pFrame->pitch, rowSize );
+	}
+}
+
+// Copies the visible rows of a surface, the pitch may be padded
+void CopyFrame( SDL_Surface* pFrame, std::vector<uint8_t>& pixels )
+{
+	const size_t rowSize{ static_cast<size_t>( pFrame->w ) * pFrame->format->BytesPerPixel };
+	pixels.resize( rowSize * pFrame->h );
+
+	const uint8_t* pPixels{ reinterpret_cast<const uint8_t*>( pFrame->pixels ) };
+	for ( int row{}; row < pFrame->h; ++row )
+	{
+		std::copy_n( pPixels + row * pFrame->pitch, rowSize, pixels.data() + row * rowSize );
+	}
+}
+} // namespace
+
+std::unique_ptr<Scene> CreateHeadlessScene( Renderer& renderer, const LaunchOptions& options )
+{
+	std::unique_ptr<Scene> pScene{};
+	const bool failed{ error::utils::HandleThrowingFunction( [&]() {
+		pScene = Scene::Create( options.sceneName, options.vertexFormat );
+		renderer.InitScene( pScene.get() );
+		renderer.FinishLoading( pScene.get() ); // Every frame has to come out the same
+	} ) };
+	if ( failed )
+	{
+		return nullptr;
+	}
+
+	pScene->GetCamera().SetInputEnabled( false );
+	pScene->SetFilterMode( options.filterMode );
+	renderer.SetLightingMode( options.lightingMode );
+	renderer.SetMathPrecision( options.mathPrecision );
+	renderer.SetMultisampling( options.useMultisampling );
+	renderer.SetIncrementalRendering( options.useIncrementalRendering );
+	renderer.SetVariableRateShading( options.useVariableRateShading );
+	if ( options.frameBudgetMs > 0.f )
+	{
+		renderer.SetFrameBudget( options.frameBudgetMs );
+		renderer.SetDynamicResolution( true );
+	}
+
+	return pScene;
+}
+
+int RunHeadless( const LaunchOptions& options )
+{
+	// No video subsystem -> no display needed
+	SDL_Init( SDL_INIT_TIMER );
+	profiler::SetThreadName( "Main" );
+
+	JobSystem jobSystem{ options.threadCount };
+	Renderer renderer{ options.width, options.height, jobSystem };
+
+	std::unique_ptr<Scene> pScene{ CreateHeadlessScene( renderer, options ) };
+	if ( !pScene )
+	{
+		SDL_Quit();
+		return 1;
+	}
+
+	// Fixed step so the same options always produce the same frames
+	Timer timer{};
+	timer.SetFixedElapsed( options.timeStep );
+	timer.Start();
+
+	const auto startTime{ std::chrono::steady_clock::now() };
+	const bool failedRender{ error::utils::HandleThrowingFunction( [&]() {
+		// Pipelined: every frame renders the previous update while the next one runs, same frames one update ahead
+		if ( options.usePipelining )
+		{
+			pScene->Update( &timer );
+		}
+
+		for ( int frameIdx{}; frameIdx < options.frameCount; ++frameIdx )
+		{
+			if ( options.usePipelining )
+			{
+				renderer.Render( pScene.get(), [&]() { pScene->Update( &timer ); } );
+			}
+			else
+			{
+				pScene->Update( &timer );
+				renderer.Render( pScene.get() );
+			}
+			timer.Update();
+
+			if ( options.frameOutput != FrameOutput::none )
+			{
+				WriteFrame( renderer.GetFrameSurface(), options, frameIdx );
+			}
+		}
+	} ) };
+	const auto endTime{ std::chrono::steady_clock::now() };
+	timer.Stop();
+
+	if ( !failedRender )
+	{
+		const double totalMs{ std::chrono::duration<double, std::milli>( endTime - startTime ).count() };
+		std::cout << "Rendered " << options.frameCount << " frames in " << totalMs << " ms ("
+				  << totalMs / options.frameCount << " ms/frame)\n";
+	}
+
+	if ( !options.tracePath.empty() )
+	{
+		profiler::DumpChromeTrace( options.tracePath );
+	}
+
+	pScene.reset();
+	SDL_Quit();
+
+	return failedRender ? 1 : 0;
+}
+
+int RunPrecisionComparison( const LaunchOptions& options )
+{
+	// Fast math promises errors far below one 8 bit step, rounding may still tip a channel over
+	constexpr int maxAllowedDifference{ 2 };
+	constexpr double minAllowedPsnr{ 50.0 };
+
+	SDL_Init( SDL_INIT_TIMER );
+	profiler::SetThreadName( "Main" );
+
+	JobSystem jobSystem{ options.threadCount };
+	Renderer renderer{ options.width, options.height, jobSystem };
+
+	std::unique_ptr<Scene> pScene{ CreateHeadlessScene( renderer, options ) };
+	if ( !pScene )
+	{
+		SDL_Quit();
+		return 1;
+	}
+
+	Timer timer{};
+	timer.SetFixedElapsed( options.timeStep );
+	timer.Start();
+
+	int maxDifference{};
+	uint64_t differentChannelCount{};
+	double squaredErrorSum{};
+	uint64_t channelCount{};
+
+	const bool failedRender{ error::utils::HandleThrowingFunction( [&]() {
+		std::vector<uint8_t> exactPixels{};
+		std::vector<uint8_t> fastPixels{};
+		for ( int frameIdx{}; frameIdx < options.frameCount; ++frameIdx )
+		{
+			pScene->Update( &timer );
+
+			renderer.SetMathPrecision( MathPrecision::exact );
+			renderer.Render( pScene.get() );
+			CopyFrame( renderer.GetFrameSurface(), exactPixels );
+
+			renderer.SetMathPrecision( MathPrecision::fast );
+			renderer.Render( pScene.get() );
+			CopyFrame( renderer.GetFrameSurface(), fastPixels );
+
+			timer.Update();
+
+			// ARGB8888 -> every byte is a channel, alpha is constant in both
+			for ( size_t channelIdx{}; channelIdx < exactPixels.size(); ++channelIdx )
+			{
+				const int difference{ std::abs( exactPixels[channelIdx] - fastPixels[channelIdx] ) };
+				maxDifference = std::max( maxDifference, difference );
+				differentChannelCount += difference != 0;
+				squaredErrorSum += static_cast<double>( difference ) * difference;
+			}
+			channelCount += exactPixels.size();
+		}
+	} ) };
+	timer.Stop();
+	pScene.reset();
+	SDL_Quit();
+
+	if ( failedRender )
+	{
+		return 1;
+	}
+
+	const double meanSquaredError{ squaredErrorSum / channelCount };
+	const double psnr{ meanSquaredError == 0.0 ? INFINITY : 10.0 * std::log10( 255.0 * 255.0 / meanSquaredError ) };
+	const bool isWithinTolerance{ maxDifference <= maxAllowedDifference && psnr >= minAllowedPsnr };
+
+	std::cout << "**PRECISION COMPARISON** (" << options.frameCount << " frames)\n";
+	std::cout << ">> MAX CHANNEL DIFFERENCE = " << maxDifference << "\n";
+	std::cout << ">> DIFFERENT CHANNELS = " << differentChannelCount << " / " << channelCount << "\n";
+	std::cout << ">> PSNR = " << psnr << " dB\n";
+	std::cout << ( isWithinTolerance ? "Fast math is within tolerance\n" : "Fast math is NOT within tolerance\n" );
+
+	return isWithinTolerance ? 0 : 1;
+}
+} // namespace dae
@@ -0,0 +1,21 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+#include <memory>
+#include "CommandLine.h"
+#include "Renderer.h"
+
+namespace dae
+{
+// Drives a scene through the software renderer without a window, display or GPU
+// Returns the process exit code
+int RunHeadless( const LaunchOptions& options );
+
+// Renders every frame twice, once per MathPrecision, and compares the fast image against the exact one
+// Returns the process exit code, nonzero when the difference is over the documented tolerance
+int RunPrecisionComparison( const LaunchOptions& options );
+
+// Creates and initializes the scene from the options for a headless renderer
+// Returns nullptr after reporting the error if that fails
+std::unique_ptr<Scene> CreateHeadlessScene( Renderer& renderer, const LaunchOptions& options );
+} // namespace dae
+#endif
@@ -0,0 +1,402 @@
+#include "JobSystem.h"
+#include <algorithm>
+#include <utility>
+#include "Profiler.h"
+
+namespace dae
+{
+namespace
+{
+// Which queue the calling thread owns, only meaningful when t_pOwner is the asking job system
+thread_local const JobSystem* t_pOwner{ nullptr };
+thread_local size_t t_QueueIdx{};
+} // namespace
+
+JobSystem::JobSystem( int threadCount )
+{
+	if ( threadCount <= 0 )
+	{
+		threadCount = std::max( static_cast<int>( std::thread::hardware_concurrency() ), 1 );
+	}
+
+	m_Queues.reserve( threadCount );
+	for ( int queueIdx{}; queueIdx < threadCount; ++queueIdx )
+	{
+		m_Queues.push_back( std::make_unique<WorkerQueue>() );
+	}
+
+	// The thread waiting on the work counts as one, so one worker less
+	m_Workers.reserve( threadCount - 1 );
+	for ( size_t queueIdx{ 1 }; queueIdx < m_Queues.size(); ++queueIdx )
+	{
+		m_Workers.emplace_back( [this, queueIdx]() { WorkerLoop( queueIdx ); } );
+	}
+}
+
+JobSystem::~JobSystem() noexcept
+{
+	{
+		const std::lock_guard lock{ m_SleepMutex };
+		m_IsStopping = true;
+	}
+	m_WakeCondition.notify_all();
+
+	for ( std::thread& worker : m_Workers )
+	{
+		worker.join();
+	}
+}
+
+int JobSystem::GetThreadCount() const
+{
+	return static_cast<int>( m_Queues.size() );
+}
+
+size_t JobSystem::GetThreadIndex() const
+{
+	return t_pOwner == this ? t_QueueIdx : 0;
+}
+
+void JobSystem::Push( Job job )
+{
+	WorkerQueue& queue{ *m_Queues[GetThreadIndex()] };
+	{
+		const std::lock_guard lock{ queue.mutex };
+		queue.jobs.push_back( std::move( job ) );
+	}
+	m_QueuedJobCount.fetch_add( 1, std::memory_order_release );
+	WakeWorker();
+}
+
+bool JobSystem::RunPendingJob()
+{
+	Job job{};
+	if ( !PopJob( GetThreadIndex(), job ) )
+	{
+		return false;
+	}
+
+	job();
+	return true;
+}
+
+void JobSystem::PushBackground( Job job )
+{
+	{
+		const std::lock_guard lock{ m_BackgroundQueue.mutex };
+		m_BackgroundQueue.jobs.push_back( std::move( job ) );
+	}
+	m_QueuedBackgroundJobCount.fetch_add( 1, std::memory_order_release );
+	WakeWorker();
+}
+
+bool JobSystem::RunBackgroundJob()
+{
+	Job job{};
+	if ( !PopBackgroundJob( job ) )
+	{
+		return false;
+	}
+
+	job();
+	return true;
+}
+
+void JobSystem::RunParallelFor( size_t count, size_t grainSize, const void* pBody, RangeBody body )
+{
+	grainSize = std::max( grainSize, size_t{ 1 } );
+	const size_t chunkCount{ ( count + grainSize - 1 ) / grainSize };
+	if ( chunkCount <= 1 || m_Workers.empty() )
+	{
+		if ( count )
+		{
+			body( pBody, 0, count );
+		}
+		return;
+	}
+
+	std::atomic<size_t> remainingChunkCount{ chunkCount };
+	std::mutex exceptionMutex{};
+	std::exception_ptr pException{};
+	auto runChunk{ [&]( size_t chunkIdx ) {
+		const size_t begin{ chunkIdx * grainSize };
+		try
+		{
+			body( pBody, begin, std::min( begin + grainSize, count ) );
+		}
+		catch ( ... )
+		{
+			const std::lock_guard lock{ exceptionMutex };
+			if ( !pException )
+			{
+				pException = std::current_exception();
+			}
+		}
+		remainingChunkCount.fetch_sub( 1, std::memory_order_release );
+	} };
+
+	for ( size_t chunkIdx{ 1 }; chunkIdx < chunkCount; ++chunkIdx )
+	{
+		Push( [&runChunk, chunkIdx]() { runChunk( chunkIdx ); } );
+	}
+	runChunk( 0 );
+
+	// Chunks still queued are most likely on our own deque, the rest is helping out elsewhere
+	while ( remainingChunkCount.load( std::memory_order_acquire ) )
+	{
+		if ( !RunPendingJob() )
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	if ( pException )
+	{
+		std::rethrow_exception( pException );
+	}
+}
+
+void JobSystem::WorkerLoop( size_t queueIdx )
+{
+	t_pOwner = this;
+	t_QueueIdx = queueIdx;
+	profiler::SetThreadName( "Worker" );
+
+	Job job{};
+	while ( true )
+	{
+		// A background job only starts once the frame's work is all taken
+		if ( PopJob( queueIdx, job ) || PopBackgroundJob( job ) )
+		{
+			job();
+			job = nullptr;
+			continue;
+		}
+
+		std::unique_lock lock{ m_SleepMutex };
+		m_WakeCondition.wait( lock, [this]() {
+			return m_IsStopping || m_QueuedJobCount.load( std::memory_order_acquire ) ||
+				   m_QueuedBackgroundJobCount.load( std::memory_order_acquire );
+		} );
+		if ( m_IsStopping && !m_QueuedJobCount.load( std::memory_order_acquire ) )
+		{
+			return;
+		}
+	}
+}
+
+bool JobSystem::PopJob( size_t queueIdx, Job& job )
+{
+	if ( !m_QueuedJobCount.load( std::memory_order_acquire ) )
+	{
+		return false;
+	}
+
+	// Newest first from our own deque, its data is the most likely to still be in cache
+	{
+		WorkerQueue& queue{ *m_Queues[queueIdx] };
+		const std::lock_guard lock{ queue.mutex };
+		if ( !queue.jobs.empty() )
+		{
+			job = std::move( queue.jobs.back() );
+			queue.jobs.pop_back();
+			m_QueuedJobCount.fetch_sub( 1, std::memory_order_relaxed );
+			return true;
+		}
+	}
+
+	// Oldest first from the others, those tend to be the biggest pieces left
+	for ( size_t offset{ 1 }; offset < m_Queues.size(); ++offset )
+	{
+		WorkerQueue& queue{ *m_Queues[( queueIdx + offset ) % m_Queues.size()] };
+		const std::lock_guard lock{ queue.mutex };
+		if ( !queue.jobs.empty() )
+		{
+			job = std::move( queue.jobs.front() );
+			queue.jobs.pop_front();
+			m_QueuedJobCount.fetch_sub( 1, std::memory_order_relaxed );
+			return true;
+		}
+	}
+	return false;
+}
+
+bool JobSystem::PopBackgroundJob( Job& job )
+{
+	if ( !m_QueuedBackgroundJobCount.load( std::memory_order_acquire ) )
+	{
+		return false;
+	}
+
+	const std::lock_guard lock{ m_BackgroundQueue.mutex };
+	if ( m_BackgroundQueue.jobs.empty() )
+	{
+		return false;
+	}
+
+	job = std::move( m_BackgroundQueue.jobs.front() );
+	m_BackgroundQueue.jobs.pop_front();
+	m_QueuedBackgroundJobCount.fetch_sub( 1, std::memory_order_relaxed );
+	return true;
+}
+
+void JobSystem::WakeWorker()
+{
+	// Taking the sleep mutex orders this after a worker's last check, so the wake up cannot get lost
+	{
+		const std::lock_guard lock{ m_SleepMutex };
+	}
+	m_WakeCondition.notify_one();
+}
+
+TaskGraph::TaskGraph( std::pmr::memory_resource* pResource )
+	: m_pResource( pResource )
+	, m_Tasks( pResource )
+{
+}
+
+TaskGraph::~TaskGraph() noexcept
+{
+	Clear();
+}
+
+TaskGraph::TaskId TaskGraph::AddTask(
+	const char* name, void* pWork, RunWork runWork, DestroyWork destroyWork, bool isMainThreadOnly )
+{
+	try
+	{
+		m_Tasks.push_back(
+			{ name, pWork, runWork, destroyWork, isMainThreadOnly, 0, std::pmr::vector<TaskId>{ m_pResource } } );
+	}
+	catch ( ... )
+	{
+		destroyWork( pWork, m_pResource );
+		throw;
+	}
+	return static_cast<TaskId>( m_Tasks.size() - 1 );
+}
+
+void TaskGraph::AddDependency( TaskId task, TaskId dependency )
+{
+	m_Tasks[dependency].dependents.push_back( task );
+	++m_Tasks[task].dependencyCount;
+}
+
+void TaskGraph::Clear()
+{
+	for ( Task& task : m_Tasks )
+	{
+		task.destroyWork( task.pWork, m_pResource );
+	}
+
+	// Not just cleared, an arena reset would pull the capacity out from under the next frame
+	m_Tasks = std::pmr::vector<Task>{ m_pResource };
+}
+
+size_t TaskGraph::GetTaskCount() const
+{
+	return m_Tasks.size();
+}
+
+void TaskGraph::Run( JobSystem& jobSystem )
+{
+	const size_t taskCount{ m_Tasks.size() };
+	if ( !taskCount )
+	{
+		return;
+	}
+
+	if ( m_WaitCountCapacity < taskCount )
+	{
+		m_WaitCounts = std::make_unique<std::atomic<uint32_t>[]>( taskCount );
+		m_WaitCountCapacity = taskCount;
+	}
+	for ( size_t taskIdx{}; taskIdx < taskCount; ++taskIdx )
+	{
+		m_WaitCounts[taskIdx].store( m_Tasks[taskIdx].dependencyCount, std::memory_order_relaxed );
+	}
+	m_UnfinishedTaskCount.store( static_cast<uint32_t>( taskCount ), std::memory_order_release );
+	m_pException = nullptr;
+	m_pJobSystem = &jobSystem;
+
+	for ( size_t taskIdx{}; taskIdx < taskCount; ++taskIdx )
+	{
+		if ( !m_Tasks[taskIdx].dependencyCount )
+		{
+			Schedule( static_cast<TaskId>( taskIdx ) );
+		}
+	}
+
+	while ( m_UnfinishedTaskCount.load( std::memory_order_acquire ) )
+	{
+		TaskId mainThreadTask{};
+		bool hasMainThreadTask{ false };
+		{
+			const std::lock_guard lock{ m_MainThreadMutex };
+			if ( !m_MainThreadTasks.empty() )
+			{
+				mainThreadTask = m_MainThreadTasks.back();
+				m_MainThreadTasks.pop_back();
+				hasMainThreadTask = true;
+			}
+		}
+
+		if ( hasMainThreadTask )
+		{
+			Execute( mainThreadTask );
+		}
+		else if ( !jobSystem.RunPendingJob() )
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	if ( m_pException )
+	{
+		std::rethrow_exception( std::exchange( m_pException, nullptr ) );
+	}
+}
+
+void TaskGraph::Schedule( TaskId task )
+{
+	if ( m_Tasks[task].isMainThreadOnly )
+	{
+		const std::lock_guard lock{ m_MainThreadMutex };
+		m_MainThreadTasks.push_back( task );
+		return;
+	}
+
+	// Two words, small enough for std::function to keep inline
+	m_pJobSystem->Push( [this, task]() { Execute( task ); } );
+}
+
+void TaskGraph::Execute( TaskId task )
+{
+	try
+	{
+#ifdef ENABLE_PROFILING
+		const profiler::ScopedZone zone{ m_Tasks[task].name };
+#endif
+		m_Tasks[task].runWork( m_Tasks[task].pWork );
+	}
+	catch ( ... )
+	{
+		const std::lock_guard lock{ m_ExceptionMutex };
+		if ( !m_pException )
+		{
+			m_pException = std::current_exception();
+		}
+	}
+
+	for ( const TaskId dependent : m_Tasks[task].dependents )
+	{
+		if ( m_WaitCounts[dependent].fetch_sub( 1, std::memory_order_acq_rel ) == 1 )
+		{
+			Schedule( dependent );
+		}
+	}
+
+	// Last touch of the graph, Run may return right after
+	m_UnfinishedTaskCount.fetch_sub( 1, std::memory_order_acq_rel );
+}
+} // namespace dae
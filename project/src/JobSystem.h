@@ -0,0 +1,178 @@
+#ifndef JOBSYSTEM_H
+#define JOBSYSTEM_H
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Persistent worker threads that share the frame's work by stealing it from each other
+// Every worker owns a deque: it pushes and pops its own jobs at the back, idle workers steal from the front
+// A thread waiting on work runs queued jobs instead of blocking, so ParallelFor can be nested inside jobs
+// Background jobs sit in a queue of their own that only idle workers take from, waiting never runs one
+
+namespace dae
+{
+class JobSystem final
+{
+public:
+	using Job = std::function<void()>;
+
+	// threadCount includes the thread that waits on the work, 0 -> one per hardware thread
+	explicit JobSystem( int threadCount = 0 );
+	~JobSystem() noexcept;
+
+	JobSystem( const JobSystem& ) = delete;
+	JobSystem( JobSystem&& ) noexcept = delete;
+	JobSystem& operator=( const JobSystem& ) = delete;
+	JobSystem& operator=( JobSystem&& ) noexcept = delete;
+
+	int GetThreadCount() const;
+	size_t GetThreadIndex() const; // 0 for every thread outside the pool, workers count up from 1
+
+	// Onto the deque of the calling worker, threads outside the pool share one
+	// Jobs must not throw, ParallelFor and TaskGraph catch for theirs
+	void Push( Job job );
+
+	// Runs one queued job, false when there was nothing to run
+	bool RunPendingJob();
+
+	// Work that may take longer than a frame, like loading assets, run oldest first
+	// With a single thread nothing takes them but RunBackgroundJob, the ones still queued at destruction never run
+	void PushBackground( Job job );
+	bool RunBackgroundJob(); // On the calling thread, false when there was nothing to run
+
+	// Calls body( begin, end ) for chunks of at most grainSize covering [0, count), returns once every chunk ran
+	// The calling thread takes part, the first exception thrown by a chunk is rethrown here
+	// body is only referenced, wrapping it in a std::function would allocate for every call
+	template <typename Body>
+	void ParallelFor( size_t count, size_t grainSize, const Body& body )
+	{
+		RunParallelFor( count, grainSize, &body, []( const void* pBody, size_t begin, size_t end ) {
+			( *static_cast<const Body*>( pBody ) )( begin, end );
+		} );
+	}
+
+private:
+	using RangeBody = void ( * )( const void* pBody, size_t begin, size_t end );
+
+	// The pool keeps the deque's blocks once they are popped empty, so queueing stops allocating after a few frames
+	struct WorkerQueue final
+	{
+		std::mutex mutex{};
+		std::pmr::unsynchronized_pool_resource blockPool{}; // Guarded by mutex like the jobs
+		std::pmr::deque<Job> jobs{ &blockPool };
+	};
+
+	// Index 0 is shared by every thread outside the pool, workers own the rest
+	std::vector<std::unique_ptr<WorkerQueue>> m_Queues{};
+	std::vector<std::thread> m_Workers{};
+
+	WorkerQueue m_BackgroundQueue{};
+
+	std::atomic<uint32_t> m_QueuedJobCount{};
+	std::atomic<uint32_t> m_QueuedBackgroundJobCount{};
+	std::atomic<bool> m_IsStopping{ false };
+	std::mutex m_SleepMutex{};
+	std::condition_variable m_WakeCondition{};
+
+	void RunParallelFor( size_t count, size_t grainSize, const void* pBody, RangeBody body );
+	void WorkerLoop( size_t queueIdx );
+	bool PopJob( size_t queueIdx, Job& job ); // Own queue from the back, then the others from the front
+	bool PopBackgroundJob( Job& job );
+	void WakeWorker();
+};
+
+// Tasks and the tasks they wait for, rebuilt and run once per frame
+// Tasks marked main thread only run on the thread calling Run, everything else goes to the workers
+// Tasks, their work and their dependents all live in the memory resource, a frame arena makes building the graph free
+class TaskGraph final
+{
+public:
+	using TaskId = uint32_t;
+
+	explicit TaskGraph( std::pmr::memory_resource* pResource = std::pmr::get_default_resource() );
+	~TaskGraph() noexcept;
+
+	TaskGraph( const TaskGraph& ) = delete;
+	TaskGraph( TaskGraph&& ) noexcept = delete;
+	TaskGraph& operator=( const TaskGraph& ) = delete;
+	TaskGraph& operator=( TaskGraph&& ) noexcept = delete;
+
+	// Name is a literal, work is moved into the memory resource
+	template <typename Work>
+	TaskId Add( const char* name, Work&& work, bool isMainThreadOnly = false )
+	{
+		using Closure = std::decay_t<Work>;
+		void* pWork{ m_pResource->allocate( sizeof( Closure ), alignof( Closure ) ) };
+		try
+		{
+			new ( pWork ) Closure( std::forward<Work>( work ) );
+		}
+		catch ( ... )
+		{
+			m_pResource->deallocate( pWork, sizeof( Closure ), alignof( Closure ) );
+			throw;
+		}
+
+		return AddTask( name,
+						pWork,
+						[]( void* pClosure ) { ( *static_cast<Closure*>( pClosure ) )(); },
+						[]( void* pClosure, std::pmr::memory_resource* pResource ) {
+							static_cast<Closure*>( pClosure )->~Closure();
+							pResource->deallocate( pClosure, sizeof( Closure ), alignof( Closure ) );
+						},
+						isMainThreadOnly );
+	}
+	void AddDependency( TaskId task, TaskId dependency ); // task starts after dependency finished
+	void Clear(); // Gives everything back to the memory resource, has to come before resetting an arena behind it
+	size_t GetTaskCount() const;
+
+	// Returns once every task ran, the first exception thrown by a task is rethrown here
+	// Tasks still run after a failure so nothing is left waiting on them
+	void Run( JobSystem& jobSystem );
+
+private:
+	using RunWork = void ( * )( void* pWork );
+	using DestroyWork = void ( * )( void* pWork, std::pmr::memory_resource* pResource );
+
+	struct Task final
+	{
+		const char* name{};
+		void* pWork{};
+		RunWork runWork{};
+		DestroyWork destroyWork{};
+		bool isMainThreadOnly{};
+		uint32_t dependencyCount{};
+		std::pmr::vector<TaskId> dependents{};
+	};
+
+	std::pmr::memory_resource* m_pResource{};
+	std::pmr::vector<Task> m_Tasks;
+	JobSystem* m_pJobSystem{}; // During Run
+	std::unique_ptr<std::atomic<uint32_t>[]> m_WaitCounts{}; // Unfinished dependencies per task during Run
+	size_t m_WaitCountCapacity{};
+	std::atomic<uint32_t> m_UnfinishedTaskCount{};
+
+	std::mutex m_MainThreadMutex{};
+	std::vector<TaskId> m_MainThreadTasks{}; // Ready to run on the thread in Run
+
+	std::mutex m_ExceptionMutex{};
+	std::exception_ptr m_pException{};
+
+	TaskId AddTask(
+		const char* name, void* pWork, RunWork runWork, DestroyWork destroyWork, bool isMainThreadOnly ); // Owns pWork
+	void Schedule( TaskId task );
+	void Execute( TaskId task );
+};
+} // namespace dae
+#endif
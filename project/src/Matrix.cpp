@@ -6,8 +6,34 @@
 #include <limits>
 #include <cassert>
 
+// SSE is part of the x64 baseline, other targets fall back to the scalar paths
+#if defined( __SSE__ ) || defined( _M_X64 ) || defined( _M_AMD64 )
+#	define MATRIX_SIMD
+#	include <xmmintrin.h>
+#endif
+
 namespace dae
 {
+#ifdef MATRIX_SIMD
+namespace
+{
+// Row vector * matrix -> x * row0 + y * row1 + z * row2 + w * row3
+__m128 TransformRow( __m128 row, const Vector4* pRows )
+{
+	const __m128 x{ _mm_shuffle_ps( row, row, _MM_SHUFFLE( 0, 0, 0, 0 ) ) };
+	const __m128 y{ _mm_shuffle_ps( row, row, _MM_SHUFFLE( 1, 1, 1, 1 ) ) };
+	const __m128 z{ _mm_shuffle_ps( row, row, _MM_SHUFFLE( 2, 2, 2, 2 ) ) };
+	const __m128 w{ _mm_shuffle_ps( row, row, _MM_SHUFFLE( 3, 3, 3, 3 ) ) };
+
+	const __m128 xy{ _mm_add_ps( _mm_mul_ps( x, _mm_load_ps( &pRows[0].x ) ),
+								 _mm_mul_ps( y, _mm_load_ps( &pRows[1].x ) ) ) };
+	const __m128 zw{ _mm_add_ps( _mm_mul_ps( z, _mm_load_ps( &pRows[2].x ) ),
+								 _mm_mul_ps( w, _mm_load_ps( &pRows[3].x ) ) ) };
+	return _mm_add_ps( xy, zw );
+}
+} // namespace
+#endif
+
 Matrix::Matrix( const Vector3& xAxis, const Vector3& yAxis, const Vector3& zAxis, const Vector3& t )
 	: Matrix( { xAxis, 0 }, { yAxis, 0 }, { zAxis, 0 }, { t, 1 } )
 {
@@ -21,29 +47,6 @@ Matrix::Matrix( const Vector4& xAxis, const Vector4& yAxis, const Vector4& zAxis
 	data[3] = t;
 }
 
-Matrix::Matrix( const Matrix& m )
-{
-	data[0] = m[0];
-	data[1] = m[1];
-	data[2] = m[2];
-	data[3] = m[3];
-}
-
-Matrix& Matrix::operator=( const Matrix& m )
-{
-	if ( &m == this )
-	{
-		return *this;
-	}
-
-	data[0] = m[0];
-	data[1] = m[1];
-	data[2] = m[2];
-	data[3] = m[3];
-
-	return *this;
-}
-
 void Matrix::Print()
 {
 	std::cout << "[" << data[0].x << "," << data[0].y << "," << data[0].z << "," << data[0].w << "]\n"
@@ -59,9 +62,15 @@ Vector3 Matrix::TransformVector( const Vector3& v ) const
 
 Vector3 Matrix::TransformVector( float x, float y, float z ) const
 {
+#ifdef MATRIX_SIMD
+	alignas( 16 ) float result[4];
+	_mm_store_ps( result, TransformRow( _mm_setr_ps( x, y, z, 0.f ), data ) );
+	return Vector3{ result[0], result[1], result[2] };
+#else
 	return Vector3{ data[0].x * x + data[1].x * y + data[2].x * z,
 					data[0].y * x + data[1].y * y + data[2].y * z,
 					data[0].z * x + data[1].z * y + data[2].z * z };
+#endif
 }
 
 Vector3 Matrix::TransformPoint( const Vector3& p ) const
@@ -71,24 +80,41 @@ Vector3 Matrix::TransformPoint( const Vector3& p ) const
 
 Vector3 Matrix::TransformPoint( float x, float y, float z ) const
 {
+#ifdef MATRIX_SIMD
+	alignas( 16 ) float result[4];
+	_mm_store_ps( result, TransformRow( _mm_setr_ps( x, y, z, 1.f ), data ) );
+	return Vector3{ result[0], result[1], result[2] };
+#else
 	return Vector3{
 		data[0].x * x + data[1].x * y + data[2].x * z + data[3].x,
 		data[0].y * x + data[1].y * y + data[2].y * z + data[3].y,
 		data[0].z * x + data[1].z * y + data[2].z * z + data[3].z,
 	};
+#endif
 }
 
 Vector4 Matrix::TransformPoint( const Vector4& p ) const
 {
+#ifdef MATRIX_SIMD
+	// Built from the members rather than loaded -> avoids a store forwarding stall on freshly written vectors
+	Vector4 result;
+	_mm_storeu_ps( &result.x, TransformRow( _mm_setr_ps( p.x, p.y, p.z, p.w ), data ) );
+	return result;
+#else
 	return TransformPoint( p.x, p.y, p.z, p.w );
+#endif
 }
 
 Vector4 Matrix::TransformPoint( float x, float y, float z, float w ) const
 {
+#ifdef MATRIX_SIMD
+	return TransformPoint( Vector4{ x, y, z, w } );
+#else
 	return Vector4{ data[0].x * x + data[1].x * y + data[2].x * z + data[3].x,
 					data[0].y * x + data[1].y * y + data[2].y * z + data[3].y,
 					data[0].z * x + data[1].z * y + data[2].z * z + data[3].z,
 					data[0].w * x + data[1].w * y + data[2].w * z + data[3].w };
+#endif
 }
 
 const Matrix& Matrix::Transpose()
@@ -112,6 +138,12 @@ const Matrix& Matrix::Transpose()
 
 const Matrix& Matrix::Inverse()
 {
+	// World, view and look-at matrices never project, no need for the general path
+	if ( IsAffine() )
+	{
+		return InverseAffine();
+	}
+
 	// Create augmented matrix [A|I] where A is this matrix and I is identity.
 	float augmented[4][8];
 
@@ -193,6 +225,92 @@ const Matrix& Matrix::Inverse()
 	return *this;
 }
 
+const Matrix& Matrix::InverseAffine()
+{
+	assert( IsAffine() && "Matrix has a projective part, use Inverse()" );
+
+	// Written out on the raw rows, the Vector3 helpers aren't inlined across translation units
+	const Vector4& x{ data[0] };
+	const Vector4& y{ data[1] };
+	const Vector4& z{ data[2] };
+	const Vector4& t{ data[3] };
+
+	// Inverse of the 3x3 part: its columns are the cross products of the rows, divided by the determinant
+	const float yzCross[3]{ y.y * z.z - y.z * z.y, y.z * z.x - y.x * z.z, y.x * z.y - y.y * z.x };
+	const float zxCross[3]{ z.y * x.z - z.z * x.y, z.z * x.x - z.x * x.z, z.x * x.y - z.y * x.x };
+	const float xyCross[3]{ x.y * y.z - x.z * y.y, x.z * y.x - x.x * y.z, x.x * y.y - x.y * y.x };
+	const float determinant{ x.x * yzCross[0] + x.y * yzCross[1] + x.z * yzCross[2] };
+
+	// Singular like the general path, relative to the row lengths so a small uniform scale still inverts
+	// |determinant| <= |x| * |y| * |z|, compared squared to skip the square roots
+	const float rowLengthProduct{ ( x.x * x.x + x.y * x.y + x.z * x.z ) * ( y.x * y.x + y.y * y.y + y.z * y.z ) *
+								  ( z.x * z.x + z.y * z.y + z.z * z.z ) };
+	constexpr float epsilon{ std::numeric_limits<float>::epsilon() };
+	if ( determinant * determinant <= epsilon * epsilon * rowLengthProduct )
+	{
+		*this = CreateIdentity();
+		return *this;
+	}
+
+	const float inverseDeterminant{ 1.f / determinant };
+	float inverse[4][3]{};
+	for ( int r{ 0 }; r < 3; ++r )
+	{
+		inverse[r][0] = yzCross[r] * inverseDeterminant;
+		inverse[r][1] = zxCross[r] * inverseDeterminant;
+		inverse[r][2] = xyCross[r] * inverseDeterminant;
+	}
+
+	// -t * inverse(3x3)
+	for ( int c{ 0 }; c < 3; ++c )
+	{
+		inverse[3][c] = -( t.x * inverse[0][c] + t.y * inverse[1][c] + t.z * inverse[2][c] );
+	}
+
+	for ( int r{ 0 }; r < 4; ++r )
+	{
+		data[r].x = inverse[r][0];
+		data[r].y = inverse[r][1];
+		data[r].z = inverse[r][2];
+		data[r].w = ( r == 3 ) ? 1.f : 0.f;
+	}
+	return *this;
+}
+
+const Matrix& Matrix::InverseRigid()
+{
+	assert( IsAffine() && "Matrix has a projective part, use Inverse()" );
+
+	const Vector4 x{ data[0] };
+	const Vector4 y{ data[1] };
+	const Vector4 z{ data[2] };
+	const Vector4 t{ data[3] };
+
+	// Orthonormal rotation -> the inverse is the transpose
+	const float inverse[4][3]{
+		{ x.x, y.x, z.x },
+		{ x.y, y.y, z.y },
+		{ x.z, y.z, z.z },
+		{ -( t.x * x.x + t.y * x.y + t.z * x.z ),
+		  -( t.x * y.x + t.y * y.y + t.z * y.z ),
+		  -( t.x * z.x + t.y * z.y + t.z * z.z ) },
+	};
+
+	for ( int r{ 0 }; r < 4; ++r )
+	{
+		data[r].x = inverse[r][0];
+		data[r].y = inverse[r][1];
+		data[r].z = inverse[r][2];
+		data[r].w = ( r == 3 ) ? 1.f : 0.f;
+	}
+	return *this;
+}
+
+bool Matrix::IsAffine() const
+{
+	return data[0].w == 0.f && data[1].w == 0.f && data[2].w == 0.f && data[3].w == 1.f;
+}
+
 Matrix Matrix::Transpose( const Matrix& m )
 {
 	Matrix out{ m };
@@ -209,11 +327,27 @@ Matrix Matrix::Inverse( const Matrix& m )
 	return out;
 }
 
+Matrix Matrix::InverseAffine( const Matrix& m )
+{
+	Matrix out{ m };
+	out.InverseAffine();
+
+	return out;
+}
+
+Matrix Matrix::InverseRigid( const Matrix& m )
+{
+	Matrix out{ m };
+	out.InverseRigid();
+
+	return out;
+}
+
 Matrix Matrix::CreateLookAtLH( const Vector3& origin, const Vector3& forward, const Vector3& worldUp )
 {
 	const Vector3 right{ Vector3::Cross( worldUp, forward ).Normalized() };
 	const Vector3 up{ Vector3::Cross( forward, right ).Normalized() };
-	return Matrix{ right, up, forward, origin }.Inverse();
+	return Matrix{ right, up, forward, origin }.InverseRigid();
 }
 
 Matrix Matrix::CreatePerspectiveFovLH( float fov, float aspectRatio, float near, float far )
@@ -324,6 +458,13 @@ Vector4 Matrix::operator[]( int index ) const
 Matrix Matrix::operator*( const Matrix& m ) const
 {
 	Matrix result{};
+#ifdef MATRIX_SIMD
+	// Every result row is this row transformed by m, no transpose needed
+	for ( int r{ 0 }; r < 4; ++r )
+	{
+		_mm_store_ps( &result.data[r].x, TransformRow( _mm_load_ps( &data[r].x ), m.data ) );
+	}
+#else
 	Matrix transposed = Transpose( m );
 
 	for ( int r{ 0 }; r < 4; ++r )
@@ -333,23 +474,14 @@ Matrix Matrix::operator*( const Matrix& m ) const
 			result[r][c] = Vector4::Dot( data[r], transposed[c] );
 		}
 	}
+#endif
 
 	return result;
 }
 
 const Matrix& Matrix::operator*=( const Matrix& m )
 {
-	Matrix copy{ *this };
-	Matrix transposed = Transpose( m );
-
-	for ( int r{ 0 }; r < 4; ++r )
-	{
-		for ( int c{ 0 }; c < 4; ++c )
-		{
-			data[r][c] = Vector4::Dot( copy[r], transposed[c] );
-		}
-	}
-
+	*this = *this * m;
 	return *this;
 }
 
@@ -4,14 +4,15 @@
 
 namespace dae
 {
-struct Matrix final
+// 16 byte aligned -> every row can be loaded straight into an SSE register
+struct alignas( 16 ) Matrix final
 {
 	Matrix() = default;
 	Matrix( const Vector3& xAxis, const Vector3& yAxis, const Vector3& zAxis, const Vector3& t );
 	Matrix( const Vector4& xAxis, const Vector4& yAxis, const Vector4& zAxis, const Vector4& t );
-	Matrix( const Matrix& m );
+	Matrix( const Matrix& m ) = default;
 
-	Matrix& operator=( const Matrix& m );
+	Matrix& operator=( const Matrix& m ) = default;
 
 	void Print();
 
@@ -24,7 +25,11 @@ struct Matrix final
 	Vector4 TransformPoint( float x, float y, float z, float w ) const;
 
 	const Matrix& Transpose();
-	const Matrix& Inverse();
+	const Matrix& Inverse(); // Takes the affine fast path when possible
+	const Matrix& InverseAffine(); // Only valid if IsAffine()
+	const Matrix& InverseRigid();  // Only valid for rotation + translation, no scale
+
+	bool IsAffine() const;
 
 	Vector3 GetAxisX() const;
 	Vector3 GetAxisY() const;
@@ -43,6 +48,8 @@ struct Matrix final
 	static Matrix CreateScale( const Vector3& s );
 	static Matrix Transpose( const Matrix& m );
 	static Matrix Inverse( const Matrix& m );
+	static Matrix InverseAffine( const Matrix& m );
+	static Matrix InverseRigid( const Matrix& m );
 
 	static Matrix CreateLookAtLH( const Vector3& origin, const Vector3& forward, const Vector3& up = Vector3::UnitY );
 	static Matrix CreatePerspectiveFovLH( float fov, float aspectRatio, float near, float far );
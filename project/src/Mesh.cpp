@@ -1,24 +1,44 @@
 #include "Mesh.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
 #include "Error.h"
+#include "MeshSimplification.h"
 
 namespace dae
 {
-Mesh::Mesh( ID3D11Device* pDevice,
-			const std::vector<Vertex>& vertices,
+namespace
+{
+// Until the real map is in: plain gray, flat normals and no highlights
+Texture CreatePlaceholderMap( MeshMap map )
+{
+	switch ( map )
+	{
+	case MeshMap::normal:
+		return Texture::CreateSolid( 128, 128, 255 );
+
+	case MeshMap::specular:
+	case MeshMap::gloss:
+		return Texture::CreateSolid( 0, 0, 0 );
+
+	default:
+		return Texture::CreateSolid( 128, 128, 128 );
+	}
+}
+} // namespace
+
+Mesh::Mesh( const std::vector<Vertex>& vertices,
 			const std::vector<UINT>& indices,
 			D3D11_PRIMITIVE_TOPOLOGY topology,
-			const std::wstring& effectPath,
-			const std::string& diffuseMapPath,
-			const std::string& normalMapPath,
-			const std::string& specularMapPath,
-			const std::string& glossMapPath )
+			VertexFormat vertexFormat )
 	: m_Topology( topology )
-	, m_Effect( pDevice, effectPath )
-	, m_DiffuseMap( pDevice, diffuseMapPath )
-	, m_NormalMap( pDevice, normalMapPath )
-	, m_SpecularMap( pDevice, specularMapPath )
-	, m_GlossMap( pDevice, glossMapPath )
+	, m_DiffuseMap( CreatePlaceholderMap( MeshMap::diffuse ) )
+	, m_NormalMap( CreatePlaceholderMap( MeshMap::normal ) )
+	, m_SpecularMap( CreatePlaceholderMap( MeshMap::specular ) )
+	, m_GlossMap( CreatePlaceholderMap( MeshMap::gloss ) )
 	, m_Vertices( vertices )
+	, m_VertexStreams( streamUtils::ToStreams( vertices ) )
 	, m_Indices( indices )
 {
 	if ( vertices.size() == 0 )
@@ -33,44 +53,107 @@ Mesh::Mesh( ID3D11Device* pDevice,
 	m_VertexCount = vertices.size();
 	m_IndexCount = indices.size();
 
-	// Create Vertex Buffer
-	D3D11_BUFFER_DESC vertexBufferDesc{};
-	vertexBufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
-	vertexBufferDesc.ByteWidth = sizeof( Vertex ) * m_VertexCount;
-	vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+	m_LocalBounds = BoundingBox::FromVertices( vertices );
+	m_LocalSphere = BoundingSphere::FromVertices( vertices );
+	m_VertexFormat = vertexFormat;
+	m_PositionDequantization = PositionDequantization::FromBounds( m_LocalBounds );
+	UpdateWorldBounds();
+	BuildLods( vertices );
+	BuildLodMeshlets( vertices );
+}
 
-	D3D11_SUBRESOURCE_DATA vertexData{};
-	vertexData.pSysMem = vertices.data();
+Mesh::Mesh( ID3D11Device* pDevice,
+			const std::vector<Vertex>& vertices,
+			const std::vector<UINT>& indices,
+			D3D11_PRIMITIVE_TOPOLOGY topology,
+			const std::wstring& effectPath,
+			const std::string& diffuseMapPath,
+			const std::string& normalMapPath,
+			const std::string& specularMapPath,
+			const std::string& glossMapPath,
+			VertexFormat vertexFormat )
+	: Mesh( vertices, indices, topology, vertexFormat )
+{
+	m_DiffuseMap = Texture{ nullptr, diffuseMapPath };
+	m_NormalMap = Texture{ nullptr, normalMapPath };
+	m_SpecularMap = Texture{ nullptr, specularMapPath };
+	m_GlossMap = Texture{ nullptr, glossMapPath };
+	FinishLoading( pDevice, effectPath );
+}
 
-	HRESULT result{ pDevice->CreateBuffer( &vertexBufferDesc, &vertexData, &m_pVertexBuffer ) };
-	if ( FAILED( result ) )
+void Mesh::FinishLoading( ID3D11Device* pDevice, const std::wstring& effectPath )
+{
+	// No device -> software rendering only, skip all hardware resources
+	if ( pDevice )
 	{
-		throw static_cast<int>( result );
+		m_Effect = Effect{ pDevice, effectPath };
+
+		// Create Vertex Buffer
+		const bool isPacked{ m_VertexFormat == VertexFormat::packed };
+		const std::vector<PackedVertex> packedVertices{ isPacked ? PackVertices( m_Vertices, m_PositionDequantization )
+																 : std::vector<PackedVertex>{} };
+
+		D3D11_BUFFER_DESC vertexBufferDesc{};
+		vertexBufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
+		vertexBufferDesc.ByteWidth =
+			static_cast<UINT>( ( isPacked ? sizeof( PackedVertex ) : sizeof( Vertex ) ) * m_VertexCount );
+		vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+
+		D3D11_SUBRESOURCE_DATA vertexData{};
+		vertexData.pSysMem = isPacked ? static_cast<const void*>( packedVertices.data() ) : m_Vertices.data();
+
+		HRESULT result{ pDevice->CreateBuffer( &vertexBufferDesc, &vertexData, &m_pVertexBuffer ) };
+		if ( FAILED( result ) )
+		{
+			throw static_cast<int>( result );
+		}
+		//
+
+		// Create Index Buffer, every LOD in one, half the size when 16 bits reach every vertex
+		// 0xFFFF cuts a strip, so the last vertex a short index may name is 0xFFFE
+		std::vector<uint16_t> shortIndices{};
+		if ( m_VertexCount <= std::numeric_limits<uint16_t>::max() )
+		{
+			m_IndexFormat = DXGI_FORMAT_R16_UINT;
+			shortIndices.assign( m_Indices.begin(), m_Indices.end() );
+		}
+		const bool hasShortIndices{ m_IndexFormat == DXGI_FORMAT_R16_UINT };
+
+		D3D11_BUFFER_DESC indexBufferDesc{};
+		indexBufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
+		indexBufferDesc.ByteWidth =
+			static_cast<UINT>( ( hasShortIndices ? sizeof( uint16_t ) : sizeof( UINT ) ) * m_Indices.size() );
+		indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
+
+		D3D11_SUBRESOURCE_DATA indexData{};
+		indexData.pSysMem = hasShortIndices ? static_cast<const void*>( shortIndices.data() ) : m_Indices.data();
+
+		result = pDevice->CreateBuffer( &indexBufferDesc, &indexData, &m_pIndexBuffer );
+		if ( FAILED( result ) )
+		{
+			throw static_cast<int>( result );
+		}
+		//
+
+		// Pass texture view to effect
+		m_DiffuseMap.CreateDeviceResources( pDevice );
+		m_NormalMap.CreateDeviceResources( pDevice );
+		m_SpecularMap.CreateDeviceResources( pDevice );
+		m_GlossMap.CreateDeviceResources( pDevice );
+		m_Effect.SetDiffuseMap( m_DiffuseMap );
+		m_Effect.SetNormalMap( m_NormalMap );
+		m_Effect.SetSpecularMap( m_SpecularMap );
+		m_Effect.SetGlossMap( m_GlossMap );
+		m_Effect.SetPositionDequantization( m_PositionDequantization );
+		//
 	}
-	//
 
-	// Create Index Buffer
-	D3D11_BUFFER_DESC indexBufferDesc{};
-	indexBufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
-	indexBufferDesc.ByteWidth = sizeof( UINT ) * m_IndexCount;
-	indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-
-	D3D11_SUBRESOURCE_DATA indexData{};
-	indexData.pSysMem = indices.data();
-
-	result = pDevice->CreateBuffer( &indexBufferDesc, &indexData, &m_pIndexBuffer );
-	if ( FAILED( result ) )
+	// Software projects the packed meshlets, the float copies would only take up memory
+	if ( m_VertexFormat == VertexFormat::packed && HasMeshlets() )
 	{
-		throw static_cast<int>( result );
+		m_Vertices = {};
+		m_VertexStreams = {};
 	}
-	//
-
-	// Pass texture view to effect
-	m_Effect.SetDiffuseMap( m_DiffuseMap );
-	m_Effect.SetNormalMap( m_NormalMap );
-	m_Effect.SetSpecularMap( m_SpecularMap );
-	m_Effect.SetGlossMap( m_GlossMap );
-	//
 }
 
 Mesh::Mesh( Mesh&& rhs )
@@ -84,6 +167,26 @@ Mesh::Mesh( Mesh&& rhs )
 	m_IndexCount = rhs.m_IndexCount;
 	m_Topology = rhs.m_Topology;
 	m_WorldMatrix = rhs.m_WorldMatrix;
+	m_LocalBounds = rhs.m_LocalBounds;
+	m_LocalSphere = rhs.m_LocalSphere;
+	m_WorldBounds = rhs.m_WorldBounds;
+	m_WorldSphere = rhs.m_WorldSphere;
+	m_WorldVersion = rhs.m_WorldVersion;
+	m_InstanceWorlds = std::move( rhs.m_InstanceWorlds );
+	m_InstancesBounds = rhs.m_InstancesBounds;
+	m_InstancesSphere = rhs.m_InstancesSphere;
+	m_Lods = std::move( rhs.m_Lods );
+	m_Lod = rhs.m_Lod;
+	m_InstanceLods = std::move( rhs.m_InstanceLods );
+	m_LodFirstInstances = std::move( rhs.m_LodFirstInstances );
+	m_Meshlets = std::move( rhs.m_Meshlets );
+	m_LodMeshlets = std::move( rhs.m_LodMeshlets );
+	m_MeshletVertexStreams = std::move( rhs.m_MeshletVertexStreams );
+	m_PackedMeshletVertices = std::move( rhs.m_PackedMeshletVertices );
+	m_MeshletTriangles = std::move( rhs.m_MeshletTriangles );
+	m_VertexFormat = rhs.m_VertexFormat;
+	m_PositionDequantization = rhs.m_PositionDequantization;
+	m_IndexFormat = rhs.m_IndexFormat;
 
 	m_pVertexBuffer = rhs.m_pVertexBuffer;
 	rhs.m_pVertexBuffer = nullptr;
@@ -91,6 +194,12 @@ Mesh::Mesh( Mesh&& rhs )
 	m_pIndexBuffer = rhs.m_pIndexBuffer;
 	rhs.m_pIndexBuffer = nullptr;
 
+	m_pInstanceBuffer = rhs.m_pInstanceBuffer;
+	rhs.m_pInstanceBuffer = nullptr;
+	m_InstanceBufferCapacity = rhs.m_InstanceBufferCapacity;
+	rhs.m_InstanceBufferCapacity = 0;
+	m_IsInstanceBufferDirty = rhs.m_IsInstanceBufferDirty;
+
 	m_Effect = std::move( rhs.m_Effect );
 	m_DiffuseMap = std::move( rhs.m_DiffuseMap );
 	m_NormalMap = std::move( rhs.m_NormalMap );
@@ -98,6 +207,7 @@ Mesh::Mesh( Mesh&& rhs )
 	m_GlossMap = std::move( rhs.m_GlossMap );
 
 	m_Vertices = std::move( rhs.m_Vertices );
+	m_VertexStreams = std::move( rhs.m_VertexStreams );
 	m_Indices = std::move( rhs.m_Indices );
 }
 
@@ -112,6 +222,26 @@ Mesh& Mesh::operator=( Mesh&& rhs )
 	m_IndexCount = rhs.m_IndexCount;
 	m_Topology = rhs.m_Topology;
 	m_WorldMatrix = rhs.m_WorldMatrix;
+	m_LocalBounds = rhs.m_LocalBounds;
+	m_LocalSphere = rhs.m_LocalSphere;
+	m_WorldBounds = rhs.m_WorldBounds;
+	m_WorldSphere = rhs.m_WorldSphere;
+	m_WorldVersion = rhs.m_WorldVersion;
+	m_InstanceWorlds = std::move( rhs.m_InstanceWorlds );
+	m_InstancesBounds = rhs.m_InstancesBounds;
+	m_InstancesSphere = rhs.m_InstancesSphere;
+	m_Lods = std::move( rhs.m_Lods );
+	m_Lod = rhs.m_Lod;
+	m_InstanceLods = std::move( rhs.m_InstanceLods );
+	m_LodFirstInstances = std::move( rhs.m_LodFirstInstances );
+	m_Meshlets = std::move( rhs.m_Meshlets );
+	m_LodMeshlets = std::move( rhs.m_LodMeshlets );
+	m_MeshletVertexStreams = std::move( rhs.m_MeshletVertexStreams );
+	m_PackedMeshletVertices = std::move( rhs.m_PackedMeshletVertices );
+	m_MeshletTriangles = std::move( rhs.m_MeshletTriangles );
+	m_VertexFormat = rhs.m_VertexFormat;
+	m_PositionDequantization = rhs.m_PositionDequantization;
+	m_IndexFormat = rhs.m_IndexFormat;
 
 	m_pVertexBuffer = rhs.m_pVertexBuffer;
 	rhs.m_pVertexBuffer = nullptr;
@@ -119,6 +249,12 @@ Mesh& Mesh::operator=( Mesh&& rhs )
 	m_pIndexBuffer = rhs.m_pIndexBuffer;
 	rhs.m_pIndexBuffer = nullptr;
 
+	m_pInstanceBuffer = rhs.m_pInstanceBuffer;
+	rhs.m_pInstanceBuffer = nullptr;
+	m_InstanceBufferCapacity = rhs.m_InstanceBufferCapacity;
+	rhs.m_InstanceBufferCapacity = 0;
+	m_IsInstanceBufferDirty = rhs.m_IsInstanceBufferDirty;
+
 	m_Effect = std::move( rhs.m_Effect );
 	m_DiffuseMap = std::move( rhs.m_DiffuseMap );
 	m_NormalMap = std::move( rhs.m_NormalMap );
@@ -126,6 +262,7 @@ Mesh& Mesh::operator=( Mesh&& rhs )
 	m_GlossMap = std::move( rhs.m_GlossMap );
 
 	m_Vertices = std::move( rhs.m_Vertices );
+	m_VertexStreams = std::move( rhs.m_VertexStreams );
 	m_Indices = std::move( rhs.m_Indices );
 
 	return *this;
@@ -142,32 +279,132 @@ Mesh::~Mesh() noexcept
 	{
 		m_pIndexBuffer->Release();
 	}
+
+	if ( m_pInstanceBuffer )
+	{
+		m_pInstanceBuffer->Release();
+	}
 }
 
 void Mesh::Draw( ID3D11DeviceContext* pDeviceContext ) const
 {
+	const bool isInstanced{ !m_InstanceWorlds.empty() };
+	if ( isInstanced )
+	{
+		UploadInstances( pDeviceContext );
+	}
+	const bool isPacked{ m_VertexFormat == VertexFormat::packed };
+	ID3DX11EffectTechnique* pTechnique{};
+	ID3D11InputLayout* pInputLayout{};
+	if ( isPacked )
+	{
+		pTechnique = isInstanced ? m_Effect.GetPackedInstancedTechniquePtr() : m_Effect.GetPackedTechniquePtr();
+		pInputLayout = isInstanced ? m_Effect.GetPackedInstancedInputLayoutPtr() : m_Effect.GetPackedInputLayoutPtr();
+	}
+	else
+	{
+		pTechnique = isInstanced ? m_Effect.GetInstancedTechniquePtr() : m_Effect.GetTechniquePtr();
+		pInputLayout = isInstanced ? m_Effect.GetInstancedInputLayoutPtr() : m_Effect.GetInputLayoutPtr();
+	}
+
 	// 1. Set primitive topology
 	pDeviceContext->IASetPrimitiveTopology( m_Topology );
 
 	// 2. Set input layout
-	pDeviceContext->IASetInputLayout( m_Effect.GetInputLayoutPtr() );
+	pDeviceContext->IASetInputLayout( pInputLayout );
 
-	// 3. Set vertex buffer
-	constexpr UINT stride{ sizeof( Vertex ) };
-	constexpr UINT offset{};
-	pDeviceContext->IASetVertexBuffers( 0, 1, &m_pVertexBuffer, &stride, &offset );
+	// 3. Set vertex buffers, the instance matrices go in the second slot
+	const std::array<ID3D11Buffer*, 2> vertexBuffers{ m_pVertexBuffer, m_pInstanceBuffer };
+	const UINT vertexStride{ static_cast<UINT>( isPacked ? sizeof( PackedVertex ) : sizeof( Vertex ) ) };
+	const std::array<UINT, 2> strides{ vertexStride, sizeof( Matrix ) };
+	constexpr std::array<UINT, 2> offsets{};
+	pDeviceContext->IASetVertexBuffers( 0, isInstanced ? 2 : 1, vertexBuffers.data(), strides.data(), offsets.data() );
 
 	// 4. Set index buffer
-	pDeviceContext->IASetIndexBuffer( m_pIndexBuffer, DXGI_FORMAT_R32_UINT, 0 );
+	pDeviceContext->IASetIndexBuffer( m_pIndexBuffer, m_IndexFormat, 0 );
 
 	// 5. Draw
 	D3DX11_TECHNIQUE_DESC techDesc{};
-	m_Effect.GetTechniquePtr()->GetDesc( &techDesc );
+	pTechnique->GetDesc( &techDesc );
 	for ( UINT passIdx{}; passIdx < techDesc.Passes; ++passIdx )
 	{
-		m_Effect.GetTechniquePtr()->GetPassByIndex( passIdx )->Apply( 0, pDeviceContext );
-		pDeviceContext->DrawIndexed( m_IndexCount, 0, 0 );
+		pTechnique->GetPassByIndex( passIdx )->Apply( 0, pDeviceContext );
+		if ( !isInstanced )
+		{
+			pDeviceContext->DrawIndexed( m_Lods[m_Lod].indexCount, m_Lods[m_Lod].firstIndex, 0 );
+			continue;
+		}
+
+		// One draw per LOD, each reading its own run of the instance buffer
+		for ( size_t lodIdx{}; lodIdx < m_Lods.size(); ++lodIdx )
+		{
+			const UINT instanceCount{ m_LodFirstInstances[lodIdx + 1] - m_LodFirstInstances[lodIdx] };
+			if ( instanceCount )
+			{
+				pDeviceContext->DrawIndexedInstanced( m_Lods[lodIdx].indexCount,
+													  instanceCount,
+													  m_Lods[lodIdx].firstIndex,
+													  0,
+													  m_LodFirstInstances[lodIdx] );
+			}
+		}
+	}
+}
+
+void Mesh::UploadInstances( ID3D11DeviceContext* pDeviceContext ) const
+{
+	if ( !m_IsInstanceBufferDirty )
+	{
+		return;
+	}
+
+	const UINT instanceCount{ static_cast<UINT>( m_InstanceWorlds.size() ) };
+	if ( instanceCount > m_InstanceBufferCapacity )
+	{
+		if ( m_pInstanceBuffer )
+		{
+			m_pInstanceBuffer->Release();
+			m_pInstanceBuffer = nullptr;
+		}
+
+		ID3D11Device* pDevice{};
+		pDeviceContext->GetDevice( &pDevice );
+
+		D3D11_BUFFER_DESC instanceBufferDesc{};
+		instanceBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+		instanceBufferDesc.ByteWidth = sizeof( Matrix ) * instanceCount;
+		instanceBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+		instanceBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+
+		const HRESULT result{ pDevice->CreateBuffer( &instanceBufferDesc, nullptr, &m_pInstanceBuffer ) };
+		pDevice->Release();
+		if ( FAILED( result ) )
+		{
+			throw static_cast<int>( result );
+		}
+		m_InstanceBufferCapacity = instanceCount;
+	}
+
+	D3D11_MAPPED_SUBRESOURCE mappedInstances{};
+	const HRESULT result{ pDeviceContext->Map( m_pInstanceBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedInstances ) };
+	if ( FAILED( result ) )
+	{
+		throw static_cast<int>( result );
+	}
+	Matrix* pMappedWorlds{ static_cast<Matrix*>( mappedInstances.pData ) };
+	for ( size_t lodIdx{}; lodIdx < m_Lods.size(); ++lodIdx )
+	{
+		for ( size_t instanceIdx{}; instanceIdx < m_InstanceWorlds.size(); ++instanceIdx )
+		{
+			if ( m_InstanceLods[instanceIdx] == lodIdx )
+			{
+				*pMappedWorlds++ = m_InstanceWorlds[instanceIdx];
+			}
+		}
 	}
+	pDeviceContext->Unmap( m_pInstanceBuffer, 0 );
+
+	m_IsInstanceBufferDirty = false;
 }
 
 void Mesh::CycleFilteringMode()
@@ -175,22 +412,269 @@ void Mesh::CycleFilteringMode()
 	m_Effect.CycleFilteringMode();
 }
 
+void Mesh::SetFilteringMode( FilterMode filterMode )
+{
+	m_Effect.SetFilteringMode( filterMode );
+}
+
 void Mesh::ApplyMatrix( const Matrix& action )
 {
 	m_WorldMatrix = action * m_WorldMatrix;
+	UpdateWorldBounds();
+}
+
+bool Mesh::IsVisible( const Frustum& frustum ) const
+{
+	// Sphere first, it is cheaper and rejects most of what the box would
+	return frustum.Intersects( m_WorldSphere ) && frustum.Intersects( m_WorldBounds );
+}
+
+void Mesh::GetVisibleWorlds( const Frustum& frustum, std::vector<Matrix>& worlds, std::vector<uint8_t>& lods ) const
+{
+	worlds.clear();
+	lods.clear();
+	if ( !IsVisible( frustum ) )
+	{
+		return;
+	}
+
+	if ( m_InstanceWorlds.empty() )
+	{
+		worlds.push_back( m_WorldMatrix );
+		lods.push_back( m_Lod );
+		return;
+	}
+
+	for ( size_t instanceIdx{}; instanceIdx < m_InstanceWorlds.size(); ++instanceIdx )
+	{
+		const Matrix world{ m_InstanceWorlds[instanceIdx] * m_WorldMatrix };
+		if ( frustum.Intersects( m_LocalSphere.Transformed( world ) ) &&
+			 frustum.Intersects( m_LocalBounds.Transformed( world ) ) )
+		{
+			worlds.push_back( world );
+			lods.push_back( m_InstanceLods[instanceIdx] );
+		}
+	}
+}
+
+void Mesh::UpdateLods( const Vector3& cameraPosition, float tanHalfFov, bool useLods )
+{
+	bool hasChanged{ false };
+	auto updateLod{ [&]( uint8_t& lod, const BoundingSphere& sphere ) {
+		const uint8_t selectedLod{ useLods ? SelectLod( sphere, cameraPosition, tanHalfFov, lod ) : uint8_t{} };
+		hasChanged |= selectedLod != lod;
+		lod = selectedLod;
+	} };
+
+	if ( m_InstanceWorlds.empty() )
+	{
+		updateLod( m_Lod, m_WorldSphere );
+	}
+	else
+	{
+		for ( size_t instanceIdx{}; instanceIdx < m_InstanceWorlds.size(); ++instanceIdx )
+		{
+			updateLod( m_InstanceLods[instanceIdx],
+					   m_LocalSphere.Transformed( m_InstanceWorlds[instanceIdx] * m_WorldMatrix ) );
+		}
+	}
+
+	if ( !hasChanged )
+	{
+		return;
+	}
+
+	// Nothing moved, but the image did
+	++m_WorldVersion;
+	if ( !m_InstanceWorlds.empty() )
+	{
+		UpdateLodFirstInstances();
+		m_IsInstanceBufferDirty = true;
+	}
+}
+
+uint8_t Mesh::SelectLod( const BoundingSphere& sphere,
+						 const Vector3& cameraPosition,
+						 float tanHalfFov,
+						 uint8_t lod ) const
+{
+	// Each level is used once the sphere's radius drops below this fraction of half the screen height
+	// Every level halves the triangles while the covered area quarters, so triangles keep getting bigger on screen
+	constexpr std::array<float, 3> lodScreenFractions{ 0.25f, 0.125f, 0.0625f };
+	// Going coarser needs the sphere this much smaller than going back finer, so a LOD does not flicker on a border
+	constexpr float lodHysteresis{ 0.8f };
+
+	const float distance{ ( sphere.center - cameraPosition ).Magnitude() };
+	if ( distance <= sphere.radius )
+	{
+		return 0;
+	}
+	const float screenFraction{ sphere.radius / ( distance * tanHalfFov ) };
+
+	uint8_t selectedLod{};
+	while ( selectedLod + 1u < m_Lods.size() && selectedLod < lodScreenFractions.size() )
+	{
+		const float threshold{ lodScreenFractions[selectedLod] * ( selectedLod >= lod ? lodHysteresis : 1.f ) };
+		if ( screenFraction >= threshold )
+		{
+			break;
+		}
+		++selectedLod;
+	}
+	return selectedLod;
+}
+
+void Mesh::BuildLods( const std::vector<Vertex>& vertices )
+{
+	m_Lods = { { 0, m_IndexCount } };
+
+	// Strips would have to be restitched after simplifying, they stay at full detail
+	if ( m_Topology != D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST )
+	{
+		return;
+	}
+
+	// A level that barely shrank is not worth its memory, the simplifier stops early on meshes it cannot fold
+	constexpr float minLodShrink{ 0.75f };
+	const std::vector<std::vector<uint32_t>> levels{ BuildLodChain( vertices, m_Indices, { 0.5f, 0.25f, 0.125f } ) };
+	for ( const std::vector<uint32_t>& levelIndices : levels )
+	{
+		if ( levelIndices.empty() || levelIndices.size() > m_Lods.back().indexCount * minLodShrink )
+		{
+			break;
+		}
+
+		m_Lods.push_back( { static_cast<UINT>( m_Indices.size() ), static_cast<UINT>( levelIndices.size() ) } );
+		m_Indices.insert( m_Indices.end(), levelIndices.begin(), levelIndices.end() );
+	}
+}
+
+void Mesh::BuildLodMeshlets( const std::vector<Vertex>& vertices )
+{
+	if ( m_Topology != D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST )
+	{
+		return;
+	}
+
+	std::vector<Vertex> meshletVertices{};
+	for ( const IndexRange& lod : m_Lods )
+	{
+		const uint32_t firstMeshlet{ static_cast<uint32_t>( m_Meshlets.size() ) };
+		BuildMeshlets( vertices, m_Indices, lod.firstIndex, lod.indexCount, m_Meshlets, meshletVertices, m_MeshletTriangles );
+		m_LodMeshlets.push_back( { firstMeshlet, static_cast<uint32_t>( m_Meshlets.size() ) - firstMeshlet } );
+	}
+
+	if ( m_VertexFormat == VertexFormat::packed )
+	{
+		m_PackedMeshletVertices = PackVertices( meshletVertices, m_PositionDequantization );
+		return;
+	}
+	m_MeshletVertexStreams = streamUtils::ToStreams( meshletVertices );
+}
+
+void Mesh::UpdateLodFirstInstances()
+{
+	m_LodFirstInstances.assign( m_Lods.size() + 1, 0 );
+	for ( const uint8_t lod : m_InstanceLods )
+	{
+		++m_LodFirstInstances[lod + 1];
+	}
+	for ( size_t lodIdx{ 1 }; lodIdx < m_LodFirstInstances.size(); ++lodIdx )
+	{
+		m_LodFirstInstances[lodIdx] += m_LodFirstInstances[lodIdx - 1];
+	}
+}
+
+void Mesh::UpdateWorldBounds()
+{
+	const bool isInstanced{ !m_InstanceWorlds.empty() };
+	m_WorldBounds = ( isInstanced ? m_InstancesBounds : m_LocalBounds ).Transformed( m_WorldMatrix );
+	m_WorldSphere = ( isInstanced ? m_InstancesSphere : m_LocalSphere ).Transformed( m_WorldMatrix );
+	++m_WorldVersion;
 }
 
 void Mesh::SetWorldViewProjection( const Vector3& o, const Matrix& v, const Matrix& p )
 {
+	if ( !m_Effect.IsInitialized() )
+	{
+		return;
+	}
+
 	m_Effect.SetWorldViewProjection( m_WorldMatrix * ( v * p ) );
 	m_Effect.SetWorld( m_WorldMatrix );
+	m_Effect.SetViewProjection( v * p );
 	m_Effect.SetCameraOrigin( o );
 }
 
 void Mesh::SetWorld( const Matrix& w )
 {
 	m_WorldMatrix = w;
-	m_Effect.SetWorld( m_WorldMatrix );
+	UpdateWorldBounds();
+	if ( m_Effect.IsInitialized() )
+	{
+		m_Effect.SetWorld( m_WorldMatrix );
+	}
+}
+
+void Mesh::SetInstances( const std::vector<Matrix>& instanceWorlds )
+{
+	m_InstanceWorlds = instanceWorlds;
+	m_InstanceLods.assign( m_InstanceWorlds.size(), 0 );
+	UpdateLodFirstInstances();
+	m_IsInstanceBufferDirty = true;
+
+	// Sphere around the instance spheres, centered on the box around them
+	m_InstancesBounds = BoundingBox::CreateEmpty();
+	for ( const Matrix& instanceWorld : m_InstanceWorlds )
+	{
+		m_InstancesBounds.Grow( m_LocalBounds.Transformed( instanceWorld ) );
+	}
+
+	m_InstancesSphere = { m_InstancesBounds.GetCenter(), 0.f };
+	for ( const Matrix& instanceWorld : m_InstanceWorlds )
+	{
+		const BoundingSphere instanceSphere{ m_LocalSphere.Transformed( instanceWorld ) };
+		m_InstancesSphere.radius =
+			std::max( m_InstancesSphere.radius,
+					  ( instanceSphere.center - m_InstancesSphere.center ).Magnitude() + instanceSphere.radius );
+	}
+
+	UpdateWorldBounds();
+}
+
+void Mesh::SetMap( ID3D11Device* pDevice, MeshMap map, Texture&& texture )
+{
+	texture.CreateDeviceResources( pDevice );
+	switch ( map )
+	{
+	case MeshMap::diffuse:
+		m_DiffuseMap = std::move( texture );
+		break;
+
+	case MeshMap::normal:
+		m_NormalMap = std::move( texture );
+		break;
+
+	case MeshMap::specular:
+		m_SpecularMap = std::move( texture );
+		break;
+
+	case MeshMap::gloss:
+		m_GlossMap = std::move( texture );
+		break;
+
+	default:
+		return;
+	}
+
+	// The effect still points at the old view otherwise
+	if ( pDevice )
+	{
+		m_Effect.SetDiffuseMap( m_DiffuseMap );
+		m_Effect.SetNormalMap( m_NormalMap );
+		m_Effect.SetSpecularMap( m_SpecularMap );
+		m_Effect.SetGlossMap( m_GlossMap );
+	}
 }
 
 ID3D11Buffer* Mesh::GetVertexBufferPtr() const
@@ -217,15 +701,73 @@ uint32_t Mesh::GetIndexCount() const
 {
 	return m_IndexCount;
 }
-TransparentMesh::TransparentMesh( ID3D11Device* pDevice,
-								  const std::vector<Vertex>& vertices,
+
+size_t Mesh::GetInstanceCount() const
+{
+	return m_InstanceWorlds.size();
+}
+
+uint32_t Mesh::GetWorldVersion() const
+{
+	return m_WorldVersion;
+}
+
+size_t Mesh::GetLodCount() const
+{
+	return m_Lods.size();
+}
+
+VertexFormat Mesh::GetVertexFormat() const
+{
+	return m_VertexFormat;
+}
+
+const IndexRange& Mesh::GetLodIndices( uint8_t lod ) const
+{
+	return m_Lods[lod];
+}
+
+bool Mesh::HasMeshlets() const
+{
+	return !m_Meshlets.empty();
+}
+
+const std::vector<Meshlet>& Mesh::GetMeshlets() const
+{
+	return m_Meshlets;
+}
+
+const MeshletRange& Mesh::GetLodMeshlets( uint8_t lod ) const
+{
+	return m_LodMeshlets[lod];
+}
+
+const VertexStreams& Mesh::GetMeshletVertexStreams() const
+{
+	return m_MeshletVertexStreams;
+}
+
+const std::vector<PackedVertex>& Mesh::GetPackedMeshletVertices() const
+{
+	return m_PackedMeshletVertices;
+}
+
+const PositionDequantization& Mesh::GetPositionDequantization() const
+{
+	return m_PositionDequantization;
+}
+
+const std::vector<uint8_t>& Mesh::GetMeshletTriangles() const
+{
+	return m_MeshletTriangles;
+}
+TransparentMesh::TransparentMesh( const std::vector<Vertex>& vertices,
 								  const std::vector<UINT>& indices,
-								  D3D11_PRIMITIVE_TOPOLOGY topology,
-								  const std::wstring& effectPath,
-								  const std::string& diffuseMapPath )
+								  D3D11_PRIMITIVE_TOPOLOGY topology )
 	: m_Topology( topology )
-	, m_Effect( pDevice, effectPath )
-	, m_DiffuseMap( pDevice, diffuseMapPath )
+	, m_DiffuseMap( Texture::CreateSolid( 0, 0, 0, 0 ) ) // Fully transparent until the real one is in
+	, m_VertexStreams( streamUtils::ToStreams( vertices ) )
+	, m_Indices( indices )
 {
 	if ( vertices.size() == 0 )
 	{
@@ -239,6 +781,34 @@ TransparentMesh::TransparentMesh( ID3D11Device* pDevice,
 	m_VertexCount = vertices.size();
 	m_IndexCount = indices.size();
 
+	m_LocalBounds = BoundingBox::FromVertices( vertices );
+	m_LocalSphere = BoundingSphere::FromVertices( vertices );
+	UpdateWorldBounds();
+}
+
+TransparentMesh::TransparentMesh( ID3D11Device* pDevice,
+								  const std::vector<Vertex>& vertices,
+								  const std::vector<UINT>& indices,
+								  D3D11_PRIMITIVE_TOPOLOGY topology,
+								  const std::wstring& effectPath,
+								  const std::string& diffuseMapPath )
+	: TransparentMesh( vertices, indices, topology )
+{
+	m_DiffuseMap = Texture{ nullptr, diffuseMapPath };
+	FinishLoading( pDevice, effectPath );
+}
+
+void TransparentMesh::FinishLoading( ID3D11Device* pDevice, const std::wstring& effectPath )
+{
+	// No device -> software rendering only, skip all hardware resources
+	if ( !pDevice )
+	{
+		return;
+	}
+
+	m_Effect = TransparentEffect{ pDevice, effectPath };
+	const std::vector<Vertex> vertices{ streamUtils::ToVertices( m_VertexStreams ) }; // Only the streams are kept
+
 	// Create Vertex Buffer
 	D3D11_BUFFER_DESC vertexBufferDesc{};
 	vertexBufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
@@ -262,7 +832,7 @@ TransparentMesh::TransparentMesh( ID3D11Device* pDevice,
 	indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
 
 	D3D11_SUBRESOURCE_DATA indexData{};
-	indexData.pSysMem = indices.data();
+	indexData.pSysMem = m_Indices.data();
 
 	result = pDevice->CreateBuffer( &indexBufferDesc, &indexData, &m_pIndexBuffer );
 	if ( FAILED( result ) )
@@ -272,6 +842,7 @@ TransparentMesh::TransparentMesh( ID3D11Device* pDevice,
 	//
 
 	// Pass texture view to effect
+	m_DiffuseMap.CreateDeviceResources( pDevice );
 	m_Effect.SetDiffuseMap( m_DiffuseMap );
 	//
 }
@@ -281,6 +852,11 @@ const std::vector<Vertex>& Mesh::GetVertices() const
 	return m_Vertices;
 }
 
+const VertexStreams& Mesh::GetVertexStreams() const
+{
+	return m_VertexStreams;
+}
+
 const std::vector<UINT>& Mesh::GetIndices() const
 {
 	return m_Indices;
@@ -296,6 +872,21 @@ D3D11_PRIMITIVE_TOPOLOGY Mesh::GetTopology() const
 	return m_Topology;
 }
 
+const BoundingBox& Mesh::GetWorldBounds() const
+{
+	return m_WorldBounds;
+}
+
+const BoundingSphere& Mesh::GetWorldSphere() const
+{
+	return m_WorldSphere;
+}
+
+const BoundingBox& Mesh::GetLocalBounds() const
+{
+	return m_LocalBounds;
+}
+
 const Texture& Mesh::GetDiffuseMap() const
 {
 	return m_DiffuseMap;
@@ -327,6 +918,11 @@ TransparentMesh::TransparentMesh( TransparentMesh&& rhs )
 	m_IndexCount = rhs.m_IndexCount;
 	m_Topology = rhs.m_Topology;
 	m_WorldMatrix = rhs.m_WorldMatrix;
+	m_LocalBounds = rhs.m_LocalBounds;
+	m_LocalSphere = rhs.m_LocalSphere;
+	m_WorldBounds = rhs.m_WorldBounds;
+	m_WorldSphere = rhs.m_WorldSphere;
+	m_WorldVersion = rhs.m_WorldVersion;
 
 	m_pVertexBuffer = rhs.m_pVertexBuffer;
 	rhs.m_pVertexBuffer = nullptr;
@@ -336,6 +932,9 @@ TransparentMesh::TransparentMesh( TransparentMesh&& rhs )
 
 	m_Effect = std::move( rhs.m_Effect );
 	m_DiffuseMap = std::move( rhs.m_DiffuseMap );
+
+	m_VertexStreams = std::move( rhs.m_VertexStreams );
+	m_Indices = std::move( rhs.m_Indices );
 }
 
 TransparentMesh& TransparentMesh::operator=( TransparentMesh&& rhs )
@@ -349,6 +948,11 @@ TransparentMesh& TransparentMesh::operator=( TransparentMesh&& rhs )
 	m_IndexCount = rhs.m_IndexCount;
 	m_Topology = rhs.m_Topology;
 	m_WorldMatrix = rhs.m_WorldMatrix;
+	m_LocalBounds = rhs.m_LocalBounds;
+	m_LocalSphere = rhs.m_LocalSphere;
+	m_WorldBounds = rhs.m_WorldBounds;
+	m_WorldSphere = rhs.m_WorldSphere;
+	m_WorldVersion = rhs.m_WorldVersion;
 
 	m_pVertexBuffer = rhs.m_pVertexBuffer;
 	rhs.m_pVertexBuffer = nullptr;
@@ -359,6 +963,9 @@ TransparentMesh& TransparentMesh::operator=( TransparentMesh&& rhs )
 	m_Effect = std::move( rhs.m_Effect );
 	m_DiffuseMap = std::move( rhs.m_DiffuseMap );
 
+	m_VertexStreams = std::move( rhs.m_VertexStreams );
+	m_Indices = std::move( rhs.m_Indices );
+
 	return *this;
 }
 
@@ -406,19 +1013,53 @@ void TransparentMesh::CycleFilteringMode()
 	m_Effect.CycleFilteringMode();
 }
 
+void TransparentMesh::SetFilteringMode( FilterMode filterMode )
+{
+	m_Effect.SetFilteringMode( filterMode );
+}
+
 void TransparentMesh::ApplyMatrix( const Matrix& action )
 {
 	m_WorldMatrix = action * m_WorldMatrix;
+	UpdateWorldBounds();
+}
+
+bool TransparentMesh::IsVisible( const Frustum& frustum ) const
+{
+	return frustum.Intersects( m_WorldSphere ) && frustum.Intersects( m_WorldBounds );
+}
+
+void TransparentMesh::UpdateWorldBounds()
+{
+	m_WorldBounds = m_LocalBounds.Transformed( m_WorldMatrix );
+	m_WorldSphere = m_LocalSphere.Transformed( m_WorldMatrix );
+	++m_WorldVersion;
 }
 
 void TransparentMesh::SetWorldViewProjection( const Matrix& v, const Matrix& p )
 {
+	if ( !m_Effect.IsInitialized() )
+	{
+		return;
+	}
+
 	m_Effect.SetWorldViewProjection( m_WorldMatrix * ( v * p ) );
 }
 
 void TransparentMesh::SetWorld( const Matrix& w )
 {
 	m_WorldMatrix = w;
+	UpdateWorldBounds();
+}
+
+void TransparentMesh::SetDiffuseMap( ID3D11Device* pDevice, Texture&& texture )
+{
+	texture.CreateDeviceResources( pDevice );
+	m_DiffuseMap = std::move( texture );
+	if ( pDevice )
+	{
+		m_Effect.SetDiffuseMap( m_DiffuseMap );
+	}
 }
 
 ID3D11Buffer* TransparentMesh::GetVertexBufferPtr() const
@@ -445,4 +1086,44 @@ uint32_t TransparentMesh::GetIndexCount() const
 {
 	return m_IndexCount;
 }
+
+const BoundingBox& TransparentMesh::GetWorldBounds() const
+{
+	return m_WorldBounds;
+}
+
+const BoundingSphere& TransparentMesh::GetWorldSphere() const
+{
+	return m_WorldSphere;
+}
+
+uint32_t TransparentMesh::GetWorldVersion() const
+{
+	return m_WorldVersion;
+}
+
+const VertexStreams& TransparentMesh::GetVertexStreams() const
+{
+	return m_VertexStreams;
+}
+
+const std::vector<UINT>& TransparentMesh::GetIndices() const
+{
+	return m_Indices;
+}
+
+const Matrix& TransparentMesh::GetWorld() const
+{
+	return m_WorldMatrix;
+}
+
+D3D11_PRIMITIVE_TOPOLOGY TransparentMesh::GetTopology() const
+{
+	return m_Topology;
+}
+
+const Texture& TransparentMesh::GetDiffuseMap() const
+{
+	return m_DiffuseMap;
+}
 } // namespace dae
@@ -1,14 +1,42 @@
 #ifndef MESH_H
 #define MESH_H
 #include <vector>
+#include "BoundingVolumes.h"
 #include "Effect.h"
+#include "Meshlets.h"
+#include "VectorStream.h"
+#include "VertexPacking.h"
 
 namespace dae
 {
+// Part of an index buffer, in indices
+struct IndexRange final
+{
+	UINT firstIndex{};
+	UINT indexCount{};
+};
+
+// The maps every opaque mesh samples
+enum class MeshMap
+{
+	diffuse,
+	normal,
+	specular,
+	gloss,
+	count,
+};
+
 class Mesh final
 {
 public:
 	Mesh() = default;
+	// Geometry only, safe off the thread that owns the device: maps are placeholders, nothing exists on the device
+	// FinishLoading has to follow before the mesh is drawn
+	Mesh( const std::vector<Vertex>& vertices,
+		  const std::vector<UINT>& indices,
+		  D3D11_PRIMITIVE_TOPOLOGY topology,
+		  VertexFormat vertexFormat = VertexFormat::full );
+	// Everything at once, on the thread that owns the device
 	Mesh( ID3D11Device* pDevice,
 		  const std::vector<Vertex>& vertices,
 		  const std::vector<UINT>& indices,
@@ -17,7 +45,8 @@ public:
 		  const std::string& diffuseMapPath,
 		  const std::string& normalMapPath,
 		  const std::string& specularMapPath,
-		  const std::string& glossMapPath );
+		  const std::string& glossMapPath,
+		  VertexFormat vertexFormat = VertexFormat::full );
 	Mesh( const Mesh& ) = delete;
 	Mesh( Mesh&& rhs );
 
@@ -27,26 +56,58 @@ public:
 	~Mesh() noexcept;
 
 	// Methods
+	// On the thread that owns the device: creates the buffers and the effect and uploads the maps
+	// No device -> software rendering only, the float vertex copies a packed mesh does not need are dropped either way
+	void FinishLoading( ID3D11Device* pDevice, const std::wstring& effectPath );
 	void Draw( ID3D11DeviceContext* pDeviceContext ) const;
 	void CycleFilteringMode();
+	void SetFilteringMode( FilterMode filterMode );
 	void ApplyMatrix( const Matrix& action );
+	bool IsVisible( const Frustum& frustum ) const; // Conservative, false only when fully outside
+	// World matrix and selected LOD of every copy not fully outside the frustum: just one when not instanced
+	void GetVisibleWorlds( const Frustum& frustum, std::vector<Matrix>& worlds, std::vector<uint8_t>& lods ) const;
+	// Picks the LOD of every copy from how much of the screen height it covers, both backends draw what this picked
+	// tanHalfFov is the camera's GetFov(), useLods false goes back to the full mesh
+	void UpdateLods( const Vector3& cameraPosition, float tanHalfFov, bool useLods );
 
 	// Setters
 	void SetWorldViewProjection( const Vector3& o, const Matrix& v, const Matrix& p );
 	void SetWorld( const Matrix& w );
+	// Draws one copy per matrix, placed by instanceWorld * world, all sharing this mesh's buffers and textures
+	// An empty vector goes back to a single copy at the world matrix
+	void SetInstances( const std::vector<Matrix>& instanceWorlds );
+	// Replaces a map, uploaded first when there is a device, between frames on the thread that owns it
+	void SetMap( ID3D11Device* pDevice, MeshMap map, Texture&& texture );
 
 	// Getters
 	ID3D11Buffer* GetVertexBufferPtr() const;
 	ID3D11Buffer* GetIndexBufferPtr() const;
 	Effect* GetEffectPtr();
 	uint32_t GetVertexCount() const;
-	uint32_t GetIndexCount() const;
+	uint32_t GetIndexCount() const; // Of the full detail level
+	size_t GetInstanceCount() const; // 0 when not instanced
+	uint32_t GetWorldVersion() const; // Changes whenever the world matrix, the instances or a LOD do
+	size_t GetLodCount() const;
+	VertexFormat GetVertexFormat() const;
 
 	// For software
+	// Packed meshes with meshlets keep no float copies: vertices and vertex streams are empty
 	const std::vector<Vertex>& GetVertices() const;
-	const std::vector<UINT>& GetIndices() const;
+	const VertexStreams& GetVertexStreams() const;
+	const std::vector<UINT>& GetIndices() const; // Every LOD, back to back
+	const IndexRange& GetLodIndices( uint8_t lod ) const;
+	bool HasMeshlets() const; // Only triangle lists are split into meshlets
+	const std::vector<Meshlet>& GetMeshlets() const;
+	const MeshletRange& GetLodMeshlets( uint8_t lod ) const;
+	const VertexStreams& GetMeshletVertexStreams() const; // Full format only
+	const std::vector<PackedVertex>& GetPackedMeshletVertices() const; // Packed format only
+	const PositionDequantization& GetPositionDequantization() const;
+	const std::vector<uint8_t>& GetMeshletTriangles() const;
 	const Matrix& GetWorld() const;
 	D3D11_PRIMITIVE_TOPOLOGY GetTopology() const;
+	const BoundingBox& GetWorldBounds() const;
+	const BoundingSphere& GetWorldSphere() const;
+	const BoundingBox& GetLocalBounds() const;
 
 	const Texture& GetDiffuseMap() const;
 	const Texture& GetNormalMap() const;
@@ -62,9 +123,54 @@ private:
 	Matrix m_WorldMatrix{ Matrix::CreateIdentity() };
 	//
 
+	// BOUNDS: local ones are fixed at load, world ones follow the world matrix
+	BoundingBox m_LocalBounds{};
+	BoundingSphere m_LocalSphere{};
+	BoundingBox m_WorldBounds{};
+	BoundingSphere m_WorldSphere{};
+	uint32_t m_WorldVersion{};
+	void UpdateWorldBounds();
+	//
+
+	// INSTANCING: bounds are around every instance, in the space the world matrix transforms
+	std::vector<Matrix> m_InstanceWorlds{};
+	BoundingBox m_InstancesBounds{};
+	BoundingSphere m_InstancesSphere{};
+	//
+
+	// LEVELS OF DETAIL: simplified at load, each level half the triangles of the one before, 0 is the full mesh
+	std::vector<IndexRange> m_Lods{};
+	uint8_t m_Lod{};						  // When not instanced
+	std::vector<uint8_t> m_InstanceLods{};	  // Per instance
+	std::vector<UINT> m_LodFirstInstances{}; // Instances are uploaded grouped by LOD, one more entry than m_Lods
+	void BuildLods( const std::vector<Vertex>& vertices );
+	uint8_t SelectLod( const BoundingSphere& sphere, const Vector3& cameraPosition, float tanHalfFov, uint8_t lod ) const;
+	void UpdateLodFirstInstances();
+	//
+
+	// MESHLETS: every LOD split separately, culled by the software pipeline before projecting
+	std::vector<Meshlet> m_Meshlets{};
+	std::vector<MeshletRange> m_LodMeshlets{};
+	VertexStreams m_MeshletVertexStreams{}; // Vertices shared between meshlets are repeated
+	std::vector<PackedVertex> m_PackedMeshletVertices{}; // Instead of the streams when packed
+	std::vector<uint8_t> m_MeshletTriangles{};
+	void BuildLodMeshlets( const std::vector<Vertex>& vertices );
+	//
+
+	// VERTEX FORMAT: packed meshes upload PackedVertex and keep their meshlet vertices packed too
+	VertexFormat m_VertexFormat{ VertexFormat::full };
+	PositionDequantization m_PositionDequantization{}; // Spans the local bounds
+	DXGI_FORMAT m_IndexFormat{ DXGI_FORMAT_R32_UINT };	// 16-bit whenever every vertex is reachable with it
+	//
+
 	// HARDWARE RESOURCES: OWNING
 	ID3D11Buffer* m_pVertexBuffer{};
 	ID3D11Buffer* m_pIndexBuffer{};
+	// GPU copy of m_InstanceWorlds grouped by LOD, only grows, uploaded by Draw when the instances changed
+	mutable ID3D11Buffer* m_pInstanceBuffer{};
+	mutable UINT m_InstanceBufferCapacity{};
+	mutable bool m_IsInstanceBufferDirty{ false };
+	void UploadInstances( ID3D11DeviceContext* pDeviceContext ) const;
 	Effect m_Effect{};
 	Texture m_DiffuseMap{};
 	Texture m_NormalMap{};
@@ -74,6 +180,7 @@ private:
 
 	// For software rendering
 	std::vector<Vertex> m_Vertices{};
+	VertexStreams m_VertexStreams{}; // Same vertices, split per attribute for batch projection
 	std::vector<UINT> m_Indices{};
 	//
 };
@@ -82,6 +189,10 @@ class TransparentMesh final // no inheritance because transparent meshes have to
 {
 public:
 	TransparentMesh() = default;
+	// Geometry only like the Mesh one, FinishLoading has to follow before the mesh is drawn
+	TransparentMesh( const std::vector<Vertex>& vertices,
+					 const std::vector<UINT>& indices,
+					 D3D11_PRIMITIVE_TOPOLOGY topology );
 	TransparentMesh( ID3D11Device* pDevice,
 					 const std::vector<Vertex>& vertices,
 					 const std::vector<UINT>& indices,
@@ -98,13 +209,17 @@ public:
 	~TransparentMesh() noexcept;
 
 	// Methods
+	void FinishLoading( ID3D11Device* pDevice, const std::wstring& effectPath ); // See Mesh
 	void Draw( ID3D11DeviceContext* pDeviceContext ) const;
 	void CycleFilteringMode();
+	void SetFilteringMode( FilterMode filterMode );
 	void ApplyMatrix( const Matrix& action );
+	bool IsVisible( const Frustum& frustum ) const; // Conservative, false only when fully outside
 
 	// Setters
 	void SetWorldViewProjection( const Matrix& v, const Matrix& p );
 	void SetWorld( const Matrix& w );
+	void SetDiffuseMap( ID3D11Device* pDevice, Texture&& texture ); // See Mesh::SetMap
 
 	// Getters
 	ID3D11Buffer* GetVertexBufferPtr() const;
@@ -112,6 +227,17 @@ public:
 	TransparentEffect* GetEffectPtr();
 	uint32_t GetVertexCount() const;
 	uint32_t GetIndexCount() const;
+	const BoundingBox& GetWorldBounds() const;
+	const BoundingSphere& GetWorldSphere() const;
+	uint32_t GetWorldVersion() const; // Changes whenever the world matrix does
+
+	// For software
+	const VertexStreams& GetVertexStreams() const;
+	const std::vector<UINT>& GetIndices() const;
+	const Matrix& GetWorld() const;
+	D3D11_PRIMITIVE_TOPOLOGY GetTopology() const;
+	const Texture& GetDiffuseMap() const;
+	//
 
 private:
 	// SOFTWARE RESOURCES
@@ -120,12 +246,26 @@ private:
 	D3D11_PRIMITIVE_TOPOLOGY m_Topology{};
 	Matrix m_WorldMatrix{ Matrix::CreateIdentity() };
 
+	// BOUNDS: local ones are fixed at load, world ones follow the world matrix
+	BoundingBox m_LocalBounds{};
+	BoundingSphere m_LocalSphere{};
+	BoundingBox m_WorldBounds{};
+	BoundingSphere m_WorldSphere{};
+	uint32_t m_WorldVersion{};
+	void UpdateWorldBounds();
+	//
+
 	// HARDWARE RESOURCES: OWNING
 	ID3D11Buffer* m_pVertexBuffer{};
 	ID3D11Buffer* m_pIndexBuffer{};
 	TransparentEffect m_Effect{};
 	Texture m_DiffuseMap{};
 	//
+
+	// For software rendering
+	VertexStreams m_VertexStreams{};
+	std::vector<UINT> m_Indices{};
+	//
 };
 }; // namespace dae
 #endif
@@ -0,0 +1,431 @@
+#include "MeshSimplification.h"
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <queue>
+#include <unordered_map>
+
+namespace dae
+{
+namespace
+{
+// Symmetric 4x4 matrix summing squared distances to planes, doubles because the sums cancel badly in float
+struct Quadric final
+{
+	double xx{}, xy{}, xz{}, xw{};
+	double yy{}, yz{}, yw{};
+	double zz{}, zw{};
+	double ww{};
+
+	static Quadric FromPlane( const Vector3& normal, float distance, double weight )
+	{
+		const double a{ normal.x }, b{ normal.y }, c{ normal.z }, d{ distance };
+		return { a * a * weight, a * b * weight, a * c * weight, a * d * weight, b * b * weight,
+				 b * c * weight, b * d * weight, c * c * weight, c * d * weight, d * d * weight };
+	}
+
+	Quadric& operator+=( const Quadric& rhs )
+	{
+		xx += rhs.xx, xy += rhs.xy, xz += rhs.xz, xw += rhs.xw;
+		yy += rhs.yy, yz += rhs.yz, yw += rhs.yw;
+		zz += rhs.zz, zw += rhs.zw;
+		ww += rhs.ww;
+		return *this;
+	}
+
+	double Evaluate( const Vector3& point ) const
+	{
+		const double x{ point.x }, y{ point.y }, z{ point.z };
+		return x * x * xx + 2 * x * y * xy + 2 * x * z * xz + 2 * x * xw + y * y * yy + 2 * y * z * yz + 2 * y * yw +
+			   z * z * zz + 2 * z * zw + ww;
+	}
+};
+
+// Open edges get a plane standing on them, weighted like this many faces, so the outline of the mesh holds
+constexpr double boundaryWeight{ 10.0 };
+
+struct Collapse final
+{
+	double cost{};
+	uint32_t from{};
+	uint32_t to{};
+	uint32_t fromVersion{};
+	uint32_t toVersion{};
+
+	bool operator>( const Collapse& rhs ) const
+	{
+		return cost > rhs.cost;
+	}
+};
+
+struct PositionHash final
+{
+	size_t operator()( const Vector3& position ) const
+	{
+		std::array<uint32_t, 3> bits{};
+		std::memcpy( bits.data(), &position.x, sizeof( float ) );
+		std::memcpy( bits.data() + 1, &position.y, sizeof( float ) );
+		std::memcpy( bits.data() + 2, &position.z, sizeof( float ) );
+		return ( bits[0] * 73856093u ) ^ ( bits[1] * 19349663u ) ^ ( bits[2] * 83492791u );
+	}
+};
+
+struct PositionEqual final
+{
+	bool operator()( const Vector3& lhs, const Vector3& rhs ) const
+	{
+		return lhs.x == rhs.x && lhs.y == rhs.y && lhs.z == rhs.z;
+	}
+};
+
+uint64_t GetEdgeKey( uint32_t first, uint32_t second )
+{
+	return first < second ? static_cast<uint64_t>( first ) << 32 | second : static_cast<uint64_t>( second ) << 32 | first;
+}
+
+// Positions are welded into groups, the collapses and the topology work on groups
+// Triangles keep their original vertices so every corner can pick the vertex of its group that fits it best
+class Simplifier final
+{
+public:
+	Simplifier( const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices )
+		: m_Vertices( vertices )
+	{
+		WeldPositions();
+		BuildTriangles( indices );
+		BuildQuadrics();
+		QueueAllEdges();
+	}
+
+	void CollapseUntil( size_t triangleCount )
+	{
+		while ( m_LiveTriangleCount > triangleCount && !m_Collapses.empty() )
+		{
+			const Collapse collapse{ m_Collapses.top() };
+			m_Collapses.pop();
+
+			// Either end changed since this was queued, a fresh entry is further down the queue
+			if ( m_IsGroupRemoved[collapse.from] || m_IsGroupRemoved[collapse.to] ||
+				 m_GroupVersions[collapse.from] != collapse.fromVersion ||
+				 m_GroupVersions[collapse.to] != collapse.toVersion )
+			{
+				continue;
+			}
+
+			if ( FoldsOver( collapse.from, collapse.to ) )
+			{
+				continue;
+			}
+
+			Apply( collapse.from, collapse.to );
+		}
+	}
+
+	std::vector<uint32_t> GetIndices() const
+	{
+		std::vector<uint32_t> indices{};
+		indices.reserve( m_LiveTriangleCount * 3 );
+		for ( const Triangle& triangle : m_Triangles )
+		{
+			if ( triangle.isRemoved )
+			{
+				continue;
+			}
+
+			for ( int cornerIdx{}; cornerIdx < 3; ++cornerIdx )
+			{
+				indices.push_back( GetCornerVertex( triangle.vertices[cornerIdx], triangle.groups[cornerIdx] ) );
+			}
+		}
+		return indices;
+	}
+
+	size_t GetLiveTriangleCount() const
+	{
+		return m_LiveTriangleCount;
+	}
+
+private:
+	struct Triangle final
+	{
+		std::array<uint32_t, 3> vertices{};
+		std::array<uint32_t, 3> groups{};
+		bool isRemoved{};
+	};
+
+	const std::vector<Vertex>& m_Vertices;
+
+	std::vector<uint32_t> m_VertexGroups{};
+	std::vector<Vector3> m_GroupPositions{};
+	std::vector<std::vector<uint32_t>> m_GroupVertices{};
+	std::vector<std::vector<uint32_t>> m_GroupTriangles{}; // May still list removed triangles
+	std::vector<Quadric> m_GroupQuadrics{};
+	std::vector<uint32_t> m_GroupVersions{};
+	std::vector<bool> m_IsGroupRemoved{};
+
+	std::vector<Triangle> m_Triangles{};
+	size_t m_LiveTriangleCount{};
+
+	std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> m_Collapses{};
+
+	void WeldPositions()
+	{
+		std::unordered_map<Vector3, uint32_t, PositionHash, PositionEqual> positionGroups{};
+		m_VertexGroups.resize( m_Vertices.size() );
+		for ( uint32_t vertexIdx{}; vertexIdx < m_Vertices.size(); ++vertexIdx )
+		{
+			const Vector3& position{ m_Vertices[vertexIdx].position };
+			const auto [it, isNew]{ positionGroups.try_emplace( position,
+																static_cast<uint32_t>( m_GroupPositions.size() ) ) };
+			if ( isNew )
+			{
+				m_GroupPositions.push_back( position );
+				m_GroupVertices.emplace_back();
+			}
+			m_VertexGroups[vertexIdx] = it->second;
+			m_GroupVertices[it->second].push_back( vertexIdx );
+		}
+
+		const size_t groupCount{ m_GroupPositions.size() };
+		m_GroupTriangles.resize( groupCount );
+		m_GroupQuadrics.resize( groupCount );
+		m_GroupVersions.resize( groupCount );
+		m_IsGroupRemoved.resize( groupCount );
+	}
+
+	void BuildTriangles( const std::vector<uint32_t>& indices )
+	{
+		m_Triangles.reserve( indices.size() / 3 );
+		for ( size_t index{}; index + 2 < indices.size(); index += 3 )
+		{
+			Triangle triangle{ { indices[index], indices[index + 1], indices[index + 2] } };
+			for ( int cornerIdx{}; cornerIdx < 3; ++cornerIdx )
+			{
+				triangle.groups[cornerIdx] = m_VertexGroups[triangle.vertices[cornerIdx]];
+			}
+
+			// Already degenerate after welding, would only get in the way
+			if ( triangle.groups[0] == triangle.groups[1] || triangle.groups[1] == triangle.groups[2] ||
+				 triangle.groups[0] == triangle.groups[2] )
+			{
+				continue;
+			}
+
+			const uint32_t triangleIdx{ static_cast<uint32_t>( m_Triangles.size() ) };
+			for ( const uint32_t group : triangle.groups )
+			{
+				m_GroupTriangles[group].push_back( triangleIdx );
+			}
+			m_Triangles.push_back( triangle );
+		}
+		m_LiveTriangleCount = m_Triangles.size();
+	}
+
+	Vector3 GetNormal( const std::array<uint32_t, 3>& groups ) const // Not normalized, length is twice the area
+	{
+		const Vector3& p0{ m_GroupPositions[groups[0]] };
+		return Vector3::Cross( m_GroupPositions[groups[1]] - p0, m_GroupPositions[groups[2]] - p0 );
+	}
+
+	void BuildQuadrics()
+	{
+		std::unordered_map<uint64_t, uint32_t> edgeTriangleCounts{};
+		for ( const Triangle& triangle : m_Triangles )
+		{
+			// Area weighted, so slivers barely pull on the result
+			const Vector3 areaNormal{ GetNormal( triangle.groups ) };
+			const float doubleArea{ areaNormal.Magnitude() };
+			if ( doubleArea <= 0.f )
+			{
+				continue;
+			}
+
+			const Vector3 normal{ areaNormal / doubleArea };
+			const Quadric quadric{ Quadric::FromPlane(
+				normal, -Vector3::Dot( normal, m_GroupPositions[triangle.groups[0]] ), 0.5 * doubleArea ) };
+			for ( const uint32_t group : triangle.groups )
+			{
+				m_GroupQuadrics[group] += quadric;
+			}
+
+			for ( int cornerIdx{}; cornerIdx < 3; ++cornerIdx )
+			{
+				++edgeTriangleCounts[GetEdgeKey( triangle.groups[cornerIdx], triangle.groups[( cornerIdx + 1 ) % 3] )];
+			}
+		}
+
+		for ( const Triangle& triangle : m_Triangles )
+		{
+			const Vector3 faceNormal{ GetNormal( triangle.groups ).Normalized() };
+			for ( int cornerIdx{}; cornerIdx < 3; ++cornerIdx )
+			{
+				const uint32_t start{ triangle.groups[cornerIdx] };
+				const uint32_t end{ triangle.groups[( cornerIdx + 1 ) % 3] };
+				if ( edgeTriangleCounts[GetEdgeKey( start, end )] != 1 )
+				{
+					continue;
+				}
+
+				const Vector3 edge{ m_GroupPositions[end] - m_GroupPositions[start] };
+				const Vector3 planeNormal{ Vector3::Cross( edge, faceNormal ).Normalized() };
+				const Quadric quadric{ Quadric::FromPlane( planeNormal,
+														   -Vector3::Dot( planeNormal, m_GroupPositions[start] ),
+														   boundaryWeight * edge.SqrMagnitude() ) };
+				m_GroupQuadrics[start] += quadric;
+				m_GroupQuadrics[end] += quadric;
+			}
+		}
+	}
+
+	void QueueAllEdges()
+	{
+		for ( const Triangle& triangle : m_Triangles )
+		{
+			for ( int cornerIdx{}; cornerIdx < 3; ++cornerIdx )
+			{
+				// Every interior edge shows up twice, the cheaper direction is queued both times and one goes stale
+				QueueEdge( triangle.groups[cornerIdx], triangle.groups[( cornerIdx + 1 ) % 3] );
+			}
+		}
+	}
+
+	void QueueEdge( uint32_t first, uint32_t second )
+	{
+		Quadric combined{ m_GroupQuadrics[first] };
+		combined += m_GroupQuadrics[second];
+		const double firstToSecondCost{ combined.Evaluate( m_GroupPositions[second] ) };
+		const double secondToFirstCost{ combined.Evaluate( m_GroupPositions[first] ) };
+
+		const bool isFirstRemoved{ firstToSecondCost <= secondToFirstCost };
+		const uint32_t from{ isFirstRemoved ? first : second };
+		const uint32_t to{ isFirstRemoved ? second : first };
+		m_Collapses.push( { isFirstRemoved ? firstToSecondCost : secondToFirstCost,
+							from,
+							to,
+							m_GroupVersions[from],
+							m_GroupVersions[to] } );
+	}
+
+	// Moving from onto to would turn a surviving triangle around or squash it flat
+	bool FoldsOver( uint32_t from, uint32_t to ) const
+	{
+		for ( const uint32_t triangleIdx : m_GroupTriangles[from] )
+		{
+			const Triangle& triangle{ m_Triangles[triangleIdx] };
+			if ( triangle.isRemoved || Contains( triangle, to ) )
+			{
+				continue;
+			}
+
+			std::array<uint32_t, 3> movedGroups{ triangle.groups };
+			for ( uint32_t& group : movedGroups )
+			{
+				group = group == from ? to : group;
+			}
+
+			const Vector3 oldNormal{ GetNormal( triangle.groups ) };
+			const Vector3 newNormal{ GetNormal( movedGroups ) };
+			if ( Vector3::Dot( oldNormal, newNormal ) <= 0.f )
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	static bool Contains( const Triangle& triangle, uint32_t group )
+	{
+		return triangle.groups[0] == group || triangle.groups[1] == group || triangle.groups[2] == group;
+	}
+
+	void Apply( uint32_t from, uint32_t to )
+	{
+		for ( const uint32_t triangleIdx : m_GroupTriangles[from] )
+		{
+			Triangle& triangle{ m_Triangles[triangleIdx] };
+			if ( triangle.isRemoved )
+			{
+				continue;
+			}
+
+			// Triangles on the collapsed edge vanish, the rest follow the moved corner
+			if ( Contains( triangle, to ) )
+			{
+				triangle.isRemoved = true;
+				--m_LiveTriangleCount;
+				continue;
+			}
+
+			for ( uint32_t& group : triangle.groups )
+			{
+				group = group == from ? to : group;
+			}
+			m_GroupTriangles[to].push_back( triangleIdx );
+		}
+
+		m_IsGroupRemoved[from] = true;
+		m_GroupTriangles[from].clear();
+		m_GroupQuadrics[to] += m_GroupQuadrics[from];
+		++m_GroupVersions[to];
+
+		// Compact the surviving group and requeue every edge around it with its new quadric
+		std::vector<uint32_t>& triangles{ m_GroupTriangles[to] };
+		std::erase_if( triangles, [&]( uint32_t triangleIdx ) { return m_Triangles[triangleIdx].isRemoved; } );
+		for ( const uint32_t triangleIdx : triangles )
+		{
+			for ( const uint32_t group : m_Triangles[triangleIdx].groups )
+			{
+				if ( group != to )
+				{
+					QueueEdge( to, group );
+				}
+			}
+		}
+	}
+
+	// The original vertex if it survived, otherwise the vertex of the group with the closest UV, then normal
+	uint32_t GetCornerVertex( uint32_t originalVertex, uint32_t group ) const
+	{
+		if ( m_VertexGroups[originalVertex] == group )
+		{
+			return originalVertex;
+		}
+
+		const Vertex& original{ m_Vertices[originalVertex] };
+		uint32_t bestVertex{ m_GroupVertices[group].front() };
+		float bestDistance{ std::numeric_limits<float>::max() };
+		for ( const uint32_t vertexIdx : m_GroupVertices[group] )
+		{
+			const Vertex& candidate{ m_Vertices[vertexIdx] };
+			const float distance{ ( candidate.uv - original.uv ).SqrMagnitude() -
+								  1e-3f * Vector3::Dot( candidate.normal, original.normal ) };
+			if ( distance < bestDistance )
+			{
+				bestDistance = distance;
+				bestVertex = vertexIdx;
+			}
+		}
+		return bestVertex;
+	}
+};
+} // namespace
+
+std::vector<std::vector<uint32_t>> BuildLodChain( const std::vector<Vertex>& vertices,
+												  const std::vector<uint32_t>& indices,
+												  const std::vector<float>& triangleFractions )
+{
+	Simplifier simplifier{ vertices, indices };
+	const size_t triangleCount{ simplifier.GetLiveTriangleCount() };
+
+	// One pass down to the smallest level, the others are snapshots on the way
+	std::vector<std::vector<uint32_t>> levels{};
+	levels.reserve( triangleFractions.size() );
+	for ( const float triangleFraction : triangleFractions )
+	{
+		simplifier.CollapseUntil( static_cast<size_t>( triangleCount * triangleFraction ) );
+		levels.push_back( simplifier.GetIndices() );
+	}
+	return levels;
+}
+} // namespace dae
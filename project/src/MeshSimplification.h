@@ -0,0 +1,19 @@
+#ifndef MESHSIMPLIFICATION_H
+#define MESHSIMPLIFICATION_H
+#include <cstdint>
+#include <vector>
+#include "Structs.h"
+
+// Quadric error metric simplification for generating mesh LODs at load time
+// Collapses edges onto existing vertices, so every level indexes the original vertex buffer
+
+namespace dae
+{
+// One index list per entry of triangleFractions, each a fraction of the input triangle count, largest first
+// Vertices sharing a position collapse together, so seams in the UVs or normals never open up
+// A level ends up larger than asked when every collapse left would fold a triangle over
+std::vector<std::vector<uint32_t>> BuildLodChain( const std::vector<Vertex>& vertices,
+												  const std::vector<uint32_t>& indices,
+												  const std::vector<float>& triangleFractions );
+} // namespace dae
+#endif
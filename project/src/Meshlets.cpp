@@ -0,0 +1,435 @@
+#include "Meshlets.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <tuple>
+
+namespace dae
+{
+namespace
+{
+// How much a candidate triangle turning away from the meshlet costs, in new vertices
+// Tight cones are what lets whole meshlets go, so this outweighs adding a vertex
+constexpr float facingWeight{ 4.f };
+// How much a candidate lying away from the meshlet center costs, in new vertices per average edge length
+constexpr float distanceWeight{ 0.5f };
+// Cones wider than this (dot product between the axis and the furthest triangle) can never be backfacing
+constexpr float minConeSpread{ 0.1f };
+// Triangles turned further than this from the meshlet (cosine, about 18 degrees) start a new one
+// The vehicle has hard edges everywhere, wider cones would leave most meshlets facing the camera somewhere
+constexpr float minTriangleFacing{ 0.95f };
+
+constexpr uint8_t notInMeshlet{ 0xff };
+
+// Group number of every vertex, vertices comparing equal share one
+template <typename Less>
+std::vector<uint32_t> GroupVertices( size_t vertexCount, Less less )
+{
+	std::vector<uint32_t> order( vertexCount );
+	std::iota( order.begin(), order.end(), 0 );
+	std::sort( order.begin(), order.end(), less );
+
+	std::vector<uint32_t> groups( vertexCount );
+	uint32_t group{};
+	for ( size_t orderIdx{}; orderIdx < order.size(); ++orderIdx )
+	{
+		if ( orderIdx && less( order[orderIdx - 1], order[orderIdx] ) )
+		{
+			++group;
+		}
+		groups[order[orderIdx]] = group;
+	}
+	return groups;
+}
+
+// Grows one meshlet at a time from a seed triangle, always adding the neighbour that keeps it smallest and flattest
+// Exact vertex copies share a slot in a meshlet, equal positions make triangles neighbours
+class MeshletBuilder final
+{
+public:
+	MeshletBuilder( const std::vector<Vertex>& vertices,
+					const std::vector<uint32_t>& indices,
+					size_t firstIndex,
+					size_t indexCount )
+		: m_Vertices( vertices )
+		, m_Corners( indices.begin() + firstIndex, indices.begin() + firstIndex + indexCount )
+	{
+		const size_t triangleCount{ m_Corners.size() / 3 };
+		m_Corners.resize( triangleCount * 3 );
+
+		BuildSlots();
+		BuildAdjacency();
+		BuildTriangleShapes();
+
+		m_IsTriangleUsed.assign( triangleCount, false );
+		m_CandidateStamps.assign( triangleCount, 0 );
+	}
+
+	void Build( std::vector<Meshlet>& meshlets, std::vector<Vertex>& meshletVertices, std::vector<uint8_t>& meshletTriangles )
+	{
+		const uint32_t triangleCount{ static_cast<uint32_t>( m_IsTriangleUsed.size() ) };
+		uint32_t nextSeed{};
+		while ( true )
+		{
+			// Continue from where the last meshlet stopped growing, so leftovers do not end up scattered
+			uint32_t seed{ PopUnusedCandidate() };
+			if ( seed == noTriangle )
+			{
+				while ( nextSeed < triangleCount && m_IsTriangleUsed[nextSeed] )
+				{
+					++nextSeed;
+				}
+				if ( nextSeed == triangleCount )
+				{
+					break;
+				}
+				seed = nextSeed;
+			}
+
+			++m_MeshletStamp;
+			m_Candidates.clear();
+			AddTriangle( seed );
+			for ( uint32_t triangle{ PickCandidate() }; triangle != noTriangle; triangle = PickCandidate() )
+			{
+				AddTriangle( triangle );
+			}
+			FinishMeshlet( meshlets, meshletVertices, meshletTriangles );
+		}
+	}
+
+private:
+	static constexpr uint32_t noTriangle{ std::numeric_limits<uint32_t>::max() };
+
+	const std::vector<Vertex>& m_Vertices;
+	std::vector<uint32_t> m_Corners{}; // Three vertex indices per triangle
+
+	// Per corner
+	std::vector<uint32_t> m_CornerSlots{};	   // Exact copy group
+	std::vector<uint32_t> m_CornerPositions{}; // Position group
+
+	// Triangles touching every position group, packed
+	std::vector<uint32_t> m_PositionTriangleStarts{};
+	std::vector<uint32_t> m_PositionTriangles{};
+
+	// Per triangle, in model space
+	std::vector<Vector3> m_Normals{}; // Unit front facing, zero for degenerate triangles
+	std::vector<Vector3> m_Centroids{};
+	float m_AverageEdgeLength{ 1.f };
+
+	std::vector<bool> m_IsTriangleUsed{};
+	std::vector<uint32_t> m_CandidateStamps{}; // Meshlet that last queued the triangle
+
+	// Meshlet being built
+	uint32_t m_MeshletStamp{};
+	std::vector<uint8_t> m_LocalSlots{}; // Per slot, its vertex in the meshlet
+	std::vector<uint32_t> m_LocalVertices{};
+	std::vector<uint32_t> m_LocalSlotList{};
+	std::vector<uint8_t> m_LocalTriangles{};
+	std::vector<uint32_t> m_Triangles{};
+	std::vector<uint32_t> m_Candidates{};
+	Vector3 m_NormalSum{};
+	Vector3 m_CentroidSum{};
+
+	void BuildSlots()
+	{
+		m_CornerSlots.resize( m_Corners.size() );
+		m_CornerPositions.resize( m_Corners.size() );
+
+		const std::vector<uint32_t> slots{ GroupVertices( m_Vertices.size(), [&]( uint32_t lhs, uint32_t rhs ) {
+			return std::memcmp( &m_Vertices[lhs], &m_Vertices[rhs], sizeof( Vertex ) ) < 0;
+		} ) };
+		const std::vector<uint32_t> positions{ GroupVertices( m_Vertices.size(), [&]( uint32_t lhs, uint32_t rhs ) {
+			const Vector3& lhsPosition{ m_Vertices[lhs].position };
+			const Vector3& rhsPosition{ m_Vertices[rhs].position };
+			return std::tie( lhsPosition.x, lhsPosition.y, lhsPosition.z ) <
+				   std::tie( rhsPosition.x, rhsPosition.y, rhsPosition.z );
+		} ) };
+
+		for ( size_t cornerIdx{}; cornerIdx < m_Corners.size(); ++cornerIdx )
+		{
+			m_CornerSlots[cornerIdx] = slots[m_Corners[cornerIdx]];
+			m_CornerPositions[cornerIdx] = positions[m_Corners[cornerIdx]];
+		}
+		m_LocalSlots.assign( m_Vertices.size(), notInMeshlet );
+	}
+
+	void BuildAdjacency()
+	{
+		const uint32_t positionCount{ m_CornerPositions.empty()
+										  ? 0
+										  : *std::max_element( m_CornerPositions.begin(), m_CornerPositions.end() ) + 1 };
+
+		// Counts -> start offsets, one past the end so every group is a range
+		m_PositionTriangleStarts.assign( positionCount + 1, 0 );
+		for ( const uint32_t position : m_CornerPositions )
+		{
+			++m_PositionTriangleStarts[position + 1];
+		}
+		std::partial_sum(
+			m_PositionTriangleStarts.begin(), m_PositionTriangleStarts.end(), m_PositionTriangleStarts.begin() );
+
+		std::vector<uint32_t> fillOffsets( m_PositionTriangleStarts.begin(), m_PositionTriangleStarts.end() - 1 );
+		m_PositionTriangles.resize( m_CornerPositions.size() );
+		for ( size_t cornerIdx{}; cornerIdx < m_CornerPositions.size(); ++cornerIdx )
+		{
+			m_PositionTriangles[fillOffsets[m_CornerPositions[cornerIdx]]++] = static_cast<uint32_t>( cornerIdx / 3 );
+		}
+	}
+
+	void BuildTriangleShapes()
+	{
+		const size_t triangleCount{ m_Corners.size() / 3 };
+		m_Normals.resize( triangleCount );
+		m_Centroids.resize( triangleCount );
+
+		double edgeLengthSum{};
+		for ( size_t triangleIdx{}; triangleIdx < triangleCount; ++triangleIdx )
+		{
+			const Vector3& p0{ m_Vertices[m_Corners[triangleIdx * 3 + 0]].position };
+			const Vector3& p1{ m_Vertices[m_Corners[triangleIdx * 3 + 1]].position };
+			const Vector3& p2{ m_Vertices[m_Corners[triangleIdx * 3 + 2]].position };
+
+			// Same winding the rasterizer keeps
+			const Vector3 normal{ Vector3::Cross( p1 - p0, p2 - p0 ) };
+			const float length{ normal.Magnitude() };
+			m_Normals[triangleIdx] = length > 0.f ? normal / length : Vector3{};
+			m_Centroids[triangleIdx] = ( p0 + p1 + p2 ) / 3.f;
+
+			edgeLengthSum += ( p1 - p0 ).Magnitude() + ( p2 - p1 ).Magnitude() + ( p0 - p2 ).Magnitude();
+		}
+
+		if ( edgeLengthSum > 0.0 )
+		{
+			m_AverageEdgeLength = static_cast<float>( edgeLengthSum / ( triangleCount * 3 ) );
+		}
+	}
+
+	int CountNewVertices( uint32_t triangle ) const
+	{
+		const uint32_t* pSlots{ &m_CornerSlots[triangle * 3] };
+		int newCount{};
+		for ( int cornerIdx{}; cornerIdx < 3; ++cornerIdx )
+		{
+			// A slot repeated within the triangle only counts once
+			const bool isRepeat{ ( cornerIdx > 0 && pSlots[cornerIdx] == pSlots[0] ) ||
+								 ( cornerIdx > 1 && pSlots[cornerIdx] == pSlots[1] ) };
+			if ( !isRepeat && m_LocalSlots[pSlots[cornerIdx]] == notInMeshlet )
+			{
+				++newCount;
+			}
+		}
+		return newCount;
+	}
+
+	// Cheapest queued triangle that still fits, noTriangle when none does
+	uint32_t PickCandidate()
+	{
+		if ( m_Triangles.size() == maxMeshletTriangles )
+		{
+			return noTriangle;
+		}
+
+		const float normalSumLength{ m_NormalSum.Magnitude() };
+		const Vector3 axis{ normalSumLength > 0.f ? m_NormalSum / normalSumLength : Vector3{} };
+		const Vector3 center{ m_CentroidSum / static_cast<float>( m_Triangles.size() ) };
+
+		uint32_t bestTriangle{ noTriangle };
+		float bestScore{ std::numeric_limits<float>::max() };
+		for ( size_t candidateIdx{}; candidateIdx < m_Candidates.size(); )
+		{
+			const uint32_t triangle{ m_Candidates[candidateIdx] };
+			if ( m_IsTriangleUsed[triangle] )
+			{
+				m_Candidates[candidateIdx] = m_Candidates.back();
+				m_Candidates.pop_back();
+				continue;
+			}
+			++candidateIdx;
+
+			const int newVertexCount{ CountNewVertices( triangle ) };
+			if ( m_LocalVertices.size() + newVertexCount > maxMeshletVertices )
+			{
+				continue;
+			}
+
+			const float facing{ 1.f - Vector3::Dot( axis, m_Normals[triangle] ) };
+			if ( facing > 1.f - minTriangleFacing )
+			{
+				continue;
+			}
+			const float distance{ ( m_Centroids[triangle] - center ).Magnitude() / m_AverageEdgeLength };
+			const float score{ newVertexCount + facing * facingWeight + distance * distanceWeight };
+			if ( score < bestScore )
+			{
+				bestScore = score;
+				bestTriangle = triangle;
+			}
+		}
+		return bestTriangle;
+	}
+
+	uint32_t PopUnusedCandidate()
+	{
+		while ( !m_Candidates.empty() )
+		{
+			const uint32_t triangle{ m_Candidates.back() };
+			m_Candidates.pop_back();
+			if ( !m_IsTriangleUsed[triangle] )
+			{
+				return triangle;
+			}
+		}
+		return noTriangle;
+	}
+
+	void AddTriangle( uint32_t triangle )
+	{
+		m_IsTriangleUsed[triangle] = true;
+		m_Triangles.push_back( triangle );
+		m_NormalSum += m_Normals[triangle];
+		m_CentroidSum += m_Centroids[triangle];
+
+		for ( int cornerIdx{}; cornerIdx < 3; ++cornerIdx )
+		{
+			const uint32_t slot{ m_CornerSlots[triangle * 3 + cornerIdx] };
+			if ( m_LocalSlots[slot] == notInMeshlet )
+			{
+				m_LocalSlots[slot] = static_cast<uint8_t>( m_LocalVertices.size() );
+				m_LocalVertices.push_back( m_Corners[triangle * 3 + cornerIdx] );
+				m_LocalSlotList.push_back( slot );
+			}
+			m_LocalTriangles.push_back( m_LocalSlots[slot] );
+
+			// Everything touching this corner's position becomes a candidate
+			const uint32_t position{ m_CornerPositions[triangle * 3 + cornerIdx] };
+			for ( uint32_t neighbourIdx{ m_PositionTriangleStarts[position] };
+				  neighbourIdx < m_PositionTriangleStarts[position + 1];
+				  ++neighbourIdx )
+			{
+				const uint32_t neighbour{ m_PositionTriangles[neighbourIdx] };
+				if ( !m_IsTriangleUsed[neighbour] && m_CandidateStamps[neighbour] != m_MeshletStamp )
+				{
+					m_CandidateStamps[neighbour] = m_MeshletStamp;
+					m_Candidates.push_back( neighbour );
+				}
+			}
+		}
+	}
+
+	void FinishMeshlet( std::vector<Meshlet>& meshlets,
+						std::vector<Vertex>& meshletVertices,
+						std::vector<uint8_t>& meshletTriangles )
+	{
+		Meshlet meshlet{};
+		meshlet.firstVertex = static_cast<uint32_t>( meshletVertices.size() );
+		meshlet.firstTriangle = static_cast<uint32_t>( meshletTriangles.size() / 3 );
+		meshlet.vertexCount = static_cast<uint8_t>( m_LocalVertices.size() );
+		meshlet.triangleCount = static_cast<uint8_t>( m_Triangles.size() );
+
+		for ( const uint32_t vertex : m_LocalVertices )
+		{
+			meshletVertices.push_back( m_Vertices[vertex] );
+		}
+		meshletTriangles.insert( meshletTriangles.end(), m_LocalTriangles.begin(), m_LocalTriangles.end() );
+
+		const std::vector<Vertex> localVertices( meshletVertices.begin() + meshlet.firstVertex, meshletVertices.end() );
+		meshlet.sphere = BoundingSphere::FromVertices( localVertices );
+
+		// Cone around the average facing, as wide as the triangle furthest from it
+		const float normalSumLength{ m_NormalSum.Magnitude() };
+		if ( normalSumLength > 0.f )
+		{
+			const Vector3 axis{ m_NormalSum / normalSumLength };
+			float minDot{ 1.f };
+			for ( const uint32_t triangle : m_Triangles )
+			{
+				// Degenerate triangles never reach a pixel, whichever way they face
+				if ( m_Normals[triangle].SqrMagnitude() > 0.f )
+				{
+					minDot = std::min( minDot, Vector3::Dot( axis, m_Normals[triangle] ) );
+				}
+			}
+			if ( minDot > minConeSpread )
+			{
+				meshlet.coneAxis = axis;
+				meshlet.coneCutoff = std::sqrt( 1.f - minDot * minDot );
+			}
+		}
+		meshlets.push_back( meshlet );
+
+		// Reset the meshlet state, only touching the slots it used
+		for ( const uint32_t slot : m_LocalSlotList )
+		{
+			m_LocalSlots[slot] = notInMeshlet;
+		}
+		m_LocalSlotList.clear();
+		m_LocalVertices.clear();
+		m_LocalTriangles.clear();
+		m_Triangles.clear();
+		m_NormalSum = {};
+		m_CentroidSum = {};
+	}
+};
+} // namespace
+
+void BuildMeshlets( const std::vector<Vertex>& vertices,
+					const std::vector<uint32_t>& indices,
+					size_t firstIndex,
+					size_t indexCount,
+					std::vector<Meshlet>& meshlets,
+					std::vector<Vertex>& meshletVertices,
+					std::vector<uint8_t>& meshletTriangles )
+{
+	MeshletBuilder builder{ vertices, indices, firstIndex, indexCount };
+	builder.Build( meshlets, meshletVertices, meshletTriangles );
+}
+
+MeshletCullView MeshletCullView::Create( const Matrix& world,
+										 const Matrix& viewProjection,
+										 const Vector3& cameraPosition,
+										 const BoundingBox& localBounds )
+{
+	MeshletCullView view{};
+	view.frustum = Frustum::FromViewProjection( world * viewProjection );
+	view.cameraPosition = Matrix::Inverse( world ).TransformPoint( cameraPosition );
+	view.isInsideFrustum = view.frustum.Contains( localBounds );
+	return view;
+}
+
+bool IsMeshletCullable( const Meshlet& meshlet, const MeshletCullView& view )
+{
+	// Runs for thousands of meshlets per copy, so the vector math is spelled out instead of calling into Structs
+	const Vector3& center{ meshlet.sphere.center };
+	const float radius{ meshlet.sphere.radius };
+
+	// Every triangle faces away when the whole sphere sits inside the cone mirrored behind the camera
+	if ( meshlet.coneCutoff < 1.f )
+	{
+		const float toCenterX{ center.x - view.cameraPosition.x };
+		const float toCenterY{ center.y - view.cameraPosition.y };
+		const float toCenterZ{ center.z - view.cameraPosition.z };
+		const float distance{ std::sqrt( toCenterX * toCenterX + toCenterY * toCenterY + toCenterZ * toCenterZ ) };
+		const float alongAxis{ toCenterX * meshlet.coneAxis.x + toCenterY * meshlet.coneAxis.y +
+							   toCenterZ * meshlet.coneAxis.z };
+		if ( alongAxis >= meshlet.coneCutoff * distance + radius )
+		{
+			return true;
+		}
+	}
+
+	if ( view.isInsideFrustum )
+	{
+		return false;
+	}
+	for ( const Plane& plane : view.frustum.planes )
+	{
+		if ( plane.normal.x * center.x + plane.normal.y * center.y + plane.normal.z * center.z + plane.distance < -radius )
+		{
+			return true;
+		}
+	}
+	return false;
+}
+} // namespace dae
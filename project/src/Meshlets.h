@@ -0,0 +1,64 @@
+#ifndef MESHLETS_H
+#define MESHLETS_H
+#include <cstdint>
+#include <vector>
+#include "BoundingVolumes.h"
+
+// Meshlets are small clusters of neighbouring triangles with their own bounds and normal cone
+// The software pipeline culls them as a whole, before any of their vertices get projected
+
+namespace dae
+{
+constexpr size_t maxMeshletVertices{ 64 };
+constexpr size_t maxMeshletTriangles{ 124 };
+
+struct Meshlet final
+{
+	uint32_t firstVertex{};	  // Into the meshlet vertices, every meshlet has its own run
+	uint32_t firstTriangle{}; // Into the meshlet triangles, in triangles
+	uint8_t vertexCount{};
+	uint8_t triangleCount{};
+
+	// Model space
+	BoundingSphere sphere{};
+	Vector3 coneAxis{};		 // Average facing of the triangles
+	float coneCutoff{ 1.f }; // Sine of the widest angle between the axis and a triangle, 1 when the cone is useless
+};
+
+// Run of meshlets, one per LOD
+struct MeshletRange final
+{
+	uint32_t firstMeshlet{};
+	uint32_t meshletCount{};
+};
+
+// Appends meshlets for the triangle list in indices[firstIndex, firstIndex + indexCount)
+// Vertices are copied into meshletVertices, repeated for every meshlet using them
+// Three bytes per triangle go into meshletTriangles, each indexing the vertex run of its meshlet
+void BuildMeshlets( const std::vector<Vertex>& vertices,
+					const std::vector<uint32_t>& indices,
+					size_t firstIndex,
+					size_t indexCount,
+					std::vector<Meshlet>& meshlets,
+					std::vector<Vertex>& meshletVertices,
+					std::vector<uint8_t>& meshletTriangles );
+
+// The camera moved into the model space of one copy of a mesh, so its meshlets are tested as they are
+// Assumes the world matrix does not scale non-uniformly
+struct MeshletCullView final
+{
+	Frustum frustum{};
+	Vector3 cameraPosition{};
+	bool isInsideFrustum{}; // The whole mesh is, only the cones are worth testing
+
+	// localBounds are the mesh's own, before the world matrix
+	static MeshletCullView Create( const Matrix& world,
+								   const Matrix& viewProjection,
+								   const Vector3& cameraPosition,
+								   const BoundingBox& localBounds );
+};
+
+// True when the meshlet is outside the frustum or all of its triangles face away from the camera
+bool IsMeshletCullable( const Meshlet& meshlet, const MeshletCullView& view );
+} // namespace dae
+#endif
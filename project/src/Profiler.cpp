@@ -0,0 +1,203 @@
+#include "Profiler.h"
+#include <iostream>
+
+#ifdef ENABLE_PROFILING
+#	include <array>
+#	include <atomic>
+#	include <chrono>
+#	include <fstream>
+#	include <iomanip>
+#	include <memory>
+#	include <mutex>
+#	include <vector>
+#endif
+
+namespace dae
+{
+namespace profiler
+{
+#ifdef ENABLE_PROFILING
+namespace
+{
+// Fields are atomics because a dump can read the slot while its thread overwrites it
+// sequence is 2 * event index + 2 once the event is whole, odd while it is being written (a seqlock)
+struct ZoneEvent final
+{
+	std::atomic<uint64_t> sequence{};
+	std::atomic<const char*> name{};
+	std::atomic<int64_t> startNanoseconds{};
+	std::atomic<int64_t> endNanoseconds{};
+};
+
+// Single producer (the owning thread), read by whoever dumps
+// Oldest zones get overwritten once a thread records more than the capacity
+struct ThreadBuffer final
+{
+	static constexpr size_t capacity{ 1 << 16 };
+
+	uint32_t threadIndex{};
+	std::string threadName{};
+	std::array<ZoneEvent, capacity> events{};
+	std::atomic<uint64_t> writeCount{};
+};
+
+struct Registry final
+{
+	std::mutex mutex{}; // Only taken when a thread records its first zone and when dumping
+	std::vector<std::unique_ptr<ThreadBuffer>> buffers{};
+	const std::chrono::steady_clock::time_point epoch{ std::chrono::steady_clock::now() };
+};
+
+Registry& GetRegistry()
+{
+	static Registry registry{};
+	return registry;
+}
+
+ThreadBuffer& GetThreadBuffer()
+{
+	// Buffers are owned by the registry so zones of finished threads still end up in the dump
+	thread_local ThreadBuffer* pBuffer{ nullptr };
+	if ( !pBuffer )
+	{
+		Registry& registry{ GetRegistry() };
+		const std::lock_guard lock{ registry.mutex };
+
+		auto pNewBuffer{ std::make_unique<ThreadBuffer>() };
+		pNewBuffer->threadIndex = static_cast<uint32_t>( registry.buffers.size() );
+		pNewBuffer->threadName = "Thread " + std::to_string( pNewBuffer->threadIndex );
+		pBuffer = pNewBuffer.get();
+		registry.buffers.push_back( std::move( pNewBuffer ) );
+	}
+	return *pBuffer;
+}
+
+int64_t GetNanosecondsSinceEpoch()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() -
+																 GetRegistry().epoch )
+		.count();
+}
+
+void WriteEscaped( std::ofstream& file, const std::string& text )
+{
+	for ( const char character : text )
+	{
+		if ( character == '"' || character == '\\' )
+		{
+			file << '\\';
+		}
+		file << character;
+	}
+}
+} // namespace
+
+ScopedZone::ScopedZone( const char* name )
+	: m_Name{ name }
+	, m_StartNanoseconds{ GetNanosecondsSinceEpoch() }
+{
+}
+
+ScopedZone::~ScopedZone() noexcept
+{
+	ThreadBuffer& buffer{ GetThreadBuffer() };
+	const uint64_t writeCount{ buffer.writeCount.load( std::memory_order_relaxed ) };
+	const int64_t endNanoseconds{ GetNanosecondsSinceEpoch() };
+
+	// Relaxed stores are plain moves on x86, the fence orders the odd sequence before the fields
+	ZoneEvent& event{ buffer.events[writeCount % ThreadBuffer::capacity] };
+	event.sequence.store( 2 * writeCount + 1, std::memory_order_relaxed );
+	std::atomic_thread_fence( std::memory_order_release );
+	event.name.store( m_Name, std::memory_order_relaxed );
+	event.startNanoseconds.store( m_StartNanoseconds, std::memory_order_relaxed );
+	event.endNanoseconds.store( endNanoseconds, std::memory_order_relaxed );
+	event.sequence.store( 2 * writeCount + 2, std::memory_order_release );
+	buffer.writeCount.store( writeCount + 1, std::memory_order_release ); // Publish the event to the dumping thread
+}
+
+bool DumpChromeTrace( const std::string& path )
+{
+	std::ofstream file( path );
+	if ( !file )
+	{
+		std::cout << "Could not write trace to " << path << "\n";
+		return false;
+	}
+
+	Registry& registry{ GetRegistry() };
+	const std::lock_guard lock{ registry.mutex };
+
+	file << std::fixed << std::setprecision( 3 );
+	file << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+	bool isFirstEvent{ true };
+	auto beginEvent{ [&]() {
+		file << ( isFirstEvent ? "" : ",\n" );
+		isFirstEvent = false;
+	} };
+
+	size_t eventCount{};
+	for ( const auto& pBuffer : registry.buffers )
+	{
+		beginEvent();
+		file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << pBuffer->threadIndex
+			 << ",\"args\":{\"name\":\"";
+		WriteEscaped( file, pBuffer->threadName );
+		file << "\"}}";
+
+		// A thread still recording can overwrite a slot while it is read, the sequence check drops that event
+		const uint64_t writeCount{ pBuffer->writeCount.load( std::memory_order_acquire ) };
+		const uint64_t firstEvent{ writeCount > ThreadBuffer::capacity ? writeCount - ThreadBuffer::capacity : 0 };
+		for ( uint64_t eventIdx{ firstEvent }; eventIdx < writeCount; ++eventIdx )
+		{
+			const ZoneEvent& event{ pBuffer->events[eventIdx % ThreadBuffer::capacity] };
+			const uint64_t sequence{ 2 * eventIdx + 2 };
+			if ( event.sequence.load( std::memory_order_acquire ) != sequence )
+			{
+				continue;
+			}
+
+			const char* name{ event.name.load( std::memory_order_relaxed ) };
+			const int64_t startNanoseconds{ event.startNanoseconds.load( std::memory_order_relaxed ) };
+			const int64_t endNanoseconds{ event.endNanoseconds.load( std::memory_order_relaxed ) };
+			std::atomic_thread_fence( std::memory_order_acquire );
+			if ( event.sequence.load( std::memory_order_relaxed ) != sequence )
+			{
+				continue;
+			}
+
+			// Chrome expects microseconds, fractions keep the nanosecond resolution
+			beginEvent();
+			file << "{\"name\":\"";
+			WriteEscaped( file, name );
+			file << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << pBuffer->threadIndex
+				 << ",\"ts\":" << startNanoseconds / 1000.0
+				 << ",\"dur\":" << ( endNanoseconds - startNanoseconds ) / 1000.0 << "}";
+			++eventCount;
+		}
+	}
+	file << "\n]}\n";
+
+	std::cout << "Wrote " << eventCount << " zones to " << path << "\n";
+	return true;
+}
+
+void SetThreadName( const char* name )
+{
+	ThreadBuffer& buffer{ GetThreadBuffer() };
+
+	const std::lock_guard lock{ GetRegistry().mutex };
+	buffer.threadName = name;
+}
+#else
+bool DumpChromeTrace( const std::string& path )
+{
+	std::cout << "Profiling is compiled out, rebuild with ENABLE_PROFILING to write " << path << "\n";
+	return false;
+}
+
+void SetThreadName( const char* )
+{
+}
+#endif
+} // namespace profiler
+} // namespace dae
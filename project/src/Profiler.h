@@ -0,0 +1,52 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+// Scoped zone instrumentation for the hot paths, exported as Chrome trace-event JSON
+// Open the dump in chrome://tracing or https://ui.perfetto.dev
+//
+// Zones only exist when building with ENABLE_PROFILING, otherwise the macros expand to nothing
+// Every thread records into its own ring buffer -> no locks or allocations while recording
+#include <cstdint>
+#include <string>
+
+namespace dae
+{
+namespace profiler
+{
+// Writes all recorded zones of all threads, returns false if the file couldn't be written
+// or profiling is compiled out
+bool DumpChromeTrace( const std::string& path );
+
+// Names the track of the calling thread in the trace
+void SetThreadName( const char* name );
+
+#ifdef ENABLE_PROFILING
+class ScopedZone final
+{
+public:
+	explicit ScopedZone( const char* name ); // Name must outlive the profiler, use literals
+	~ScopedZone() noexcept;
+
+	ScopedZone( const ScopedZone& ) = delete;
+	ScopedZone( ScopedZone&& ) = delete;
+	ScopedZone& operator=( const ScopedZone& ) = delete;
+	ScopedZone& operator=( ScopedZone&& ) = delete;
+
+private:
+	const char* m_Name{};
+	int64_t m_StartNanoseconds{};
+};
+#endif
+} // namespace profiler
+} // namespace dae
+
+#ifdef ENABLE_PROFILING
+#	define PROFILE_CONCAT_INNER( a, b ) a##b
+#	define PROFILE_CONCAT( a, b ) PROFILE_CONCAT_INNER( a, b )
+#	define PROFILE_ZONE( name ) const dae::profiler::ScopedZone PROFILE_CONCAT( profileZone, __LINE__ ){ name }
+#	define PROFILE_FUNCTION() PROFILE_ZONE( __FUNCTION__ )
+#else
+#	define PROFILE_ZONE( name )
+#	define PROFILE_FUNCTION()
+#endif
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef RADIXSORT_H
+#define RADIXSORT_H
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Stable LSD radix sort shared by the per-frame draw and triangle orderings
+// Kept in a header so the key read inlines into every pass
+
+namespace dae
+{
+// Below this an insertion sort beats clearing and scanning the histograms
+constexpr size_t radixSortThreshold{ 256 };
+
+// Sorts items ascending on getKey( item ), an unsigned integer, equal keys keep their order
+// Bytes every key has in common are skipped, scratch is only there to keep its capacity between calls
+template <typename Item, typename GetKey>
+void RadixSort( std::vector<Item>& items, std::vector<Item>& scratch, GetKey getKey )
+{
+	using Key = std::invoke_result_t<GetKey, const Item&>;
+	static_assert( std::is_unsigned_v<Key>, "Radix sort keys have to be unsigned integers" );
+	constexpr int digitCount{ sizeof( Key ) };
+	constexpr int bucketCount{ 256 };
+
+	// Not std::stable_sort, that allocates its merge buffer on every call
+	if ( items.size() < radixSortThreshold )
+	{
+		for ( size_t itemIdx{ 1 }; itemIdx < items.size(); ++itemIdx )
+		{
+			const Item item{ items[itemIdx] };
+			const Key key{ getKey( item ) };
+			size_t insertIdx{ itemIdx };
+			for ( ; insertIdx > 0 && key < getKey( items[insertIdx - 1] ); --insertIdx )
+			{
+				items[insertIdx] = items[insertIdx - 1];
+			}
+			items[insertIdx] = item;
+		}
+		return;
+	}
+
+	auto getDigit{ []( Key key, int digitIdx ) {
+		return static_cast<uint32_t>( key >> ( digitIdx * 8 ) ) & 0xff;
+	} };
+
+	// Every histogram in a single read of the keys
+	std::array<std::array<uint32_t, bucketCount>, digitCount> histograms{};
+	for ( const Item& item : items )
+	{
+		const Key key{ getKey( item ) };
+		for ( int digitIdx{}; digitIdx < digitCount; ++digitIdx )
+		{
+			++histograms[digitIdx][getDigit( key, digitIdx )];
+		}
+	}
+
+	scratch.resize( items.size() );
+	for ( int digitIdx{}; digitIdx < digitCount; ++digitIdx )
+	{
+		std::array<uint32_t, bucketCount>& histogram{ histograms[digitIdx] };
+
+		// All keys share this byte, the pass would not move anything
+		if ( histogram[getDigit( getKey( items.front() ), digitIdx )] == items.size() )
+		{
+			continue;
+		}
+
+		// Counts -> start offsets
+		uint32_t offset{};
+		for ( uint32_t& bucket : histogram )
+		{
+			const uint32_t count{ bucket };
+			bucket = offset;
+			offset += count;
+		}
+
+		for ( const Item& item : items )
+		{
+			scratch[histogram[getDigit( getKey( item ), digitIdx )]++] = item;
+		}
+		std::swap( items, scratch );
+	}
+}
+} // namespace dae
+#endif
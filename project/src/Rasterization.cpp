@@ -0,0 +1,367 @@
+#include "Rasterization.h"
+#include <array>
+#include <cstring>
+#include <utility>
+
+// SSE2 is part of the x64 baseline
+#if defined( __SSE2__ ) || defined( _M_X64 ) || defined( _M_AMD64 )
+#	define RASTERIZATION_SIMD
+#	include <emmintrin.h>
+#endif
+
+namespace dae
+{
+int PixelRect::GetWidth() const noexcept
+{
+	return right - left;
+}
+
+bool PixelRect::IsEmpty() const noexcept
+{
+	return left >= right || top >= bottom;
+}
+
+bool PixelRect::Intersects( const PixelRect& other ) const noexcept
+{
+	return !Intersection( other ).IsEmpty();
+}
+
+PixelRect PixelRect::Union( const PixelRect& other ) const noexcept
+{
+	if ( IsEmpty() )
+	{
+		return other;
+	}
+	if ( other.IsEmpty() )
+	{
+		return *this;
+	}
+	return { left < other.left ? left : other.left,
+			 top < other.top ? top : other.top,
+			 right > other.right ? right : other.right,
+			 bottom > other.bottom ? bottom : other.bottom };
+}
+
+PixelRect PixelRect::Intersection( const PixelRect& other ) const noexcept
+{
+	return { left > other.left ? left : other.left,
+			 top > other.top ? top : other.top,
+			 right < other.right ? right : other.right,
+			 bottom < other.bottom ? bottom : other.bottom };
+}
+
+bool IsInPixel( const TriangleOut& triangle, int px, int py, Vector3& baryCentricPosition ) noexcept
+{
+	const Vector2 screenSpace{ px + 0.5f, py + 0.5f };
+
+	const std::array<Vector2, 3> triangle2d{ triangle.v0.position.GetXY(),
+											 triangle.v1.position.GetXY(),
+											 triangle.v2.position.GetXY() };
+
+	std::array<float, 3> baryBuffer{};
+	const float parallelogramArea{ Vector2::Cross( ( triangle2d[1] - triangle2d[0] ),
+												   ( triangle2d[2] - triangle2d[0] ) ) };
+
+	// Prevent floating point precision error-based crashes
+	// This area being 0 or lower could pose issues later down the line
+	if ( parallelogramArea <= 0.f )
+	{
+		return false;
+	}
+
+	for ( int offset{}; offset < 3; ++offset )
+	{
+		int nextOffset{ ( offset + 1 ) % 3 };
+		const Vector2 vertex{ triangle2d[offset] };
+		const Vector2 nextVertex{ triangle2d[nextOffset] };
+		const Vector2 edgeVector{ nextVertex - vertex };
+		const Vector2 vertexToPixel{ screenSpace - vertex };
+
+		const float signedArea{ Vector2::Cross( edgeVector, vertexToPixel ) };
+
+		if ( signedArea < 0.f )
+		{
+			return false;
+		}
+		else
+		{
+			const int baryIndex{ ( offset + 2 ) % 3 };
+			baryBuffer[baryIndex] = signedArea / parallelogramArea;
+			continue;
+		}
+	}
+
+	baryCentricPosition = { baryBuffer[0], baryBuffer[1], baryBuffer[2] };
+
+	return true;
+}
+
+bool GetBarycentricWeights( const TriangleOut& triangle, const Vector2& position, Vector3& baryCentricPosition ) noexcept
+{
+	const Vector2 v0{ triangle.v0.position.GetXY() };
+	const Vector2 v1{ triangle.v1.position.GetXY() };
+	const Vector2 v2{ triangle.v2.position.GetXY() };
+
+	const float parallelogramArea{ Vector2::Cross( v1 - v0, v2 - v0 ) };
+	if ( parallelogramArea <= 0.f )
+	{
+		return false;
+	}
+
+	// Each weight is the area of the sub triangle opposite its vertex, same edges as IsInPixel
+	const float inverseArea{ 1.f / parallelogramArea };
+	baryCentricPosition = { Vector2::Cross( v2 - v1, position - v1 ) * inverseArea,
+							Vector2::Cross( v0 - v2, position - v2 ) * inverseArea,
+							Vector2::Cross( v1 - v0, position - v0 ) * inverseArea };
+	return true;
+}
+
+uint32_t BlendPixel( uint32_t destination, uint32_t source, uint8_t alpha ) noexcept
+{
+	const uint32_t inverseAlpha{ 255u - alpha };
+
+	uint32_t result{};
+	for ( int shift{}; shift < 32; shift += 8 )
+	{
+		// x / 255 rounded to nearest, exact for every x up to 255 * 255
+		const uint32_t weighted{ ( ( source >> shift ) & 0xff ) * alpha +
+								 ( ( destination >> shift ) & 0xff ) * inverseAlpha + 128u };
+		result |= ( ( weighted + ( weighted >> 8 ) ) >> 8 ) << shift;
+	}
+	return result;
+}
+
+void BlendSpan( uint32_t* pDestination, const uint32_t* pSource, const uint8_t* pAlpha, int count ) noexcept
+{
+	int index{};
+
+#ifdef RASTERIZATION_SIMD
+	// Same math as BlendPixel on 16 bit lanes, 2 pixels per register, every step fits in 16 bits unsigned
+	const __m128i zero{ _mm_setzero_si128() };
+	const __m128i channelMax{ _mm_set1_epi16( 255 ) };
+	const __m128i half{ _mm_set1_epi16( 128 ) };
+	auto blendPair{ [&]( __m128i destination, __m128i source, __m128i alpha ) {
+		const __m128i weighted{ _mm_add_epi16(
+			_mm_add_epi16( _mm_mullo_epi16( source, alpha ),
+						   _mm_mullo_epi16( destination, _mm_sub_epi16( channelMax, alpha ) ) ),
+			half ) };
+		return _mm_srli_epi16( _mm_add_epi16( weighted, _mm_srli_epi16( weighted, 8 ) ), 8 );
+	} };
+	auto blendQuad{ [&]( int offset, __m128i alphaFirstPair, __m128i alphaSecondPair ) {
+		__m128i* pDestinationPixels{ reinterpret_cast<__m128i*>( pDestination + offset ) };
+		const __m128i destination{ _mm_loadu_si128( pDestinationPixels ) };
+		const __m128i source{ _mm_loadu_si128( reinterpret_cast<const __m128i*>( pSource + offset ) ) };
+
+		const __m128i low{ blendPair(
+			_mm_unpacklo_epi8( destination, zero ), _mm_unpacklo_epi8( source, zero ), alphaFirstPair ) };
+		const __m128i high{ blendPair(
+			_mm_unpackhi_epi8( destination, zero ), _mm_unpackhi_epi8( source, zero ), alphaSecondPair ) };
+		_mm_storeu_si128( pDestinationPixels, _mm_packus_epi16( low, high ) );
+	} };
+
+	for ( ; index + 8 <= count; index += 8 )
+	{
+		uint64_t alphaBits{};
+		std::memcpy( &alphaBits, pAlpha + index, sizeof( alphaBits ) );
+		if ( alphaBits == 0 ) // Nothing covered, common around the edges of a triangle
+		{
+			continue;
+		}
+
+		// 8 alphas -> each one repeated over the 4 channels of its pixel
+		const __m128i alpha16{ _mm_unpacklo_epi8(
+			_mm_loadl_epi64( reinterpret_cast<const __m128i*>( pAlpha + index ) ), zero ) };
+		const __m128i alphaLow{ _mm_unpacklo_epi16( alpha16, alpha16 ) };
+		const __m128i alphaHigh{ _mm_unpackhi_epi16( alpha16, alpha16 ) };
+		blendQuad( index, _mm_unpacklo_epi32( alphaLow, alphaLow ), _mm_unpackhi_epi32( alphaLow, alphaLow ) );
+		blendQuad( index + 4, _mm_unpacklo_epi32( alphaHigh, alphaHigh ), _mm_unpackhi_epi32( alphaHigh, alphaHigh ) );
+	}
+#endif
+
+	for ( ; index < count; ++index )
+	{
+		if ( pAlpha[index] != 0 )
+		{
+			pDestination[index] = BlendPixel( pDestination[index], pSource[index], pAlpha[index] );
+		}
+	}
+}
+
+namespace
+{
+// Destination pixel centers on the source grid in 16.16 fixed point
+constexpr int fixedShift{ 16 };
+
+int64_t GetSourcePosition( int destinationIndex, int sourceSize, int destinationSize ) noexcept
+{
+	return ( ( 2 * static_cast<int64_t>( destinationIndex ) + 1 ) * sourceSize << fixedShift ) /
+			   ( 2 * static_cast<int64_t>( destinationSize ) ) -
+		   ( int64_t{ 1 } << ( fixedShift - 1 ) );
+}
+
+// Source index before the position and the 8 bit weight of the one after it, clamped to the edges
+void GetBilinearTap( int64_t position, int sourceSize, int& index, uint32_t& weight ) noexcept
+{
+	if ( position <= 0 )
+	{
+		index = 0;
+		weight = 0;
+		return;
+	}
+
+	index = static_cast<int>( position >> fixedShift );
+	weight = static_cast<uint32_t>( position >> ( fixedShift - 8 ) ) & 0xff;
+	if ( index >= sourceSize - 1 )
+	{
+		index = sourceSize - 1;
+		weight = 0;
+	}
+}
+
+// Two channels per multiply in 16 bit slots, the weights add up to 256 so a slot never overflows
+uint32_t LerpPixel( uint32_t first, uint32_t second, uint32_t weight ) noexcept
+{
+	constexpr uint32_t channelMask{ 0x00ff00ff };
+	constexpr uint32_t rounding{ 0x00800080 };
+	const uint32_t firstWeight{ 256 - weight };
+	const uint32_t evenChannels{ ( ( first & channelMask ) * firstWeight + ( second & channelMask ) * weight + rounding ) >>
+								 8 };
+	const uint32_t oddChannels{ ( ( first >> 8 & channelMask ) * firstWeight + ( second >> 8 & channelMask ) * weight +
+								  rounding ) >>
+								8 };
+	return ( evenChannels & channelMask ) | ( oddChannels & channelMask ) << 8;
+}
+
+void FilterRowHorizontal( const uint32_t* pSourceRow,
+						  int sourceWidth,
+						  int destinationWidth,
+						  const PixelRect& destinationRect,
+						  uint32_t* pRow ) noexcept
+{
+	// Stepping instead of dividing per pixel, the drift over a row stays far below one weight step
+	const int64_t step{ ( static_cast<int64_t>( sourceWidth ) << fixedShift ) / destinationWidth };
+	int64_t position{ GetSourcePosition( destinationRect.left, sourceWidth, destinationWidth ) };
+	for ( int px{ destinationRect.left }; px < destinationRect.right; ++px, position += step )
+	{
+		int index{};
+		uint32_t weight{};
+		GetBilinearTap( position, sourceWidth, index, weight );
+		pRow[px - destinationRect.left] =
+			weight ? LerpPixel( pSourceRow[index], pSourceRow[index + 1], weight ) : pSourceRow[index];
+	}
+}
+
+void LerpRows( const uint32_t* pTop, const uint32_t* pBottom, uint32_t weight, uint32_t* pDestination, int count ) noexcept
+{
+	if ( !weight )
+	{
+		std::memcpy( pDestination, pTop, count * sizeof( uint32_t ) );
+		return;
+	}
+
+	int pixelIdx{};
+#ifdef RASTERIZATION_SIMD
+	// 4 pixels per step, channels widened to 16 bit: 255 * 256 + 128 still fits
+	const __m128i zero{ _mm_setzero_si128() };
+	const __m128i topWeight{ _mm_set1_epi16( static_cast<short>( 256 - weight ) ) };
+	const __m128i bottomWeight{ _mm_set1_epi16( static_cast<short>( weight ) ) };
+	const __m128i rounding{ _mm_set1_epi16( 128 ) };
+	auto lerpHalf{ [&]( __m128i top, __m128i bottom ) {
+		const __m128i sum{ _mm_add_epi16( _mm_add_epi16( _mm_mullo_epi16( top, topWeight ),
+														 _mm_mullo_epi16( bottom, bottomWeight ) ),
+										  rounding ) };
+		return _mm_srli_epi16( sum, 8 );
+	} };
+	for ( ; pixelIdx + 4 <= count; pixelIdx += 4 )
+	{
+		const __m128i top{ _mm_loadu_si128( reinterpret_cast<const __m128i*>( pTop + pixelIdx ) ) };
+		const __m128i bottom{ _mm_loadu_si128( reinterpret_cast<const __m128i*>( pBottom + pixelIdx ) ) };
+		const __m128i low{ lerpHalf( _mm_unpacklo_epi8( top, zero ), _mm_unpacklo_epi8( bottom, zero ) ) };
+		const __m128i high{ lerpHalf( _mm_unpackhi_epi8( top, zero ), _mm_unpackhi_epi8( bottom, zero ) ) };
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( pDestination + pixelIdx ), _mm_packus_epi16( low, high ) );
+	}
+#endif
+	for ( ; pixelIdx < count; ++pixelIdx )
+	{
+		pDestination[pixelIdx] = LerpPixel( pTop[pixelIdx], pBottom[pixelIdx], weight );
+	}
+}
+} // namespace
+
+void UpscaleBilinear( const uint32_t* pSource,
+					  int sourceWidth,
+					  int sourceHeight,
+					  uint32_t* pDestination,
+					  int destinationWidth,
+					  int destinationHeight,
+					  const PixelRect& destinationRect,
+					  uint32_t* pRowScratch ) noexcept
+{
+	const int rowWidth{ destinationRect.GetWidth() };
+	if ( destinationRect.IsEmpty() )
+	{
+		return;
+	}
+
+	// Two horizontally filtered source rows, upscaling reuses them for several destination rows
+	uint32_t* pFilteredRows[2]{ pRowScratch, pRowScratch + rowWidth };
+	int filteredRowIndices[2]{ -1, -1 };
+	auto getFilteredRow{ [&]( int sourceRowIdx, int slot ) {
+		if ( filteredRowIndices[slot] != sourceRowIdx )
+		{
+			// The other slot may already hold it when moving down one source row
+			if ( filteredRowIndices[1 - slot] == sourceRowIdx )
+			{
+				std::swap( pFilteredRows[0], pFilteredRows[1] );
+				std::swap( filteredRowIndices[0], filteredRowIndices[1] );
+			}
+			else
+			{
+				FilterRowHorizontal(
+					pSource + sourceRowIdx * sourceWidth, sourceWidth, destinationWidth, destinationRect, pFilteredRows[slot] );
+				filteredRowIndices[slot] = sourceRowIdx;
+			}
+		}
+		return pFilteredRows[slot];
+	} };
+
+	for ( int py{ destinationRect.top }; py < destinationRect.bottom; ++py )
+	{
+		int sourceRowIdx{};
+		uint32_t weight{};
+		GetBilinearTap( GetSourcePosition( py, sourceHeight, destinationHeight ), sourceHeight, sourceRowIdx, weight );
+
+		const uint32_t* pTop{ getFilteredRow( sourceRowIdx, 0 ) };
+		const uint32_t* pBottom{ weight ? getFilteredRow( sourceRowIdx + 1, 1 ) : pTop };
+		LerpRows( pTop, pBottom, weight, pDestination + destinationRect.left + py * destinationWidth, rowWidth );
+	}
+}
+
+void ResolveSamples( const uint32_t* pSamples, uint32_t* pPixels, int pixelCount ) noexcept
+{
+	for ( int pixelIndex{}; pixelIndex < pixelCount; ++pixelIndex )
+	{
+		const uint32_t* pPixelSamples{ pSamples + pixelIndex * msaaSampleCount };
+
+		// Interior pixels have 4 equal samples, nothing to average
+		if ( pPixelSamples[0] == pPixelSamples[1] && pPixelSamples[0] == pPixelSamples[2] &&
+			 pPixelSamples[0] == pPixelSamples[3] )
+		{
+			pPixels[pixelIndex] = pPixelSamples[0];
+			continue;
+		}
+
+		uint32_t resolved{};
+		for ( int shift{}; shift < 32; shift += 8 )
+		{
+			uint32_t channelSum{ msaaSampleCount / 2 };
+			for ( int sampleIdx{}; sampleIdx < msaaSampleCount; ++sampleIdx )
+			{
+				channelSum += ( pPixelSamples[sampleIdx] >> shift ) & 0xff;
+			}
+			resolved |= ( channelSum / msaaSampleCount ) << shift;
+		}
+		pPixels[pixelIndex] = resolved;
+	}
+}
+} // namespace dae
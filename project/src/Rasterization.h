@@ -0,0 +1,63 @@
+#ifndef RASTERIZATION_H
+#define RASTERIZATION_H
+#include <array>
+#include <cstdint>
+#include "Structs.h"
+
+// Software rasterization primitives
+// Free of renderer and D3D state so they can be benchmarked on their own
+
+namespace dae
+{
+// Standard D3D 4x pattern, offsets from the top left corner of the pixel
+// Rotated grid: no two samples share a row or column, so near horizontal and near vertical edges both get 4 steps
+constexpr int msaaSampleCount{ 4 };
+constexpr std::array<float, msaaSampleCount> msaaSampleOffsetsX{ 0.375f, 0.875f, 0.125f, 0.625f };
+constexpr std::array<float, msaaSampleCount> msaaSampleOffsetsY{ 0.125f, 0.375f, 0.625f, 0.875f };
+
+// Pixel area, right and bottom exclusive
+struct PixelRect final
+{
+	int left{};
+	int top{};
+	int right{};
+	int bottom{};
+
+	int GetWidth() const noexcept;
+	bool IsEmpty() const noexcept;
+	bool Intersects( const PixelRect& other ) const noexcept;
+	PixelRect Union( const PixelRect& other ) const noexcept; // Empty rects add nothing
+	PixelRect Intersection( const PixelRect& other ) const noexcept;
+};
+
+// Tests the pixel center against the screen space triangle, outputs the barycentric weights of v0, v1, v2
+// Degenerate and counter-clockwise triangles never contain a pixel
+bool IsInPixel( const TriangleOut& triangle, int px, int py, Vector3& baryCentricPosition ) noexcept;
+// Barycentric weights of v0, v1, v2 at any screen position, some are negative when it lies outside
+// False for the triangles IsInPixel never accepts
+bool GetBarycentricWeights( const TriangleOut& triangle, const Vector2& position, Vector3& baryCentricPosition ) noexcept;
+
+// source * alpha + destination * ( 1 - alpha ) per 8 bit channel, rounded like a UNORM render target
+// Works for any 32-bit pixel format with 8 bit channels, as long as both pixels use the same one
+uint32_t BlendPixel( uint32_t destination, uint32_t source, uint8_t alpha ) noexcept;
+// BlendPixel over a span, 8 pixels per step with SSE2, gives the exact same result
+// Alpha 0 leaves the destination untouched, so rejected pixels can stay in the span
+void BlendSpan( uint32_t* pDestination, const uint32_t* pSource, const uint8_t* pAlpha, int count ) noexcept;
+
+// Bilinear resize with pixel centers aligned and edges clamped, same format rules as BlendPixel
+// Only the pixels of destinationRect are written, pRowScratch needs room for two rows of it
+// Rows are filtered horizontally once per source row and blended vertically with SSE2
+void UpscaleBilinear( const uint32_t* pSource,
+					  int sourceWidth,
+					  int sourceHeight,
+					  uint32_t* pDestination,
+					  int destinationWidth,
+					  int destinationHeight,
+					  const PixelRect& destinationRect,
+					  uint32_t* pRowScratch ) noexcept;
+
+// Per channel average of the msaaSampleCount consecutive samples of every pixel, rounded to nearest
+// Same format rules as BlendPixel
+void ResolveSamples( const uint32_t* pSamples, uint32_t* pPixels, int pixelCount ) noexcept;
+} // namespace dae
+#endif
@@ -0,0 +1,62 @@
+#include "RenderCommands.h"
+#include "RadixSort.h"
+
+namespace dae
+{
+namespace
+{
+// Key layout in bytes, from the top down, every field byte aligned so bytes nobody uses are skipped by the sort
+// Opaque:      pass (1) | material (2) | near to far depth (2) | unused (3)
+// Transparent: pass (1) | far to near depth (2) | unused (5)
+// Equal keys keep the order they were added in
+constexpr int passShift{ 56 };
+constexpr int materialShift{ 40 };
+constexpr int opaqueDepthShift{ 24 };
+constexpr int transparentDepthShift{ 40 };
+
+constexpr uint32_t maxDepth{ 0xffff };
+
+// Depth is expected in [0, 1], anything else (NaN included) is clamped
+uint64_t QuantizeDepth( float depth )
+{
+	const float saturated{ depth > 0.f ? ( depth < 1.f ? depth : 1.f ) : 0.f };
+	return static_cast<uint64_t>( saturated * maxDepth );
+}
+
+uint64_t GetPassBits( RenderPass pass )
+{
+	return static_cast<uint64_t>( pass ) << passShift;
+}
+} // namespace
+
+uint64_t RenderCommandList::MakeOpaqueKey( uint16_t materialId, float depth )
+{
+	return GetPassBits( RenderPass::opaque ) | static_cast<uint64_t>( materialId ) << materialShift |
+		   QuantizeDepth( depth ) << opaqueDepthShift;
+}
+
+uint64_t RenderCommandList::MakeTransparentKey( float depth )
+{
+	return GetPassBits( RenderPass::transparent ) | ( maxDepth - QuantizeDepth( depth ) ) << transparentDepthShift;
+}
+
+void RenderCommandList::Clear()
+{
+	m_Commands.clear();
+}
+
+void RenderCommandList::Add( const RenderCommand& command )
+{
+	m_Commands.push_back( command );
+}
+
+void RenderCommandList::Sort()
+{
+	RadixSort( m_Commands, m_SortBuffer, []( const RenderCommand& command ) { return command.sortKey; } );
+}
+
+const std::vector<RenderCommand>& RenderCommandList::GetCommands() const
+{
+	return m_Commands;
+}
+} // namespace dae
@@ -0,0 +1,49 @@
+#ifndef RENDERCOMMANDS_H
+#define RENDERCOMMANDS_H
+#include <cstdint>
+#include <vector>
+
+// Per-frame list of draws a scene hands to either backend
+// Backends only walk the sorted list, which mesh goes when is decided by the keys
+
+namespace dae
+{
+// Also the highest bits of the sort key, so every opaque draw comes before every transparent one
+enum class RenderPass : uint8_t
+{
+	opaque,
+	transparent,
+	count,
+};
+
+// The world matrix stays with the mesh, instanced meshes have one per copy
+struct RenderCommand final
+{
+	uint64_t sortKey{};
+	uint32_t meshIndex{}; // Into the mesh vector of the pass
+	uint16_t materialId{};
+	RenderPass pass{};
+};
+
+class RenderCommandList final
+{
+public:
+	// Depth is view depth over the far plane, [0, 1]
+	// Opaque: grouped by material, front to back within a material
+	static uint64_t MakeOpaqueKey( uint16_t materialId, float depth );
+	// Transparent: back to front, the material is ignored because blending order wins
+	static uint64_t MakeTransparentKey( float depth );
+
+	void Clear();
+	void Add( const RenderCommand& command );
+	// Stable LSD radix sort on the key, skips the bytes every key has in common
+	void Sort();
+
+	const std::vector<RenderCommand>& GetCommands() const;
+
+private:
+	std::vector<RenderCommand> m_Commands{};
+	std::vector<RenderCommand> m_SortBuffer{};
+};
+} // namespace dae
+#endif
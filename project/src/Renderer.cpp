@@ -12,17 +12,23 @@
 #include <iostream>
 #include <SDL_syswm.h>
 #include <bit>
+#include <cstring>
+#include <optional>
 
 // Project includes
 #include "Renderer.h"
 #include "Error.h"
 #include "Mesh.h"
+#include "Profiler.h"
+#include "RadixSort.h"
+#include "Rasterization.h"
 #include "Timer.h"
 
 using namespace dae;
 
-Renderer::Renderer( SDL_Window* pWindow )
+Renderer::Renderer( SDL_Window* pWindow, JobSystem& jobSystem )
 	: m_pWindow( pWindow )
+	, m_pJobSystem( &jobSystem )
 {
 	// Initialize Window
 	SDL_GetWindowSize( pWindow, &m_Width, &m_Height );
@@ -41,15 +47,37 @@ Renderer::Renderer( SDL_Window* pWindow )
 
 	// Software: Create Buffers
 	m_pFrontBuffer = SDL_GetWindowSurface( pWindow );
-	m_pBackBuffer = SDL_CreateRGBSurface( 0, m_Width, m_Height, 32, 0, 0, 0, 0 );
-	m_pBackBufferPixels = reinterpret_cast<uint32_t*>( m_pBackBuffer->pixels );
-	m_DepthBufferPixels = std::vector<float>( m_Width * m_Height );
-	m_PixelAttributeBuffer = std::vector<std::pair<bool, VertexOut>>( m_Width * m_Height );
+	// Match the window format so the blit fallback is a plain copy instead of a conversion
+	InitializeSoftware( m_pFrontBuffer->format->format );
+	if ( !CanRenderDirect() )
+	{
+		m_PresentMode = PresentMode::blit;
+	}
 	//
 }
 
+Renderer::Renderer( int width, int height, JobSystem& jobSystem )
+	: m_Width( width )
+	, m_Height( height )
+	, m_UseHardware( false )
+	, m_pJobSystem( &jobSystem )
+	, m_PresentMode( PresentMode::blit )
+{
+	// No window and no DirectX: the back buffer is the final image
+	InitializeSoftware( SDL_PIXELFORMAT_ARGB8888 );
+	std::cout << "Headless software renderer is ready (" << m_Width << "x" << m_Height << ")\n";
+}
+
 Renderer::~Renderer() noexcept
 {
+	DestroyPresentFrames();
+	DestroyStreamingResources();
+
+	if ( m_pBackBuffer )
+	{
+		SDL_FreeSurface( m_pBackBuffer );
+	}
+
 	if ( m_pRenderTargetView )
 	{
 		m_pRenderTargetView->Release();
@@ -94,10 +122,14 @@ void Renderer::Update( const Timer& timer )
 
 void Renderer::HandleKeyUp( SDL_KeyboardEvent key )
 {
+	// Every toggle here changes the image or where it goes
+	InvalidateFrame();
+
 	switch ( key.keysym.scancode )
 	{
 	case SDL_SCANCODE_F1:
 		m_UseHardware = !m_UseHardware;
+		UpdateStreamingForBackend();
 		if ( m_UseHardware )
 		{
 			std::cout << "Using hardware\n";
@@ -149,6 +181,70 @@ void Renderer::HandleKeyUp( SDL_KeyboardEvent key )
 
 		break;
 
+	case SDL_SCANCODE_F9:
+		CyclePresentMode();
+		break;
+
+	case SDL_SCANCODE_N:
+		SetMultisampling( !m_UseMultisampling );
+		if ( m_UseMultisampling )
+		{
+			std::cout << "Using 4x multisampling\n";
+		}
+		else
+		{
+			std::cout << "Using single sampling\n";
+		}
+		break;
+
+	case SDL_SCANCODE_I:
+		m_UseIncrementalRendering = !m_UseIncrementalRendering;
+		if ( m_UseIncrementalRendering )
+		{
+			std::cout << "Redrawing only what changed\n";
+		}
+		else
+		{
+			std::cout << "Redrawing every frame\n";
+		}
+		break;
+
+	case SDL_SCANCODE_R:
+		SetDynamicResolution( !m_UseDynamicResolution );
+		if ( m_UseDynamicResolution )
+		{
+			std::cout << "Using dynamic resolution (" << m_FrameBudget * 1000.f << " ms budget)\n";
+		}
+		else
+		{
+			std::cout << "Using full resolution\n";
+		}
+		break;
+
+	case SDL_SCANCODE_V:
+		SetVariableRateShading( !m_UseVariableRateShading );
+		if ( m_UseVariableRateShading )
+		{
+			std::cout << "Using variable rate shading\n";
+		}
+		else
+		{
+			std::cout << "Shading every pixel\n";
+		}
+		break;
+
+	case SDL_SCANCODE_M:
+		m_MathPrecision = m_MathPrecision == MathPrecision::exact ? MathPrecision::fast : MathPrecision::exact;
+		if ( m_MathPrecision == MathPrecision::fast )
+		{
+			std::cout << "Using fast math\n";
+		}
+		else
+		{
+			std::cout << "Using exact math\n";
+		}
+		break;
+
 	case SDL_SCANCODE_F10:
 		m_UseUniformClearColor = !m_UseUniformClearColor;
 		if ( m_UseUniformClearColor )
@@ -166,20 +262,32 @@ void Renderer::HandleKeyUp( SDL_KeyboardEvent key )
 	}
 }
 
-void Renderer::Render( Scene* pScene )
+void Renderer::Render( Scene* pScene, const std::function<void()>& update )
 {
+	// Nothing reads the scene between frames, so this is where loaded assets join it
+	// A failed load is reported and leaves its placeholder, or no mesh at all
+	if ( pScene->IsLoading() )
+	{
+		error::utils::HandleThrowingFunction( [&]() { pScene->ApplyLoadedAssets( m_pDevice ); } );
+	}
+
 	if ( m_UseHardware )
 	{
 		RenderHW( pScene );
+		if ( update )
+		{
+			update();
+		}
 	}
 	else
 	{
-		RenderSW( pScene );
+		RenderSW( pScene, update );
 	}
 }
 
 void Renderer::RenderHW( Scene* pScene )
 {
+	PROFILE_FUNCTION();
 	if ( !m_IsInitialized )
 	{
 		return;
@@ -212,433 +320,1601 @@ void Renderer::RenderHW( Scene* pScene )
 	m_pSwapChain->Present( 0, 0 );
 }
 
-void Renderer::RenderSW( Scene* pScene )
+void Renderer::RenderSW( Scene* pScene, const std::function<void()>& update )
 {
+	PROFILE_FUNCTION();
 	//@START
-	// Lock BackBuffer
-	SDL_LockSurface( m_pBackBuffer );
+	m_FrameTimings.Reset();
+	ApplyRenderScale();
 
-	// Flush buffers
-	for ( int px{}; px < m_Width; ++px )
+	// Nothing moved: the window gets the last frame again without touching a pixel
+	m_ScissorRect = UpdateDirtyRect( pScene );
+	if ( m_ScissorRect.IsEmpty() )
 	{
-		for ( int py{}; py < m_Height; ++py )
+		const auto presentStart{ FrameClock::now() };
+		PresentPreviousFrameSW();
+		m_FrameTimings.AddSince( RenderStage::present, presentStart );
+		if ( update )
 		{
-			const int lightGray{ 99 };
-			const int darkGray{ 25 };
-
-			if ( m_UseUniformClearColor )
-			{
-				m_pBackBufferPixels[px + ( py * m_Width )] =
-					SDL_MapRGB( m_pBackBuffer->format, darkGray, darkGray, darkGray );
-			}
-			else
-			{
-				m_pBackBufferPixels[px + ( py * m_Width )] =
-					SDL_MapRGB( m_pBackBuffer->format, lightGray, lightGray, lightGray );
-			}
+			update();
 		}
-	}
-	for ( auto& depthPixel : m_DepthBufferPixels )
-	{
-		depthPixel = std::numeric_limits<float>::max();
-	}
-
-	// Get world to camera
-	Matrix worldToCamera{ pScene->GetCamera().GetViewMatrix() };
-
-	// For every mesh
-	const auto& meshes{ pScene->GetMeshes() };
-	for ( const auto& mesh : meshes )
-	{
-		RasterizeMesh( mesh, pScene, worldToCamera );
+		return;
 	}
 
-	//@END
-	// Update SDL Surface
-	SDL_UnlockSurface( m_pBackBuffer );
-	SDL_BlitSurface( m_pBackBuffer, 0, m_pFrontBuffer, 0 );
-	SDL_UpdateWindowSurface( m_pWindow );
-}
+	const auto clearStart{ FrameClock::now() };
 
-void Renderer::RasterizeMesh( const Mesh& mesh, const Scene* pScene, const Matrix& worldToCamera )
-{
-	const Camera& camera{ pScene->GetCamera() };
+	// Acquire the pixels we rasterize into this frame
+	const PresentMode presentMode{ m_PresentMode };
+	BeginFrameSW();
 
-	// Flush pixel attribute buffer
-	for ( auto& pixel : m_PixelAttributeBuffer )
+	// A locked streaming texture has undefined contents, and falling back to blit leaves an outdated back buffer
+	if ( m_PresentMode == PresentMode::streaming || m_PresentMode != presentMode )
 	{
-		pixel = {};
+		m_ScissorRect = { 0, 0, m_RenderWidth, m_RenderHeight };
 	}
 
-	// PROJECTION
-	Project( mesh.GetVertices(), m_VertexOutBuffer, camera, mesh.GetWorld(), worldToCamera );
+	// Flush buffers
+	const uint8_t lightGray{ 99 };
+	const uint8_t darkGray{ 25 };
+	const uint8_t clearChannel{ m_UseUniformClearColor ? darkGray : lightGray };
+	const uint32_t clearColor{ SDL_MapRGB( m_pPixelFormat, clearChannel, clearChannel, clearChannel ) };
+
+	// Single sampled frames rasterize straight into the frame, multisampled ones get resolved into it
+	// The frame is the back buffer itself unless it gets upscaled into it
+	m_pFramePixels = IsUpscaling() ? m_ScaledFrameBuffer.data() : m_pBackBufferPixels;
+	m_pSampleColors = m_UseMultisampling ? m_SampleColorBuffer.data() : m_pFramePixels;
+	m_pPreviousFramePixels = IsUpscaling() || !m_pPreviousSlotPixels ? m_pFramePixels : m_pPreviousSlotPixels;
+	const int sampleCount{ GetSampleCount() };
+
+	// Shading rates come from the last frame, so they are picked before it gets cleared
+	const bool hasPreviousFrame{ m_IsPreviousFrameReadable && m_PresentMode == presentMode &&
+								 m_PresentMode != PresentMode::streaming };
+
+	// From here on the tasks only read the snapshot and what never changes after loading
+	m_Frame.camera = pScene->GetCamera();
+	m_Frame.lightDirection = pScene->GetLightDirection();
+	m_Frame.filterMode = pScene->GetFilterMode();
+
+	ResetFrameArena();
+	const TaskGraph::TaskId clearTask{ m_FrameGraph.Add( "Clear", [&]() {
+		if ( m_UseVariableRateShading )
+		{
+			UpdateShadingRates( hasPreviousFrame );
+		}
 
-	// For every triangle in mesh
-	for ( size_t index{}; index < mesh.GetIndices().size(); )
+		constexpr size_t rowsPerJob{ 32 };
+		const int scissorSampleCount{ m_ScissorRect.GetWidth() * sampleCount };
+		m_pJobSystem->ParallelFor(
+			m_ScissorRect.bottom - m_ScissorRect.top, rowsPerJob, [&]( size_t firstRow, size_t rowEnd ) {
+				for ( int py{ m_ScissorRect.top + static_cast<int>( firstRow ) };
+					  py < m_ScissorRect.top + static_cast<int>( rowEnd );
+					  ++py )
+				{
+					const int rowStart{ ( m_ScissorRect.left + py * m_RenderWidth ) * sampleCount };
+					std::fill_n( m_pSampleColors + rowStart, scissorSampleCount, clearColor );
+					std::fill_n(
+						m_DepthBufferPixels.begin() + rowStart, scissorSampleCount, std::numeric_limits<float>::max() );
+				}
+			} );
+		m_FrameTimings.AddSince( RenderStage::clear, clearStart );
+	} ) };
+
+	// Same sorted stream as the hardware path, only visible meshes are in it
+	// The debug views show the depth buffer and opaque triangle bounds, transparent meshes have neither
+	const auto& meshes{ pScene->GetMeshes() };
+	const auto& transparentMeshes{ pScene->GetTransparentMeshes() };
+	const bool isDebugView{ m_ShowDepthBuffer || m_ShowBoundingBox };
+	pScene->BuildRenderCommands( m_RenderCommands );
+
+	TaskGraph::TaskId lastPixelTask{ clearTask };	 // Pixels are written in submission order
+	std::optional<TaskGraph::TaskId> lastVertexReader{}; // The next projection overwrites what it reads
+	std::pmr::vector<TaskGraph::TaskId> rasterTasks{ &m_FrameArena };
+	for ( const RenderCommand& command : m_RenderCommands.GetCommands() )
 	{
-		auto goToNextTriangleIndex{ [&]() {
-			// Increment differently based on topology
-			switch ( mesh.GetTopology() )
+		// Meshes away from the redrawn area still have their pixels from the last frame
+		if ( command.pass == RenderPass::opaque )
+		{
+			if ( !m_MeshFrameStates[command.meshIndex].screenBounds.Intersects( m_ScissorRect ) )
 			{
-				// changed after original handin to comply with DX11 topology type
-			case D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST:
-				index += 3;
-				break;
+				continue;
+			}
 
-			case D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP:
-				++index;
-				break;
+			// Every copy shares the maps, so all of them rasterize into the same attribute buffer and get shaded once
+			const Mesh& mesh{ meshes[command.meshIndex] };
+			mesh.GetVisibleWorlds( m_Frame.camera.GetFrustum(), m_VisibleWorldBuffer, m_VisibleLodBuffer );
+			if ( m_VisibleWorldBuffer.empty() )
+			{
+				continue;
+			}
 
-			default:
-				throw error::mesh::WrongTopology();
-				break;
+			for ( size_t visibleIdx{}; visibleIdx < m_VisibleWorldBuffer.size(); ++visibleIdx )
+			{
+				const size_t copyIdx{ m_FrameCopies.size() };
+				m_FrameCopies.push_back( { &mesh, m_VisibleWorldBuffer[visibleIdx], m_VisibleLodBuffer[visibleIdx] } );
+				TriangleBins& bins{ m_TriangleBins[copyIdx % binSlotCount] };
+
+				const TaskGraph::TaskId vertexTask{ m_FrameGraph.Add(
+					"Vertex", [this, copyIdx]() { ProjectCopy( m_FrameCopies[copyIdx] ); } ) };
+				if ( lastVertexReader )
+				{
+					m_FrameGraph.AddDependency( vertexTask, *lastVertexReader );
+				}
+
+				const TaskGraph::TaskId binTask{ m_FrameGraph.Add(
+					"Bin", [this, copyIdx, &bins]() { BinCopy( m_FrameCopies[copyIdx], bins ); } ) };
+				m_FrameGraph.AddDependency( binTask, vertexTask );
+				if ( copyIdx >= binSlotCount )
+				{
+					m_FrameGraph.AddDependency( binTask, rasterTasks[copyIdx - binSlotCount] );
+				}
+
+				const TaskGraph::TaskId rasterTask{ m_FrameGraph.Add(
+					"Raster", [this, copyIdx, &bins]() { RasterizeBins( m_FrameCopies[copyIdx], bins ); } ) };
+				m_FrameGraph.AddDependency( rasterTask, binTask );
+				m_FrameGraph.AddDependency( rasterTask, lastPixelTask );
+
+				lastVertexReader = binTask;
+				lastPixelTask = rasterTask;
+				rasterTasks.push_back( rasterTask );
 			}
-		} };
 
-		// Stop if at the end of strip
-		if ( index + 2 >= mesh.GetIndices().size() )
-		{
-			break;
+			// Whatever triangle still owns samples of a pixel gets shaded, which also leaves the coverage cleared for the next mesh
+			const TaskGraph::TaskId shadeTask{ m_FrameGraph.Add( "Shade", [this, &mesh]() { ShadeMesh( mesh ); } ) };
+			m_FrameGraph.AddDependency( shadeTask, lastPixelTask );
+			lastPixelTask = shadeTask;
 		}
-
-		// Construct triangle
-		TriangleOut projectedTriangle{};
-		switch ( mesh.GetTopology() )
+		else if ( !isDebugView )
 		{
-		case D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST:
-			projectedTriangle = TriangleOut{ m_VertexOutBuffer[mesh.GetIndices()[index + 0]],
-											 m_VertexOutBuffer[mesh.GetIndices()[index + 1]],
-											 m_VertexOutBuffer[mesh.GetIndices()[index + 2]] };
-			break;
-		case D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP:
-			// Check if mesh is correct size to be a strip
-			assert( mesh.GetIndexCount() > 6 && "Mesh has too few indices to be a strip" );
-			// Fix orientation for odd triangles
-			if ( index & 1 )
+			if ( !m_TransparentMeshFrameStates[command.meshIndex].screenBounds.Intersects( m_ScissorRect ) )
 			{
-				projectedTriangle = TriangleOut{ m_VertexOutBuffer[mesh.GetIndices()[index + 0]],
-												 m_VertexOutBuffer[mesh.GetIndices()[index + 2]],
-												 m_VertexOutBuffer[mesh.GetIndices()[index + 1]] };
-			}
-			else
-			{
-				projectedTriangle = TriangleOut{ m_VertexOutBuffer[mesh.GetIndices()[index + 0]],
-												 m_VertexOutBuffer[mesh.GetIndices()[index + 1]],
-												 m_VertexOutBuffer[mesh.GetIndices()[index + 2]] };
+				continue;
 			}
-			break;
 
-		default:
-			throw error::mesh::WrongTopology();
-			break;
+			// Projects into the same vertex buffer, but everything before it already finished rasterizing
+			const TransparentMesh& mesh{ transparentMeshes[command.meshIndex] };
+			const TaskGraph::TaskId blendTask{ m_FrameGraph.Add( "Blend", [this, &mesh, world = mesh.GetWorld()]() {
+				RasterizeTransparentMesh( mesh, world );
+			} ) };
+			m_FrameGraph.AddDependency( blendTask, lastPixelTask );
+			lastVertexReader = blendTask;
+			lastPixelTask = blendTask;
 		}
+	}
 
-		if ( IsCullable( projectedTriangle ) )
+	//@END
+	const PixelRect presentRect{ IsUpscaling() ? GetUpscaledRect( m_ScissorRect ) : m_ScissorRect };
+	const TaskGraph::TaskId resolveTask{ m_FrameGraph.Add( "Resolve", [&]() {
+		const auto upscaleStart{ FrameClock::now() };
+		if ( m_UseMultisampling )
 		{
-			goToNextTriangleIndex();
-			continue;
+			constexpr size_t rowsPerJob{ 32 };
+			m_pJobSystem->ParallelFor(
+				m_ScissorRect.bottom - m_ScissorRect.top, rowsPerJob, [&]( size_t firstRow, size_t rowEnd ) {
+					for ( int py{ m_ScissorRect.top + static_cast<int>( firstRow ) };
+						  py < m_ScissorRect.top + static_cast<int>( rowEnd );
+						  ++py )
+					{
+						const int rowStart{ m_ScissorRect.left + py * m_RenderWidth };
+						ResolveSamples( m_pSampleColors + rowStart * sampleCount,
+										m_pFramePixels + rowStart,
+										m_ScissorRect.GetWidth() );
+					}
+				} );
 		}
 
-		const Rectangle projectedTriangleBounds{ projectedTriangle.GetBounds() };
+		if ( IsUpscaling() )
+		{
+			PROFILE_ZONE( "Upscale" );
+			UpscaleBilinear( m_pFramePixels,
+							 m_RenderWidth,
+							 m_RenderHeight,
+							 m_pBackBufferPixels,
+							 m_Width,
+							 m_Height,
+							 presentRect,
+							 m_UpscaleRowScratch.data() );
+			m_FrameTimings.AddSince( RenderStage::upscale, upscaleStart );
+		}
+	} ) };
+	m_FrameGraph.AddDependency( resolveTask, lastPixelTask );
+
+	// SDL wants the window surface and the renderer on the thread that created them
+	FrameClock::time_point presentStart{};
+	const TaskGraph::TaskId presentTask{ m_FrameGraph.Add(
+		"PresentSW",
+		[&]() {
+			presentStart = FrameClock::now();
+			PresentSW( presentRect );
+			m_FrameTimings.AddSince( RenderStage::present, presentStart );
+		},
+		true ) };
+	m_FrameGraph.AddDependency( presentTask, resolveTask );
+
+	// The last frame reaches the window while the workers rasterize this one into another slot
+	if ( m_PresentMode == PresentMode::threaded && m_PresentedFrameCount != m_SubmittedFrameCount )
+	{
+		const TaskGraph::TaskId queuedPresentTask{ m_FrameGraph.Add(
+			"PresentQueued",
+			[this]() {
+				const auto queuedPresentStart{ FrameClock::now() };
+				PresentQueuedFrame();
+				m_FrameTimings.AddSince( RenderStage::present, queuedPresentStart );
+			},
+			true ) };
+		m_FrameGraph.AddDependency( presentTask, queuedPresentTask ); // Submitting first would show this frame early
+	}
 
-		auto processPixel{ [&]( int px, int py ) {
-			Vector3 baryCentricPosition{};
+	// Needs nothing the tasks read, so the next frame's simulation overlaps this one's rasterization
+	if ( update )
+	{
+		m_FrameGraph.Add( "Update", [&update]() { update(); }, true );
+	}
 
-			const int bufferIndex{ px + ( py * m_Width ) };
-			if ( m_ShowBoundingBox )
-			{
-				const ColorRGB finalColor{ 1.f, 1.f, 1.f };
-				m_pBackBufferPixels[bufferIndex] = SDL_MapRGB( m_pBackBuffer->format,
-															   static_cast<uint8_t>( finalColor.r * 255 ),
-															   static_cast<uint8_t>( finalColor.g * 255 ),
-															   static_cast<uint8_t>( finalColor.b * 255 ) );
-				return;
-			}
+	m_FrameGraph.Run( *m_pJobSystem );
+	m_IsPreviousFrameReadable = true;
 
-			if ( !IsInPixel( projectedTriangle, px, py, baryCentricPosition ) )
-			{
-				return;
-			}
+	// Partial frames say nothing about what a full one costs at this scale
+	const bool isFullFrame{ m_ScissorRect.GetWidth() == m_RenderWidth &&
+							m_ScissorRect.bottom - m_ScissorRect.top == m_RenderHeight };
+	if ( m_UseDynamicResolution && isFullFrame )
+	{
+		UpdateRenderScale( std::chrono::duration<float>( presentStart - clearStart ).count() );
+	}
+}
 
-			const float interpolatedDepth{ 1.f /
-										   ( ( 1.f / projectedTriangle.v0.position.z ) * baryCentricPosition.x +
-											 ( 1.f / projectedTriangle.v1.position.z ) * baryCentricPosition.y +
-											 ( 1.f / projectedTriangle.v2.position.z ) * baryCentricPosition.z ) };
+void Renderer::BeginFrameSW()
+{
+	m_pPreviousSlotPixels = nullptr;
+	switch ( m_PresentMode )
+	{
+	case PresentMode::direct:
+		SDL_LockSurface( m_pFrontBuffer );
+		m_pBackBufferPixels = reinterpret_cast<uint32_t*>( m_pFrontBuffer->pixels );
+		m_pPixelFormat = m_pFrontBuffer->format;
+		return;
 
-			// Check Depth Buffer
-			if ( interpolatedDepth > m_DepthBufferPixels[bufferIndex] )
+	case PresentMode::streaming:
+	{
+		void* pPixels{};
+		int pitch{};
+		if ( SDL_LockTexture( m_pStreamingTexture, nullptr, &pPixels, &pitch ) == 0 )
+		{
+			if ( pitch == m_Width * static_cast<int>( sizeof( uint32_t ) ) )
 			{
+				m_pBackBufferPixels = reinterpret_cast<uint32_t*>( pPixels );
+				m_pPixelFormat = m_pStreamingFormat;
 				return;
 			}
-			m_DepthBufferPixels[bufferIndex] = interpolatedDepth;
-
-			const float viewSpaceDepthInterpolated{
-				1.f / ( ( 1.f / projectedTriangle.v0.position.w ) * baryCentricPosition.x +
-						( 1.f / projectedTriangle.v1.position.w ) * baryCentricPosition.y +
-						( 1.f / projectedTriangle.v2.position.w ) * baryCentricPosition.z )
-			};
-
-			Vector4 interpolatedPosition{};
-			Vector3 interpolatedWorldPosition{};
-			Vector3 interpolatedNormal{};
-			Vector3 interpolatedTangent{};
-
-			// Interpolate
-			interpolatedPosition.x = projectedTriangle.v0.position.x * baryCentricPosition.x +
-									 projectedTriangle.v1.position.x * baryCentricPosition.y +
-									 projectedTriangle.v2.position.x * baryCentricPosition.z;
-			interpolatedPosition.y = projectedTriangle.v0.position.y * baryCentricPosition.x +
-									 projectedTriangle.v1.position.y * baryCentricPosition.y +
-									 projectedTriangle.v2.position.y * baryCentricPosition.z;
-			interpolatedPosition.w = projectedTriangle.v0.position.z * baryCentricPosition.x +
-									 projectedTriangle.v1.position.z * baryCentricPosition.y +
-									 projectedTriangle.v2.position.z * baryCentricPosition.z;
-			interpolatedPosition.z = interpolatedDepth;
-
-			interpolatedWorldPosition.x = projectedTriangle.v0.worldPosition.x * baryCentricPosition.x +
-										  projectedTriangle.v1.worldPosition.x * baryCentricPosition.y +
-										  projectedTriangle.v2.worldPosition.x * baryCentricPosition.z;
-			interpolatedWorldPosition.y = projectedTriangle.v0.worldPosition.y * baryCentricPosition.x +
-										  projectedTriangle.v1.worldPosition.y * baryCentricPosition.y +
-										  projectedTriangle.v2.worldPosition.y * baryCentricPosition.z;
-			interpolatedWorldPosition.z = projectedTriangle.v0.worldPosition.z * baryCentricPosition.x +
-										  projectedTriangle.v1.worldPosition.z * baryCentricPosition.y +
-										  projectedTriangle.v2.worldPosition.z * baryCentricPosition.z;
-
-			const ColorRGB interpolatedColor{
-				( projectedTriangle.v0.color / projectedTriangle.v0.position.w * baryCentricPosition.x +
-				  projectedTriangle.v1.color / projectedTriangle.v1.position.w * baryCentricPosition.y +
-				  projectedTriangle.v2.color / projectedTriangle.v2.position.w * baryCentricPosition.z ) *
-				viewSpaceDepthInterpolated
-			};
-
-			const Vector2 interpolatedUV{
-				( projectedTriangle.v0.uv / projectedTriangle.v0.position.w * baryCentricPosition.x +
-				  projectedTriangle.v1.uv / projectedTriangle.v1.position.w * baryCentricPosition.y +
-				  projectedTriangle.v2.uv / projectedTriangle.v2.position.w * baryCentricPosition.z ) *
-				viewSpaceDepthInterpolated
-			};
-
-			interpolatedNormal.x = projectedTriangle.v0.normal.x * baryCentricPosition.x +
-								   projectedTriangle.v1.normal.x * baryCentricPosition.y +
-								   projectedTriangle.v2.normal.x * baryCentricPosition.z;
-			interpolatedNormal.y = projectedTriangle.v0.normal.y * baryCentricPosition.x +
-								   projectedTriangle.v1.normal.y * baryCentricPosition.y +
-								   projectedTriangle.v2.normal.y * baryCentricPosition.z;
-			interpolatedNormal.z = projectedTriangle.v0.normal.z * baryCentricPosition.x +
-								   projectedTriangle.v1.normal.z * baryCentricPosition.y +
-								   projectedTriangle.v2.normal.z * baryCentricPosition.z;
-			interpolatedNormal.Normalize();
-
-			interpolatedTangent.x = projectedTriangle.v0.tangent.x * baryCentricPosition.x +
-									projectedTriangle.v1.tangent.x * baryCentricPosition.y +
-									projectedTriangle.v2.tangent.x * baryCentricPosition.z;
-			interpolatedTangent.y = projectedTriangle.v0.tangent.y * baryCentricPosition.x +
-									projectedTriangle.v1.tangent.y * baryCentricPosition.y +
-									projectedTriangle.v2.tangent.y * baryCentricPosition.z;
-			interpolatedTangent.z = projectedTriangle.v0.tangent.z * baryCentricPosition.x +
-									projectedTriangle.v1.tangent.z * baryCentricPosition.y +
-									projectedTriangle.v2.tangent.z * baryCentricPosition.z;
-			interpolatedTangent.Normalize();
-
-			VertexOut interpolatedVertex{ interpolatedPosition, interpolatedWorldPosition, interpolatedColor,
-										  interpolatedUV,		interpolatedNormal,		   interpolatedTangent };
-
-			m_PixelAttributeBuffer[bufferIndex].first = true;
-			m_PixelAttributeBuffer[bufferIndex].second = interpolatedVertex;
-		} };
+			SDL_UnlockTexture( m_pStreamingTexture );
+		}
+
+		// Padded or unlockable texture: the rasterizer expects tightly packed rows
+		std::cout << "Streaming texture unusable, falling back to blit\n";
+		StopStreaming();
+		m_PresentMode = PresentMode::blit;
+		break;
+	}
 
-		const int pixelBoundsLeft{ static_cast<int>( std::floor( projectedTriangleBounds.left ) ) };
-		const int pixelBoundsRight{ static_cast<int>( std::ceil( projectedTriangleBounds.right ) ) };
-		const int pixelBoundsTop{ static_cast<int>( std::floor( projectedTriangleBounds.top ) ) };
-		const int pixelBoundsBottom{ static_cast<int>( std::ceil( projectedTriangleBounds.bottom ) ) };
+	case PresentMode::threaded:
+	{
+		// Plain memory surfaces, nothing to lock
+		const uint64_t frameIdx{ m_SubmittedFrameCount };
+		SDL_Surface* pFrame{ m_pPresentFrames[frameIdx % presentFrameCount] };
 
-		// RASTERIZATION
-		for ( int px{ pixelBoundsLeft }; px < pixelBoundsRight; ++px )
+		// The slot holds the frame from two ago, whatever this one does not redraw comes from the last one
+		if ( !frameIdx )
+		{
+			m_IsPreviousFrameReadable = false;
+		}
+		else if ( m_IsPreviousFrameReadable )
 		{
-			for ( int py{ pixelBoundsTop }; py < pixelBoundsBottom; ++py )
+			const SDL_Surface* pPreviousFrame{ m_pPresentFrames[( frameIdx - 1 ) % presentFrameCount] };
+			m_pPreviousSlotPixels = reinterpret_cast<const uint32_t*>( pPreviousFrame->pixels );
+
+			// Whole rows above and below the redraw, the columns left and right of it in between
+			const PixelRect redrawRect{ IsUpscaling() ? GetUpscaledRect( m_ScissorRect ) : m_ScissorRect };
+			const size_t pitch{ static_cast<size_t>( pFrame->pitch ) };
+			uint8_t* pDst{ static_cast<uint8_t*>( pFrame->pixels ) };
+			const uint8_t* pSrc{ static_cast<const uint8_t*>( pPreviousFrame->pixels ) };
+			std::memcpy( pDst, pSrc, pitch * redrawRect.top );
+			std::memcpy( pDst + pitch * redrawRect.bottom,
+						 pSrc + pitch * redrawRect.bottom,
+						 pitch * ( pFrame->h - redrawRect.bottom ) );
+			const size_t leftBytes{ redrawRect.left * sizeof( uint32_t ) };
+			const size_t rightOffset{ redrawRect.right * sizeof( uint32_t ) };
+			const size_t rightBytes{ ( pFrame->w - redrawRect.right ) * sizeof( uint32_t ) };
+			for ( int py{ redrawRect.top }; py < redrawRect.bottom; ++py )
 			{
-				processPixel( px, py );
+				std::memcpy( pDst + pitch * py, pSrc + pitch * py, leftBytes );
+				std::memcpy( pDst + pitch * py + rightOffset, pSrc + pitch * py + rightOffset, rightBytes );
 			}
 		}
 
-		goToNextTriangleIndex();
+		m_pBackBufferPixels = reinterpret_cast<uint32_t*>( pFrame->pixels );
+		m_pPixelFormat = pFrame->format;
+		return;
 	}
 
-	for ( int px{}; px < m_Width; ++px )
-	{
-		for ( int py{}; py < m_Height; ++py )
-		{
-			const int bufferIndex{ px + ( py * m_Width ) };
+	default:
+		break;
+	}
 
-			if ( !m_PixelAttributeBuffer[bufferIndex].first )
-			{
-				continue;
-			}
-			if ( m_ShowDepthBuffer )
-			{
-				constexpr float depthMin{ 0.9985f };
-				constexpr float depthMax{ 1.f };
-				const float remappedDepth{ std::max(
-					1.f - ( m_DepthBufferPixels[bufferIndex] - depthMin ) / ( depthMax - depthMin ), 0.f ) };
-				ColorRGB finalColor{ remappedDepth, remappedDepth, remappedDepth };
+	SDL_LockSurface( m_pBackBuffer );
+	m_pBackBufferPixels = reinterpret_cast<uint32_t*>( m_pBackBuffer->pixels );
+	m_pPixelFormat = m_pBackBuffer->format;
+}
 
-				finalColor.MaxToOne();
+void Renderer::PresentSW( const PixelRect& presentRect )
+{
+	SDL_Rect windowRect{ presentRect.left,
+						 presentRect.top,
+						 presentRect.GetWidth(),
+						 presentRect.bottom - presentRect.top };
 
-				m_pBackBufferPixels[bufferIndex] = SDL_MapRGB( m_pBackBuffer->format,
-															   static_cast<uint8_t>( finalColor.r * 255 ),
-															   static_cast<uint8_t>( finalColor.g * 255 ),
-															   static_cast<uint8_t>( finalColor.b * 255 ) );
+	switch ( m_PresentMode )
+	{
+	case PresentMode::blit:
+		SDL_UnlockSurface( m_pBackBuffer );
+		if ( m_pWindow ) // Headless keeps the frame in the back buffer
+		{
+			SDL_Rect destinationRect{ windowRect }; // Gets clipped in place by the blit
+			SDL_BlitSurface( m_pBackBuffer, &windowRect, m_pFrontBuffer, &destinationRect );
+			SDL_UpdateWindowSurfaceRects( m_pWindow, &windowRect, 1 );
+		}
+		break;
 
-				continue;
-			}
+	case PresentMode::direct:
+		SDL_UnlockSurface( m_pFrontBuffer );
+		SDL_UpdateWindowSurfaceRects( m_pWindow, &windowRect, 1 );
+		break;
 
-			const ColorRGB finalColor{ GetPixelColor( m_PixelAttributeBuffer[bufferIndex].second,
-													  mesh.GetDiffuseMap(),
-													  mesh.GetNormalMap(),
-													  mesh.GetSpecularMap(),
-													  mesh.GetGlossMap(),
-													  camera,
-													  pScene->GetLightDirection(),
-													  m_LightingMode,
-													  m_UseNormalMap ) };
+	case PresentMode::streaming:
+		SDL_UnlockTexture( m_pStreamingTexture );
+		SDL_RenderCopy( m_pSDLRenderer, m_pStreamingTexture, nullptr, nullptr );
+		SDL_RenderPresent( m_pSDLRenderer );
+		break;
 
-			m_pBackBufferPixels[bufferIndex] = SDL_MapRGB( m_pBackBuffer->format,
-														   static_cast<uint8_t>( finalColor.r * 255 ),
-														   static_cast<uint8_t>( finalColor.g * 255 ),
-														   static_cast<uint8_t>( finalColor.b * 255 ) );
-		}
+	case PresentMode::threaded:
+		// Always the whole frame, shown by the next one while it rasterizes
+		++m_SubmittedFrameCount;
+		break;
+
+	default:
+		break;
 	}
 }
 
-void Renderer::Project( const std::vector<Vertex>& verticesIn,
-						std::vector<VertexOut>& verticesOut,
-						const Camera& camera,
-						const Matrix& modelToWorld,
-						const Matrix& worldToCamera ) const noexcept
-{
-	verticesOut.clear();
-	verticesOut.reserve( verticesIn.size() );
-
-	std::vector<uint32_t> vertexIndices{};
-	vertexIndices.reserve( verticesIn.size() );
-	for ( size_t index{}; index < verticesIn.size(); ++index )
-	{
-		verticesOut.push_back( {} );
-		vertexIndices.push_back( index );
-	}
-
-	auto projectVertex{ [&]( const uint32_t index ) {
-		const Vertex& vertexIn{ verticesIn[index] };
-		VertexOut vertexOut{};
-		vertexOut.uv = vertexIn.uv;
-
-		// World transform
-		vertexOut.worldPosition = modelToWorld.TransformPoint( vertexIn.position );
-		vertexOut.position = vertexOut.worldPosition.ToPoint4();
-		vertexOut.normal = modelToWorld.TransformVector( vertexIn.normal ).Normalized();
-		vertexOut.tangent = modelToWorld.TransformVector( vertexIn.tangent ).Normalized();
-
-		// Camera transform
-		vertexOut.position = worldToCamera.TransformPoint( vertexOut.position );
-		// vertexOut.normal = worldToCamera.TransformVector( vertexOut.normal );
-
-		// Projection matrix
-		const float aspectRatio{ static_cast<float>( m_Width ) / m_Height };
-		const float a{ camera.GetFar() / ( camera.GetFar() - camera.GetNear() ) }; // Depends on coordinate system
-		const float b{ -( camera.GetFar() * camera.GetNear() ) / ( camera.GetFar() - camera.GetNear() ) };
-		Matrix projectionMatrix{
-			{ 1.f / ( aspectRatio * camera.GetFov() ), 0.f, 0.f, 0.f },
-			{ 0.f, 1.f / camera.GetFov(), 0.f, 0.f },
-			{ 0.f, 0.f, a, 1.f },
-			{ 0.f, 0.f, b, 0.f },
-		};
-		vertexOut.position = projectionMatrix.TransformPoint( vertexOut.position );
-
-		// Perspective divide
-		vertexOut.position.x /= vertexOut.position.w;
-		vertexOut.position.y /= vertexOut.position.w;
-		vertexOut.position.z /= vertexOut.position.w;
-
-		// To screenspace
-		vertexOut.position.x = ( 1.f + vertexOut.position.x ) * 0.5f * m_Width;
-		vertexOut.position.y = ( 1.f - vertexOut.position.y ) * 0.5f * m_Height;
-
-		verticesOut[index] = vertexOut;
-	} };
-
-#ifdef PARALLEL_PROJECT
-	std::for_each( std::execution::par, vertexIndices.begin(), vertexIndices.end(), projectVertex );
-#endif
-#ifndef PARALLEL_PROJECT
-	for ( const auto& vertexIndex : vertexIndices )
+void Renderer::PresentPreviousFrameSW()
+{
+	switch ( m_PresentMode )
 	{
-		projectVertex( vertexIndex );
+	case PresentMode::blit:
+	case PresentMode::direct:
+		// The window surface still holds the last frame
+		if ( m_pWindow )
+		{
+			SDL_UpdateWindowSurface( m_pWindow );
+		}
+		break;
+
+	case PresentMode::streaming:
+		// Not locked, so the texture keeps the last upload, presenting still waits for vsync
+		SDL_RenderCopy( m_pSDLRenderer, m_pStreamingTexture, nullptr, nullptr );
+		SDL_RenderPresent( m_pSDLRenderer );
+		break;
+
+	case PresentMode::threaded:
+		// No frame rasterizes to overlap with, the last one would otherwise stay queued
+		PresentQueuedFrame();
+		break;
+
+	default:
+		break;
 	}
-#endif
 }
 
-bool Renderer::IsInPixel( const TriangleOut& triangle, int px, int py, Vector3& baryCentricPosition ) noexcept
+bool Renderer::CreatePresentFrames()
 {
-	const Vector2 screenSpace{ px + 0.5f, py + 0.5f };
+	if ( !m_pWindow || !m_pFrontBuffer )
+	{
+		return false;
+	}
 
-	const std::array<Vector2, 3> triangle2d{ triangle.v0.position.GetXY(),
-											 triangle.v1.position.GetXY(),
-											 triangle.v2.position.GetXY() };
+	for ( SDL_Surface*& pFrame : m_pPresentFrames )
+	{
+		pFrame = SDL_CreateRGBSurfaceWithFormat( 0, m_Width, m_Height, 32, m_pBackBuffer->format->format );
+		if ( !pFrame )
+		{
+			std::cout << "Could not create present frames: " << SDL_GetError() << "\n";
+			DestroyPresentFrames();
+			return false;
+		}
+	}
 
-	std::array<float, 3> baryBuffer{};
-	const float parallelogramArea{ Vector2::Cross( ( triangle2d[1] - triangle2d[0] ),
-												   ( triangle2d[2] - triangle2d[0] ) ) };
+	m_SubmittedFrameCount = 0;
+	m_PresentedFrameCount = 0;
+	return true;
+}
 
-	// Prevent floating point precision error-based crashes
-	// This area being 0 or lower could pose issues later down the line
-	if ( parallelogramArea <= 0.f )
+void Renderer::DestroyPresentFrames()
+{
+	for ( SDL_Surface*& pFrame : m_pPresentFrames )
 	{
-		return false;
+		if ( pFrame )
+		{
+			SDL_FreeSurface( pFrame );
+			pFrame = nullptr;
+		}
 	}
+}
 
-	for ( int offset{}; offset < 3; ++offset )
+void Renderer::PresentQueuedFrame()
+{
+	if ( m_PresentedFrameCount == m_SubmittedFrameCount )
 	{
-		int nextOffset{ ( offset + 1 ) % 3 };
-		const Vector2 vertex{ triangle2d[offset] };
-		const Vector2 nextVertex{ triangle2d[nextOffset] };
-		const Vector2 edgeVector{ nextVertex - vertex };
-		const Vector2 vertexToPixel{ screenSpace - vertex };
+		return;
+	}
 
-		const float signedArea{ Vector2::Cross( edgeVector, vertexToPixel ) };
+	PROFILE_ZONE( "PresentFrame" );
+	SDL_BlitSurface( m_pPresentFrames[( m_SubmittedFrameCount - 1 ) % presentFrameCount], nullptr, m_pFrontBuffer, nullptr );
+	SDL_UpdateWindowSurface( m_pWindow );
+	m_PresentedFrameCount = m_SubmittedFrameCount;
+}
 
-		if ( signedArea < 0.f )
+PixelRect Renderer::UpdateDirtyRect( const Scene* pScene )
+{
+	const PixelRect screenRect{ 0, 0, m_RenderWidth, m_RenderHeight };
+	const Camera& camera{ pScene->GetCamera() };
+	const auto& meshes{ pScene->GetMeshes() };
+	const auto& transparentMeshes{ pScene->GetTransparentMeshes() };
+
+	const bool isFrameReusable{ m_UseIncrementalRendering && m_IsFrameValid && m_pFrameScene == pScene &&
+								m_FrameCameraVersion == camera.GetVersion() &&
+								m_FrameSceneVersion == pScene->GetStateVersion() &&
+								m_MeshFrameStates.size() == meshes.size() &&
+								m_TransparentMeshFrameStates.size() == transparentMeshes.size() };
+	m_IsFrameValid = true;
+	m_pFrameScene = pScene;
+	m_FrameCameraVersion = camera.GetVersion();
+	m_FrameSceneVersion = pScene->GetStateVersion();
+	m_MeshFrameStates.resize( meshes.size() );
+	m_TransparentMeshFrameStates.resize( transparentMeshes.size() );
+
+	// A moved mesh uncovers its old area and covers its new one
+	PixelRect dirtyRect{ isFrameReusable ? PixelRect{} : screenRect };
+	const Frustum& frustum{ camera.GetFrustum() };
+	const Matrix viewProjection{ camera.GetViewMatrix() * GetProjectionMatrix( camera ) };
+	auto updateStates{ [&]( const auto& sceneMeshes, std::vector<MeshFrameState>& states ) {
+		for ( size_t meshIdx{}; meshIdx < sceneMeshes.size(); ++meshIdx )
 		{
-			return false;
+			const auto& mesh{ sceneMeshes[meshIdx] };
+			MeshFrameState& state{ states[meshIdx] };
+			if ( isFrameReusable && state.worldVersion == mesh.GetWorldVersion() )
+			{
+				continue;
+			}
+
+			const PixelRect screenBounds{ mesh.IsVisible( frustum )
+											  ? GetScreenBounds( mesh.GetWorldBounds(), viewProjection )
+											  : PixelRect{} };
+			dirtyRect = dirtyRect.Union( state.screenBounds ).Union( screenBounds );
+			state = { mesh.GetWorldVersion(), screenBounds };
 		}
-		else
+	} };
+	updateStates( meshes, m_MeshFrameStates );
+	updateStates( transparentMeshes, m_TransparentMeshFrameStates );
+
+	return dirtyRect.Intersection( screenRect );
+}
+
+PixelRect Renderer::GetScreenBounds( const BoundingBox& worldBounds, const Matrix& viewProjection ) const
+{
+	const PixelRect screenRect{ 0, 0, m_RenderWidth, m_RenderHeight };
+	float left{ std::numeric_limits<float>::max() };
+	float top{ std::numeric_limits<float>::max() };
+	float right{ std::numeric_limits<float>::lowest() };
+	float bottom{ std::numeric_limits<float>::lowest() };
+	for ( int cornerIdx{}; cornerIdx < 8; ++cornerIdx )
+	{
+		const Vector3 corner{ cornerIdx & 1 ? worldBounds.max.x : worldBounds.min.x,
+							  cornerIdx & 2 ? worldBounds.max.y : worldBounds.min.y,
+							  cornerIdx & 4 ? worldBounds.max.z : worldBounds.min.z };
+		const Vector4 projected{ viewProjection.TransformPoint( corner.ToPoint4() ) };
+
+		// Behind the camera the projection flips, the mesh could be anywhere on screen
+		if ( projected.w <= 0.f )
 		{
-			const int baryIndex{ ( offset + 2 ) % 3 };
-			baryBuffer[baryIndex] = signedArea / parallelogramArea;
-			continue;
+			return screenRect;
 		}
+
+		// Same screen mapping as Project
+		const float x{ ( 1.f + projected.x / projected.w ) * 0.5f * m_RenderWidth };
+		const float y{ ( 1.f - projected.y / projected.w ) * 0.5f * m_RenderHeight };
+		left = std::min( left, x );
+		top = std::min( top, y );
+		right = std::max( right, x );
+		bottom = std::max( bottom, y );
 	}
 
-	baryCentricPosition = { baryBuffer[0], baryBuffer[1], baryBuffer[2] };
+	// One pixel of margin for vertices that land just outside the box after rounding
+	const PixelRect bounds{ static_cast<int>( std::floor( std::max( left, -1.f ) ) ) - 1,
+							static_cast<int>( std::floor( std::max( top, -1.f ) ) ) - 1,
+							static_cast<int>( std::ceil( std::min( right, m_RenderWidth + 1.f ) ) ) + 1,
+							static_cast<int>( std::ceil( std::min( bottom, m_RenderHeight + 1.f ) ) ) + 1 };
+	return bounds.Intersection( screenRect );
+}
+
+void Renderer::InvalidateFrame()
+{
+	m_IsFrameValid = false;
+}
 
-	return true;
+bool Renderer::IsUpscaling() const
+{
+	return m_RenderWidth != m_Width || m_RenderHeight != m_Height;
 }
 
-bool Renderer::IsCullable( const TriangleOut& triangle ) noexcept
+void Renderer::ApplyRenderScale()
 {
-	// Backface culling
-	if ( triangle.normal.z > 0.f ) // positive Z is forward -> away from the screen
+	// Sizes only change in whole steps and only once the controller is more than a step away
+	// A load right between two steps would otherwise resize, and so redraw everything, every frame
+	constexpr float renderScaleStep{ 1.f / 32.f };
+	const float currentScale{ static_cast<float>( m_RenderWidth ) / m_Width };
+	float renderScale{ m_UseDynamicResolution ? m_RenderScale : 1.f };
+	if ( renderScale < 1.f && std::abs( renderScale - currentScale ) <= renderScaleStep )
 	{
-		return true;
+		return;
 	}
+	renderScale = std::round( renderScale / renderScaleStep ) * renderScaleStep;
 
-	// Frustum Culling
-	if ( triangle.v0.position.z > 1.f || triangle.v0.position.z < 0.f )
+	const int renderWidth{ std::clamp( static_cast<int>( std::round( m_Width * renderScale ) ), 1, m_Width ) };
+	const int renderHeight{ std::clamp( static_cast<int>( std::round( m_Height * renderScale ) ), 1, m_Height ) };
+	if ( renderWidth == m_RenderWidth && renderHeight == m_RenderHeight )
 	{
-		return true;
+		return;
 	}
-	if ( triangle.v1.position.z > 1.f || triangle.v1.position.z < 0.f )
-	{
+
+	m_RenderWidth = renderWidth;
+	m_RenderHeight = renderHeight;
+	ResizeRenderBuffers();
+}
+
+void Renderer::UpdateRenderScale( float frameTime )
+{
+	// Frame cost is mostly per pixel, so the scale per axis goes with the square root of the time ratio
+	constexpr float minRenderScale{ 0.25f };
+	constexpr float smoothing{ 0.25f }; // Of the error corrected per frame, keeps single spikes from showing
+
+	const float currentScale{ static_cast<float>( m_RenderWidth ) / m_Width };
+	const float targetScale{ currentScale * std::sqrt( m_FrameBudget / std::max( frameTime, 1e-6f ) ) };
+	m_RenderScale = std::clamp( m_RenderScale + ( targetScale - m_RenderScale ) * smoothing, minRenderScale, 1.f );
+}
+
+void Renderer::ResizeRenderBuffers()
+{
+	const int pixelCount{ m_RenderWidth * m_RenderHeight };
+	m_PixelAttributeBuffer.resize( pixelCount );
+	m_PixelCoverage.assign( pixelCount, 0 );
+	m_ScaledFrameBuffer.resize( IsUpscaling() ? pixelCount : 0 );
+	m_ShadingRates.assign(
+		GetShadingTileCountX() * ( ( m_RenderHeight + shadingTileSize - 1 ) / shadingTileSize ), 0 );
+	m_IsPreviousFrameReadable = false;
+	m_UpscaleRowScratch.resize( 2 * m_Width );
+	ResizeSampleBuffers();
+
+	// Nothing of the last frame lines up anymore
+	InvalidateFrame();
+}
+
+PixelRect Renderer::GetUpscaledRect( const PixelRect& renderRect ) const
+{
+	// Window pixels blend the two render pixels around them, so one render pixel of margin on each side
+	const PixelRect windowRect{ 0, 0, m_Width, m_Height };
+	const PixelRect upscaledRect{ ( renderRect.left - 1 ) * m_Width / m_RenderWidth,
+								  ( renderRect.top - 1 ) * m_Height / m_RenderHeight,
+								  ( ( renderRect.right + 1 ) * m_Width + m_RenderWidth - 1 ) / m_RenderWidth,
+								  ( ( renderRect.bottom + 1 ) * m_Height + m_RenderHeight - 1 ) / m_RenderHeight };
+	return upscaledRect.Intersection( windowRect );
+}
+
+bool Renderer::CanRenderDirect() const
+{
+	// The rasterizer indexes pixels as px + py * width, so rows must be tightly packed 32-bit
+	return m_pFrontBuffer && m_pFrontBuffer->format->BytesPerPixel == sizeof( uint32_t ) &&
+		   m_pFrontBuffer->pitch == m_Width * static_cast<int>( sizeof( uint32_t ) );
+}
+
+void Renderer::CreateStreamingResources()
+{
+	// An SDL renderer owns the window while it exists, so the window surface has to go
+	SDL_DestroyWindowSurface( m_pWindow );
+	m_pFrontBuffer = nullptr;
+
+	// Vsync makes the renderer flip between its own front and back buffer -> no tearing
+	m_pSDLRenderer = SDL_CreateRenderer( m_pWindow, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC );
+	if ( m_pSDLRenderer )
+	{
+		m_pStreamingTexture = SDL_CreateTexture(
+			m_pSDLRenderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, m_Width, m_Height );
+		m_pStreamingFormat = SDL_AllocFormat( SDL_PIXELFORMAT_ARGB8888 );
+	}
+
+	if ( !m_pStreamingTexture || !m_pStreamingFormat )
+	{
+		std::cout << "Could not create streaming texture: " << SDL_GetError() << "\n";
+		StopStreaming();
+	}
+}
+
+void Renderer::DestroyStreamingResources()
+{
+	if ( m_pStreamingFormat )
+	{
+		SDL_FreeFormat( m_pStreamingFormat );
+		m_pStreamingFormat = nullptr;
+	}
+
+	if ( m_pStreamingTexture )
+	{
+		SDL_DestroyTexture( m_pStreamingTexture );
+		m_pStreamingTexture = nullptr;
+	}
+
+	if ( m_pSDLRenderer )
+	{
+		SDL_DestroyRenderer( m_pSDLRenderer );
+		m_pSDLRenderer = nullptr;
+	}
+}
+
+void Renderer::StopStreaming()
+{
+	DestroyStreamingResources();
+
+	// Hand the window back to the surface based present modes
+	if ( !m_pFrontBuffer )
+	{
+		m_pFrontBuffer = SDL_GetWindowSurface( m_pWindow );
+	}
+}
+
+void Renderer::UpdateStreamingForBackend()
+{
+	// Only one swap chain may present to the window, the SDL renderer steps aside while hardware runs
+	if ( m_UseHardware && m_PresentMode == PresentMode::streaming )
+	{
+		StopStreaming();
+		m_PresentMode = PresentMode::blit;
+		m_ResumeStreaming = true;
+	}
+	else if ( !m_UseHardware && m_ResumeStreaming )
+	{
+		m_ResumeStreaming = false;
+		CreateStreamingResources();
+		if ( m_pStreamingTexture )
+		{
+			m_PresentMode = PresentMode::streaming;
+		}
+	}
+}
+
+void Renderer::CyclePresentMode()
+{
+	m_ResumeStreaming = false; // A mode picked while hardware runs replaces the paused one
+	if ( m_PresentMode == PresentMode::streaming )
+	{
+		StopStreaming();
+	}
+	else if ( m_PresentMode == PresentMode::threaded )
+	{
+		PresentQueuedFrame();
+		DestroyPresentFrames();
+	}
+
+	IncrementPresentMode();
+	if ( m_PresentMode == PresentMode::direct && !CanRenderDirect() )
+	{
+		IncrementPresentMode();
+	}
+
+	if ( m_PresentMode == PresentMode::streaming )
+	{
+		// The SDL renderer would present to the window beside the DXGI swap chain
+		if ( !m_UseHardware )
+		{
+			CreateStreamingResources();
+		}
+		if ( !m_pStreamingTexture )
+		{
+			IncrementPresentMode();
+		}
+	}
+
+	if ( m_PresentMode == PresentMode::threaded && !CreatePresentFrames() )
+	{
+		IncrementPresentMode();
+	}
+
+	switch ( m_PresentMode )
+	{
+	case PresentMode::blit:
+		std::cout << "Set present mode to blit\n";
+		break;
+
+	case PresentMode::direct:
+		std::cout << "Set present mode to direct\n";
+		break;
+
+	case PresentMode::streaming:
+		std::cout << "Set present mode to streaming\n";
+		break;
+
+	case PresentMode::threaded:
+		std::cout << "Set present mode to threaded\n";
+		break;
+
+	default:
+		break;
+	}
+}
+
+void Renderer::IncrementPresentMode()
+{
+	m_PresentMode = std::bit_cast<PresentMode, int>( ( std::bit_cast<int, PresentMode>( m_PresentMode ) + 1 ) %
+													 std::bit_cast<int, PresentMode>( PresentMode::count ) );
+}
+
+void Renderer::ShadeMesh( const Mesh& mesh )
+{
+	const auto shadeStart{ FrameClock::now() };
+
+	// Bands of whole shading tiles, so no block of variable rate shading straddles two jobs
+	constexpr size_t tileRowsPerJob{ 2 };
+	const int firstTileRow{ m_ScissorRect.top / shadingTileSize };
+	const int tileRowEnd{ ( m_ScissorRect.bottom + shadingTileSize - 1 ) / shadingTileSize };
+	m_pJobSystem->ParallelFor( tileRowEnd - firstTileRow, tileRowsPerJob, [&]( size_t firstBandRow, size_t bandRowEnd ) {
+		const PixelRect bandRect{ PixelRect{ m_ScissorRect.left,
+											 ( firstTileRow + static_cast<int>( firstBandRow ) ) * shadingTileSize,
+											 m_ScissorRect.right,
+											 ( firstTileRow + static_cast<int>( bandRowEnd ) ) * shadingTileSize }
+									  .Intersection( m_ScissorRect ) };
+		if ( m_UseVariableRateShading && !m_ShowDepthBuffer )
+		{
+			ShadeBlocks( mesh, bandRect );
+			return;
+		}
+
+		for ( int py{ bandRect.top }; py < bandRect.bottom; ++py )
+		{
+			const int rowEnd{ bandRect.right + py * m_RenderWidth };
+			for ( int pixelIndex{ bandRect.left + py * m_RenderWidth }; pixelIndex < rowEnd; ++pixelIndex )
+			{
+				const uint8_t coverage{ m_PixelCoverage[pixelIndex] };
+				if ( !coverage )
+				{
+					continue;
+				}
+
+				WriteSamples( pixelIndex, coverage, ShadePixel( mesh, m_PixelAttributeBuffer[pixelIndex] ) );
+				m_PixelCoverage[pixelIndex] = 0;
+			}
+		}
+	} );
+	m_FrameTimings.AddSince( RenderStage::shade, shadeStart );
+}
+
+void Renderer::ShadeBlocks( const Mesh& mesh, const PixelRect& rect )
+{
+	const int tileCountX{ GetShadingTileCountX() };
+	for ( int tileY{ rect.top / shadingTileSize }; tileY * shadingTileSize < rect.bottom; ++tileY )
+	{
+		for ( int tileX{ rect.left / shadingTileSize }; tileX * shadingTileSize < rect.right; ++tileX )
+		{
+			const int tileLeft{ tileX * shadingTileSize };
+			const int tileTop{ tileY * shadingTileSize };
+			const PixelRect tileRect{
+				PixelRect{ tileLeft, tileTop, tileLeft + shadingTileSize, tileTop + shadingTileSize }.Intersection(
+					rect ) };
+			const int blockSize{ 1 << m_ShadingRates[tileX + tileY * tileCountX] };
+
+			// Blocks stay aligned to the tile, so the same pixels share a shade no matter what the scissor cuts off
+			for ( int blockTop{ tileTop }; blockTop < tileTop + shadingTileSize; blockTop += blockSize )
+			{
+				for ( int blockLeft{ tileLeft }; blockLeft < tileLeft + shadingTileSize; blockLeft += blockSize )
+				{
+					const PixelRect blockRect{
+						PixelRect{ blockLeft, blockTop, blockLeft + blockSize, blockTop + blockSize }.Intersection(
+							tileRect ) };
+
+					// The first covered pixel shades the block, every covered pixel keeps its own coverage
+					bool isShaded{ false };
+					uint32_t color{};
+					for ( int py{ blockRect.top }; py < blockRect.bottom; ++py )
+					{
+						for ( int px{ blockRect.left }; px < blockRect.right; ++px )
+						{
+							const int pixelIndex{ px + py * m_RenderWidth };
+							const uint8_t coverage{ m_PixelCoverage[pixelIndex] };
+							if ( !coverage )
+							{
+								continue;
+							}
+
+							if ( !isShaded )
+							{
+								color = ShadePixel( mesh, m_PixelAttributeBuffer[pixelIndex] );
+								isShaded = true;
+							}
+							WriteSamples( pixelIndex, coverage, color );
+							m_PixelCoverage[pixelIndex] = 0;
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+int Renderer::GetShadingTileCountX() const
+{
+	return ( m_RenderWidth + shadingTileSize - 1 ) / shadingTileSize;
+}
+
+void Renderer::UpdateShadingRates( bool hasPreviousFrame )
+{
+	const int tileCountX{ GetShadingTileCountX() };
+	const PixelRect renderRect{ 0, 0, m_RenderWidth, m_RenderHeight };
+	for ( int tileY{ m_ScissorRect.top / shadingTileSize }; tileY * shadingTileSize < m_ScissorRect.bottom; ++tileY )
+	{
+		for ( int tileX{ m_ScissorRect.left / shadingTileSize }; tileX * shadingTileSize < m_ScissorRect.right; ++tileX )
+		{
+			const int tileLeft{ tileX * shadingTileSize };
+			const int tileTop{ tileY * shadingTileSize };
+			const PixelRect tileRect{
+				PixelRect{ tileLeft, tileTop, tileLeft + shadingTileSize, tileTop + shadingTileSize }.Intersection(
+					renderRect ) };
+			m_ShadingRates[tileX + tileY * tileCountX] = hasPreviousFrame ? GetShadingRate( tileRect ) : 0;
+		}
+	}
+}
+
+uint8_t Renderer::GetShadingRate( const PixelRect& tileRect ) const
+{
+	// Smooth gradients like the vehicle paint stay under these, texture detail and highlights do not
+	constexpr int quarterRateLumaRange{ 6 }; // 4x4
+	constexpr int halfRateLumaRange{ 20 };	 // 2x2
+
+	const int sampleCount{ GetSampleCount() };
+	const uint8_t redShift{ m_pPixelFormat->Rshift };
+	const uint8_t greenShift{ m_pPixelFormat->Gshift };
+	const uint8_t blueShift{ m_pPixelFormat->Bshift };
+	int minLuma{ 255 };
+	int maxLuma{ 0 };
+	for ( int py{ tileRect.top }; py < tileRect.bottom; ++py )
+	{
+		for ( int px{ tileRect.left }; px < tileRect.right; ++px )
+		{
+			const int pixelIndex{ px + py * m_RenderWidth };
+
+			// Background or a silhouette: geometry may move in next frame and coarse edges would show
+			if ( m_DepthBufferPixels[pixelIndex * sampleCount] == std::numeric_limits<float>::max() )
+			{
+				return 0;
+			}
+
+			// Rec. 601 weights in eighths
+			const uint32_t pixel{ m_pPreviousFramePixels[pixelIndex] };
+			const int luma{ static_cast<int>( ( 2 * ( ( pixel >> redShift ) & 0xff ) +
+												5 * ( ( pixel >> greenShift ) & 0xff ) + ( ( pixel >> blueShift ) & 0xff ) ) >>
+											  3 ) };
+			minLuma = std::min( minLuma, luma );
+			maxLuma = std::max( maxLuma, luma );
+		}
+	}
+
+	const int lumaRange{ maxLuma - minLuma };
+	if ( lumaRange < quarterRateLumaRange )
+	{
+		return 2;
+	}
+	if ( lumaRange < halfRateLumaRange )
+	{
+		return 1;
+	}
+	return 0;
+}
+
+uint32_t Renderer::ShadePixel( const Mesh& mesh, const VertexOut& attributes )
+{
+	if ( m_ShowDepthBuffer )
+	{
+		constexpr float depthMin{ 0.9985f };
+		constexpr float depthMax{ 1.f };
+		const float remappedDepth{ std::max( 1.f - ( attributes.position.z - depthMin ) / ( depthMax - depthMin ),
+											 0.f ) };
+		ColorRGB finalColor{ remappedDepth, remappedDepth, remappedDepth };
+
+		finalColor.MaxToOne();
+
+		return SDL_MapRGB( m_pPixelFormat,
+						   static_cast<uint8_t>( finalColor.r * 255 ),
+						   static_cast<uint8_t>( finalColor.g * 255 ),
+						   static_cast<uint8_t>( finalColor.b * 255 ) );
+	}
+
+	const ColorRGB finalColor{ GetPixelColor( attributes,
+											  mesh.GetDiffuseMap(),
+											  mesh.GetNormalMap(),
+											  mesh.GetSpecularMap(),
+											  mesh.GetGlossMap(),
+											  m_Frame.camera,
+											  m_Frame.lightDirection,
+											  m_LightingMode,
+											  m_UseNormalMap,
+											  m_Frame.filterMode,
+											  m_MathPrecision ) };
+
+	return SDL_MapRGB( m_pPixelFormat,
+					   static_cast<uint8_t>( finalColor.r * 255 ),
+					   static_cast<uint8_t>( finalColor.g * 255 ),
+					   static_cast<uint8_t>( finalColor.b * 255 ) );
+}
+
+void Renderer::WriteSamples( int pixelIndex, uint8_t coverage, uint32_t color )
+{
+	const int sampleCount{ GetSampleCount() };
+	uint32_t* pSamples{ m_pSampleColors + pixelIndex * sampleCount };
+	for ( int sampleIdx{}; sampleIdx < sampleCount; ++sampleIdx )
+	{
+		if ( coverage & ( 1u << sampleIdx ) )
+		{
+			pSamples[sampleIdx] = color;
+		}
+	}
+}
+
+uint8_t Renderer::GetSampleCoverage(
+	const TriangleOut& triangle, int px, int py, bool writeDepth, Vector3& baryCentricPosition )
+{
+	// Single sampling is just one sample in the pixel center
+	constexpr float centerOffset{ 0.5f };
+	const int sampleCount{ GetSampleCount() };
+	const float* pOffsetsX{ m_UseMultisampling ? msaaSampleOffsetsX.data() : &centerOffset };
+	const float* pOffsetsY{ m_UseMultisampling ? msaaSampleOffsetsY.data() : &centerOffset };
+	float* pSampleDepths{ m_DepthBufferPixels.data() + ( px + py * m_RenderWidth ) * sampleCount };
+
+	uint8_t coverage{};
+	for ( int sampleIdx{}; sampleIdx < sampleCount; ++sampleIdx )
+	{
+		const Vector2 samplePosition{ px + pOffsetsX[sampleIdx], py + pOffsetsY[sampleIdx] };
+		Vector3 sampleBaryCentricPosition{};
+		if ( !GetBarycentricWeights( triangle, samplePosition, sampleBaryCentricPosition ) )
+		{
+			return 0;
+		}
+		if ( sampleBaryCentricPosition.x < 0.f || sampleBaryCentricPosition.y < 0.f ||
+			 sampleBaryCentricPosition.z < 0.f )
+		{
+			continue;
+		}
+
+		const float sampleDepth{ 1.f / ( ( 1.f / triangle.v0.position.z ) * sampleBaryCentricPosition.x +
+										 ( 1.f / triangle.v1.position.z ) * sampleBaryCentricPosition.y +
+										 ( 1.f / triangle.v2.position.z ) * sampleBaryCentricPosition.z ) };
+
+		// Writing: less equal, opaque meshes drawn again over themselves stay visible
+		// Not writing: less, like the transparent depth state
+		float& depthSample{ pSampleDepths[sampleIdx] };
+		if ( writeDepth ? sampleDepth > depthSample : sampleDepth >= depthSample )
+		{
+			continue;
+		}
+		if ( writeDepth )
+		{
+			depthSample = sampleDepth;
+		}
+
+		coverage |= static_cast<uint8_t>( 1u << sampleIdx );
+		baryCentricPosition = sampleBaryCentricPosition;
+	}
+
+	// Attributes come from the pixel center even when only an edge sample is covered, like hardware multisampling
+	if ( coverage && m_UseMultisampling )
+	{
+		GetBarycentricWeights( triangle, { px + 0.5f, py + 0.5f }, baryCentricPosition );
+	}
+	return coverage;
+}
+
+int Renderer::GetSampleCount() const
+{
+	return m_UseMultisampling ? msaaSampleCount : 1;
+}
+
+void Renderer::ResizeSampleBuffers()
+{
+	const int sampleCount{ GetSampleCount() };
+	m_DepthBufferPixels.assign( m_RenderWidth * m_RenderHeight * sampleCount, std::numeric_limits<float>::max() );
+	m_SampleColorBuffer.assign( m_UseMultisampling ? m_RenderWidth * m_RenderHeight * sampleCount : 0, 0 );
+	m_SampleColorBuffer.shrink_to_fit();
+	m_BlendSourceRow.assign( m_RenderWidth * sampleCount, 0 );
+	m_BlendAlphaRow.assign( m_RenderWidth * sampleCount, 0 );
+}
+
+int Renderer::GetBinTileCountX() const
+{
+	return ( m_RenderWidth + binTileSize - 1 ) / binTileSize;
+}
+
+void Renderer::ResetFrameArena()
+{
+	m_FrameGraph.Clear();
+
+	// Moving in an empty vector on the same arena drops the old buffer without freeing it
+	m_FrameCopies = std::pmr::vector<FrameCopy>{ &m_FrameArena };
+	for ( TriangleBins& bins : m_TriangleBins )
+	{
+		bins.triangles = std::pmr::vector<TriangleOut>{ &m_FrameArena };
+		bins.triangleBounds = std::pmr::vector<PixelRect>{ &m_FrameArena };
+		bins.tiles = std::pmr::vector<std::pmr::vector<uint32_t>>{ &m_FrameArena };
+	}
+
+	m_FrameArena.Reset();
+}
+
+void Renderer::ProjectCopy( const FrameCopy& copy )
+{
+	const auto projectStart{ FrameClock::now() };
+	const Mesh& mesh{ *copy.pMesh };
+	const Camera& camera{ m_Frame.camera };
+	const Matrix& worldToCamera{ camera.GetViewMatrix() };
+	if ( mesh.HasMeshlets() )
+	{
+		// Only meshlets that can end up on screen get their vertices projected
+		GatherVisibleMeshlets( mesh, camera, copy.world, copy.lod );
+		Project( m_MeshletVertexBuffer, m_VertexOutBuffer, camera, copy.world, worldToCamera );
+		m_pCopyIndices = &m_MeshletIndexBuffer;
+		m_CopyIndexRange = { 0, static_cast<UINT>( m_MeshletIndexBuffer.size() ) };
+	}
+	else
+	{
+		Project( mesh.GetVertexStreams(), m_VertexOutBuffer, camera, copy.world, worldToCamera );
+		m_pCopyIndices = &mesh.GetIndices();
+		m_CopyIndexRange = mesh.GetLodIndices( copy.lod );
+	}
+	m_FrameTimings.AddSince( RenderStage::project, projectStart );
+}
+
+void Renderer::BinCopy( const FrameCopy& copy, TriangleBins& bins )
+{
+	const auto binStart{ FrameClock::now() };
+	const Mesh& mesh{ *copy.pMesh };
+	const int tileCountX{ GetBinTileCountX() };
+	const size_t tileCount{ static_cast<size_t>( tileCountX ) *
+							( ( m_RenderHeight + binTileSize - 1 ) / binTileSize ) };
+	bins.triangles.clear();
+	bins.triangleBounds.clear();
+	bins.tiles.resize( tileCount );
+	for ( std::pmr::vector<uint32_t>& tile : bins.tiles )
+	{
+		tile.clear();
+	}
+
+	// For every triangle in the range
+	const std::vector<UINT>& indices{ *m_pCopyIndices };
+	const IndexRange range{ m_CopyIndexRange };
+	const size_t rangeEnd{ range.firstIndex + range.indexCount };
+	for ( size_t index{ range.firstIndex }; index < rangeEnd; )
+	{
+		auto goToNextTriangleIndex{ [&]() {
+			// Increment differently based on topology
+			switch ( mesh.GetTopology() )
+			{
+				// changed after original handin to comply with DX11 topology type
+			case D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST:
+				index += 3;
+				break;
+
+			case D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP:
+				++index;
+				break;
+
+			default:
+				throw error::mesh::WrongTopology();
+				break;
+			}
+		} };
+
+		// Stop if at the end of strip
+		if ( index + 2 >= rangeEnd )
+		{
+			break;
+		}
+
+		// Construct triangle
+		TriangleOut projectedTriangle{};
+		switch ( mesh.GetTopology() )
+		{
+		case D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST:
+			projectedTriangle = TriangleOut{ m_VertexOutBuffer[indices[index + 0]],
+											 m_VertexOutBuffer[indices[index + 1]],
+											 m_VertexOutBuffer[indices[index + 2]] };
+			break;
+		case D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP:
+			// Check if mesh is correct size to be a strip
+			assert( mesh.GetIndexCount() > 6 && "Mesh has too few indices to be a strip" );
+			// Fix orientation for odd triangles
+			if ( ( index - range.firstIndex ) & 1 )
+			{
+				projectedTriangle = TriangleOut{ m_VertexOutBuffer[indices[index + 0]],
+												 m_VertexOutBuffer[indices[index + 2]],
+												 m_VertexOutBuffer[indices[index + 1]] };
+			}
+			else
+			{
+				projectedTriangle = TriangleOut{ m_VertexOutBuffer[indices[index + 0]],
+												 m_VertexOutBuffer[indices[index + 1]],
+												 m_VertexOutBuffer[indices[index + 2]] };
+			}
+			break;
+
+		default:
+			throw error::mesh::WrongTopology();
+			break;
+		}
+
+		if ( IsCullable( projectedTriangle ) )
+		{
+			goToNextTriangleIndex();
+			continue;
+		}
+
+		const Rectangle projectedTriangleBounds{ projectedTriangle.GetBounds() };
+		const PixelRect pixelBounds{ PixelRect{ static_cast<int>( std::floor( projectedTriangleBounds.left ) ),
+												static_cast<int>( std::floor( projectedTriangleBounds.top ) ),
+												static_cast<int>( std::ceil( projectedTriangleBounds.right ) ),
+												static_cast<int>( std::ceil( projectedTriangleBounds.bottom ) ) }
+										 .Intersection( m_ScissorRect ) };
+		if ( pixelBounds.IsEmpty() )
+		{
+			goToNextTriangleIndex();
+			continue;
+		}
+
+		// Into every tile its bounds touch
+		const uint32_t triangleIdx{ static_cast<uint32_t>( bins.triangles.size() ) };
+		bins.triangles.push_back( projectedTriangle );
+		bins.triangleBounds.push_back( pixelBounds );
+		for ( int tileY{ pixelBounds.top / binTileSize }; tileY * binTileSize < pixelBounds.bottom; ++tileY )
+		{
+			for ( int tileX{ pixelBounds.left / binTileSize }; tileX * binTileSize < pixelBounds.right; ++tileX )
+			{
+				bins.tiles[tileX + tileY * tileCountX].push_back( triangleIdx );
+			}
+		}
+
+		goToNextTriangleIndex();
+	}
+	m_FrameTimings.AddSince( RenderStage::bin, binStart );
+}
+
+void Renderer::RasterizeBins( const FrameCopy& copy, const TriangleBins& bins )
+{
+	const auto rasterStart{ FrameClock::now() };
+	const Mesh& mesh{ *copy.pMesh };
+
+	// Every tile owns its pixels, so tiles rasterize side by side and still see their triangles in order
+	const int tileCountX{ GetBinTileCountX() };
+	const int firstTileX{ m_ScissorRect.left / binTileSize };
+	const int firstTileY{ m_ScissorRect.top / binTileSize };
+	const int scissorTileCountX{ ( m_ScissorRect.right + binTileSize - 1 ) / binTileSize - firstTileX };
+	const int scissorTileCountY{ ( m_ScissorRect.bottom + binTileSize - 1 ) / binTileSize - firstTileY };
+	m_pJobSystem->ParallelFor(
+		static_cast<size_t>( scissorTileCountX * scissorTileCountY ), 1, [&]( size_t firstTile, size_t tileEnd ) {
+			for ( size_t scissorTileIdx{ firstTile }; scissorTileIdx < tileEnd; ++scissorTileIdx )
+			{
+				const int tileX{ firstTileX + static_cast<int>( scissorTileIdx ) % scissorTileCountX };
+				const int tileY{ firstTileY + static_cast<int>( scissorTileIdx ) / scissorTileCountX };
+				const PixelRect tileRect{ tileX * binTileSize,
+										  tileY * binTileSize,
+										  ( tileX + 1 ) * binTileSize,
+										  ( tileY + 1 ) * binTileSize };
+
+				// RASTERIZATION
+				for ( const uint32_t triangleIdx : bins.tiles[tileX + tileY * tileCountX] )
+				{
+					const TriangleOut& triangle{ bins.triangles[triangleIdx] };
+					const PixelRect pixelBounds{ bins.triangleBounds[triangleIdx].Intersection( tileRect ) };
+					for ( int py{ pixelBounds.top }; py < pixelBounds.bottom; ++py )
+					{
+						for ( int px{ pixelBounds.left }; px < pixelBounds.right; ++px )
+						{
+							RasterizePixel( mesh, triangle, px, py );
+						}
+					}
+				}
+			}
+		} );
+	m_FrameTimings.AddSince( RenderStage::raster, rasterStart );
+}
+
+void Renderer::RasterizePixel( const Mesh& mesh, const TriangleOut& triangle, int px, int py )
+{
+	Vector3 baryCentricPosition{};
+
+	const int bufferIndex{ px + ( py * m_RenderWidth ) };
+	if ( m_ShowBoundingBox )
+	{
+		const uint8_t allSamples{ static_cast<uint8_t>( ( 1u << GetSampleCount() ) - 1 ) };
+		const ColorRGB finalColor{ 1.f, 1.f, 1.f };
+		WriteSamples( bufferIndex,
+					  allSamples,
+					  SDL_MapRGB( m_pPixelFormat,
+								  static_cast<uint8_t>( finalColor.r * 255 ),
+								  static_cast<uint8_t>( finalColor.g * 255 ),
+								  static_cast<uint8_t>( finalColor.b * 255 ) ) );
+		return;
+	}
+
+	// Depth test per sample
+	const uint8_t coverage{ GetSampleCoverage( triangle, px, py, true, baryCentricPosition ) };
+	if ( !coverage )
+	{
+		return;
+	}
+
+	const float interpolatedDepth{ 1.f / ( ( 1.f / triangle.v0.position.z ) * baryCentricPosition.x +
+										   ( 1.f / triangle.v1.position.z ) * baryCentricPosition.y +
+										   ( 1.f / triangle.v2.position.z ) * baryCentricPosition.z ) };
+
+	const float viewSpaceDepthInterpolated{ 1.f / ( ( 1.f / triangle.v0.position.w ) * baryCentricPosition.x +
+													( 1.f / triangle.v1.position.w ) * baryCentricPosition.y +
+													( 1.f / triangle.v2.position.w ) * baryCentricPosition.z ) };
+
+	Vector4 interpolatedPosition{};
+	Vector3 interpolatedWorldPosition{};
+	Vector3 interpolatedNormal{};
+	Vector3 interpolatedTangent{};
+
+	// Interpolate
+	interpolatedPosition.x = triangle.v0.position.x * baryCentricPosition.x +
+							 triangle.v1.position.x * baryCentricPosition.y +
+							 triangle.v2.position.x * baryCentricPosition.z;
+	interpolatedPosition.y = triangle.v0.position.y * baryCentricPosition.x +
+							 triangle.v1.position.y * baryCentricPosition.y +
+							 triangle.v2.position.y * baryCentricPosition.z;
+	interpolatedPosition.w = triangle.v0.position.z * baryCentricPosition.x +
+							 triangle.v1.position.z * baryCentricPosition.y +
+							 triangle.v2.position.z * baryCentricPosition.z;
+	interpolatedPosition.z = interpolatedDepth;
+
+	interpolatedWorldPosition.x = triangle.v0.worldPosition.x * baryCentricPosition.x +
+								  triangle.v1.worldPosition.x * baryCentricPosition.y +
+								  triangle.v2.worldPosition.x * baryCentricPosition.z;
+	interpolatedWorldPosition.y = triangle.v0.worldPosition.y * baryCentricPosition.x +
+								  triangle.v1.worldPosition.y * baryCentricPosition.y +
+								  triangle.v2.worldPosition.y * baryCentricPosition.z;
+	interpolatedWorldPosition.z = triangle.v0.worldPosition.z * baryCentricPosition.x +
+								  triangle.v1.worldPosition.z * baryCentricPosition.y +
+								  triangle.v2.worldPosition.z * baryCentricPosition.z;
+
+	const ColorRGB interpolatedColor{
+		( triangle.v0.color / triangle.v0.position.w * baryCentricPosition.x +
+		  triangle.v1.color / triangle.v1.position.w * baryCentricPosition.y +
+		  triangle.v2.color / triangle.v2.position.w * baryCentricPosition.z ) *
+		viewSpaceDepthInterpolated
+	};
+
+	const Vector2 interpolatedUV{
+		( triangle.v0.uv / triangle.v0.position.w * baryCentricPosition.x +
+		  triangle.v1.uv / triangle.v1.position.w * baryCentricPosition.y +
+		  triangle.v2.uv / triangle.v2.position.w * baryCentricPosition.z ) *
+		viewSpaceDepthInterpolated
+	};
+
+	interpolatedNormal.x = triangle.v0.normal.x * baryCentricPosition.x +
+						   triangle.v1.normal.x * baryCentricPosition.y +
+						   triangle.v2.normal.x * baryCentricPosition.z;
+	interpolatedNormal.y = triangle.v0.normal.y * baryCentricPosition.x +
+						   triangle.v1.normal.y * baryCentricPosition.y +
+						   triangle.v2.normal.y * baryCentricPosition.z;
+	interpolatedNormal.z = triangle.v0.normal.z * baryCentricPosition.x +
+						   triangle.v1.normal.z * baryCentricPosition.y +
+						   triangle.v2.normal.z * baryCentricPosition.z;
+	fastMath::Normalize( interpolatedNormal, m_MathPrecision );
+
+	interpolatedTangent.x = triangle.v0.tangent.x * baryCentricPosition.x +
+							triangle.v1.tangent.x * baryCentricPosition.y +
+							triangle.v2.tangent.x * baryCentricPosition.z;
+	interpolatedTangent.y = triangle.v0.tangent.y * baryCentricPosition.x +
+							triangle.v1.tangent.y * baryCentricPosition.y +
+							triangle.v2.tangent.y * baryCentricPosition.z;
+	interpolatedTangent.z = triangle.v0.tangent.z * baryCentricPosition.x +
+							triangle.v1.tangent.z * baryCentricPosition.y +
+							triangle.v2.tangent.z * baryCentricPosition.z;
+	fastMath::Normalize( interpolatedTangent, m_MathPrecision );
+
+	VertexOut interpolatedVertex{ interpolatedPosition, interpolatedWorldPosition, interpolatedColor,
+								  interpolatedUV,		interpolatedNormal,		   interpolatedTangent };
+
+	// Samples the previous triangle keeps get its color now instead of being lost
+	// Each triangle is still shaded at most once per pixel, and not at all when fully covered
+	const uint8_t keptCoverage{ static_cast<uint8_t>( m_PixelCoverage[bufferIndex] & ~coverage ) };
+	if ( keptCoverage )
+	{
+		WriteSamples( bufferIndex, keptCoverage, ShadePixel( mesh, m_PixelAttributeBuffer[bufferIndex] ) );
+	}
+	m_PixelCoverage[bufferIndex] = coverage;
+	m_PixelAttributeBuffer[bufferIndex] = interpolatedVertex;
+}
+
+void Renderer::GatherVisibleMeshlets( const Mesh& mesh, const Camera& camera, const Matrix& world, uint8_t lod )
+{
+	PROFILE_FUNCTION();
+	const MeshletCullView view{ MeshletCullView::Create(
+		world, camera.GetViewMatrix() * camera.GetProjectionMatrix(), camera.GetPosition(), mesh.GetLocalBounds() ) };
+	const std::vector<Meshlet>& meshlets{ mesh.GetMeshlets() };
+	const MeshletRange& range{ mesh.GetLodMeshlets( lod ) };
+
+	m_VisibleMeshletBuffer.clear();
+	size_t vertexCount{};
+	for ( uint32_t meshletIdx{ range.firstMeshlet }; meshletIdx < range.firstMeshlet + range.meshletCount; ++meshletIdx )
+	{
+		if ( !IsMeshletCullable( meshlets[meshletIdx], view ) )
+		{
+			m_VisibleMeshletBuffer.push_back( meshletIdx );
+			vertexCount += meshlets[meshletIdx].vertexCount;
+		}
+	}
+
+	// Survivors are packed together, so projection stays one batch over contiguous streams
+	// Packed meshes get decoded here, only the vertices of meshlets that survived pay for it
+	const std::vector<uint8_t>& triangles{ mesh.GetMeshletTriangles() };
+	const bool isPacked{ mesh.GetVertexFormat() == VertexFormat::packed };
+	m_MeshletVertexBuffer.Resize( vertexCount );
+	m_MeshletIndexBuffer.clear();
+	UINT firstVertex{};
+	for ( const uint32_t meshletIdx : m_VisibleMeshletBuffer )
+	{
+		const Meshlet& meshlet{ meshlets[meshletIdx] };
+		if ( isPacked )
+		{
+			UnpackRange( mesh.GetPackedMeshletVertices(),
+						 meshlet.firstVertex,
+						 meshlet.vertexCount,
+						 mesh.GetPositionDequantization(),
+						 m_MeshletVertexBuffer,
+						 firstVertex );
+		}
+		else
+		{
+			streamUtils::CopyRange( mesh.GetMeshletVertexStreams(),
+									meshlet.firstVertex,
+									meshlet.vertexCount,
+									m_MeshletVertexBuffer,
+									firstVertex );
+		}
+
+		const size_t firstCorner{ meshlet.firstTriangle * size_t{ 3 } };
+		for ( size_t cornerIdx{}; cornerIdx < meshlet.triangleCount * size_t{ 3 }; ++cornerIdx )
+		{
+			m_MeshletIndexBuffer.push_back( firstVertex + triangles[firstCorner + cornerIdx] );
+		}
+		firstVertex += meshlet.vertexCount;
+	}
+}
+
+void Renderer::RasterizeTransparentMesh( const TransparentMesh& mesh, const Matrix& world )
+{
+	PROFILE_FUNCTION();
+	const auto projectStart{ FrameClock::now() };
+	Project( mesh.GetVertexStreams(), m_VertexOutBuffer, m_Frame.camera, world, m_Frame.camera.GetViewMatrix() );
+	m_FrameTimings.AddSince( RenderStage::project, projectStart );
+
+	const auto blendStart{ FrameClock::now() };
+
+	size_t indexStep{};
+	switch ( mesh.GetTopology() )
+	{
+	case D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST:
+		indexStep = 3;
+		break;
+
+	case D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP:
+		indexStep = 1;
+		break;
+
+	default:
+		throw error::mesh::WrongTopology();
+		break;
+	}
+
+	// Blending does not commute, so the triangles of a mesh go back to front just like the meshes themselves
+	// Triangles outside the view are dropped first, they would only make the sort longer
+	const std::vector<UINT>& indices{ mesh.GetIndices() };
+	m_BlendTriangles.clear();
+	for ( size_t index{}; index + 2 < indices.size(); index += indexStep )
+	{
+		const std::array<uint32_t, 3> vertexIndices{ indices[index], indices[index + 1], indices[index + 2] };
+		const VertexOut& v0{ m_VertexOutBuffer[vertexIndices[0]] };
+		const VertexOut& v1{ m_VertexOutBuffer[vertexIndices[1]] };
+		const VertexOut& v2{ m_VertexOutBuffer[vertexIndices[2]] };
+		if ( IsOutsideView( TriangleOut{ v0, v1, v2 } ) )
+		{
+			continue;
+		}
+
+		// w is the view depth and positive for anything in view, so the float bits order like the depths do
+		// Inverted -> ascending keys run far to near
+		const float depthSum{ v0.position.w + v1.position.w + v2.position.w };
+		m_BlendTriangles.push_back( { ~std::bit_cast<uint32_t>( depthSum ), vertexIndices } );
+	}
+	RadixSort( m_BlendTriangles, m_BlendTriangleSortBuffer, []( const BlendTriangle& triangle ) {
+		return triangle.sortKey;
+	} );
+
+	for ( const BlendTriangle& blendTriangle : m_BlendTriangles )
+	{
+		const VertexOut& v0{ m_VertexOutBuffer[blendTriangle.vertexIndices[0]] };
+		const VertexOut& v1{ m_VertexOutBuffer[blendTriangle.vertexIndices[1]] };
+		const VertexOut& v2{ m_VertexOutBuffer[blendTriangle.vertexIndices[2]] };
+
+		// No culling, like the hardware pass: back faces get flipped to the winding IsInPixel accepts
+		const float screenArea{ Vector2::Cross( v1.position.GetXY() - v0.position.GetXY(),
+												v2.position.GetXY() - v0.position.GetXY() ) };
+		const TriangleOut triangle{ screenArea < 0.f ? TriangleOut{ v0, v2, v1 } : TriangleOut{ v0, v1, v2 } };
+		RasterizeBlendedTriangle( triangle, mesh.GetDiffuseMap(), m_Frame.filterMode );
+	}
+	m_FrameTimings.AddSince( RenderStage::blend, blendStart );
+}
+
+void Renderer::RasterizeBlendedTriangle( const TriangleOut& triangle, const Texture& diffuseMap, FilterMode filterMode )
+{
+	const Rectangle triangleBounds{ triangle.GetBounds() };
+	const PixelRect pixelBounds{ PixelRect{ static_cast<int>( std::floor( triangleBounds.left ) ),
+											static_cast<int>( std::floor( triangleBounds.top ) ),
+											static_cast<int>( std::ceil( triangleBounds.right ) ),
+											static_cast<int>( std::ceil( triangleBounds.bottom ) ) }
+									 .Intersection( m_ScissorRect ) };
+	if ( pixelBounds.IsEmpty() )
+	{
+		return;
+	}
+	const int sampleCount{ GetSampleCount() };
+	const int spanWidth{ pixelBounds.GetWidth() * sampleCount };
+
+	// Row by row: fill the span with source samples and their alpha, then blend the whole span at once
+	for ( int py{ pixelBounds.top }; py < pixelBounds.bottom; ++py )
+	{
+		for ( int px{ pixelBounds.left }; px < pixelBounds.right; ++px )
+		{
+			const int spanIndex{ ( px - pixelBounds.left ) * sampleCount };
+			std::fill_n( m_BlendAlphaRow.begin() + spanIndex, sampleCount, 0 );
+
+			// Depth test less, the depth buffer is left as the opaque meshes wrote it
+			Vector3 baryCentricPosition{};
+			const uint8_t coverage{ GetSampleCoverage( triangle, px, py, false, baryCentricPosition ) };
+			if ( !coverage )
+			{
+				continue;
+			}
+
+			const float viewSpaceDepthInterpolated{ 1.f / ( ( 1.f / triangle.v0.position.w ) * baryCentricPosition.x +
+															( 1.f / triangle.v1.position.w ) * baryCentricPosition.y +
+															( 1.f / triangle.v2.position.w ) * baryCentricPosition.z ) };
+			const Vector2 interpolatedUV{ ( triangle.v0.uv / triangle.v0.position.w * baryCentricPosition.x +
+											triangle.v1.uv / triangle.v1.position.w * baryCentricPosition.y +
+											triangle.v2.uv / triangle.v2.position.w * baryCentricPosition.z ) *
+										  viewSpaceDepthInterpolated };
+
+			// Sampled once, blended into every covered sample
+			float alpha{};
+			const ColorRGB sampledColor{ diffuseMap.Sample( interpolatedUV, alpha, filterMode ) };
+			const uint32_t sourceColor{ SDL_MapRGB( m_pPixelFormat,
+													static_cast<uint8_t>( sampledColor.r * 255 ),
+													static_cast<uint8_t>( sampledColor.g * 255 ),
+													static_cast<uint8_t>( sampledColor.b * 255 ) ) };
+			const uint8_t sourceAlpha{ static_cast<uint8_t>( alpha * 255.f + 0.5f ) };
+			for ( int sampleIdx{}; sampleIdx < sampleCount; ++sampleIdx )
+			{
+				if ( coverage & ( 1u << sampleIdx ) )
+				{
+					m_BlendSourceRow[spanIndex + sampleIdx] = sourceColor;
+					m_BlendAlphaRow[spanIndex + sampleIdx] = sourceAlpha;
+				}
+			}
+		}
+
+		BlendSpan( m_pSampleColors + ( pixelBounds.left + py * m_RenderWidth ) * sampleCount,
+				   m_BlendSourceRow.data(),
+				   m_BlendAlphaRow.data(),
+				   spanWidth );
+	}
+}
+
+Matrix Renderer::GetProjectionMatrix( const Camera& camera ) const
+{
+	const float aspectRatio{ static_cast<float>( m_Width ) / m_Height };
+	const float a{ camera.GetFar() / ( camera.GetFar() - camera.GetNear() ) }; // Depends on coordinate system
+	const float b{ -( camera.GetFar() * camera.GetNear() ) / ( camera.GetFar() - camera.GetNear() ) };
+	return Matrix{
+		{ 1.f / ( aspectRatio * camera.GetFov() ), 0.f, 0.f, 0.f },
+		{ 0.f, 1.f / camera.GetFov(), 0.f, 0.f },
+		{ 0.f, 0.f, a, 1.f },
+		{ 0.f, 0.f, b, 0.f },
+	};
+}
+
+void Renderer::Project( const VertexStreams& verticesIn,
+						std::vector<VertexOut>& verticesOut,
+						const Camera& camera,
+						const Matrix& modelToWorld,
+						const Matrix& worldToCamera ) noexcept
+{
+	PROFILE_FUNCTION();
+	const size_t vertexCount{ verticesIn.Size() };
+	const Matrix worldViewProjection{ modelToWorld * worldToCamera * GetProjectionMatrix( camera ) };
+
+	// Transform every attribute as one batch
+	streamUtils::TransformPoints( modelToWorld, verticesIn.positions, m_WorldPositionStream );
+	streamUtils::TransformPoints( worldViewProjection, verticesIn.positions, m_ProjectedPositionStream );
+	streamUtils::TransformVectors( modelToWorld, verticesIn.normals, m_NormalStream );
+	streamUtils::Normalize( m_NormalStream );
+	streamUtils::TransformVectors( modelToWorld, verticesIn.tangents, m_TangentStream );
+	streamUtils::Normalize( m_TangentStream );
+
+	// Perspective divide + to screenspace, w keeps the view space depth
+	// Then gather back into the layout the rasterizer consumes, both in chunks spread over the job system
+	constexpr size_t verticesPerJob{ 4096 };
+	float* pPositionX{ m_ProjectedPositionStream.x.data() };
+	float* pPositionY{ m_ProjectedPositionStream.y.data() };
+	float* pPositionZ{ m_ProjectedPositionStream.z.data() };
+	const float* pPositionW{ m_ProjectedPositionStream.w.data() };
+	const float halfWidth{ 0.5f * m_RenderWidth };
+	const float halfHeight{ 0.5f * m_RenderHeight };
+	verticesOut.resize( vertexCount );
+	m_pJobSystem->ParallelFor( vertexCount, verticesPerJob, [&]( size_t firstVertex, size_t vertexEnd ) {
+		for ( size_t index{ firstVertex }; index < vertexEnd; ++index )
+		{
+			const float inverseW{ 1.f / pPositionW[index] };
+			pPositionX[index] = ( 1.f + pPositionX[index] * inverseW ) * halfWidth;
+			pPositionY[index] = ( 1.f - pPositionY[index] * inverseW ) * halfHeight;
+			pPositionZ[index] *= inverseW;
+		}
+
+		for ( size_t index{ firstVertex }; index < vertexEnd; ++index )
+		{
+			VertexOut& vertexOut{ verticesOut[index] };
+			vertexOut.position = m_ProjectedPositionStream.Get( index );
+			vertexOut.worldPosition = m_WorldPositionStream.Get( index );
+			vertexOut.color = {};
+			vertexOut.uv = verticesIn.uvs.Get( index );
+			vertexOut.normal = m_NormalStream.Get( index );
+			vertexOut.tangent = m_TangentStream.Get( index );
+		}
+	} );
+}
+
+bool Renderer::IsCullable( const TriangleOut& triangle ) noexcept
+{
+	// Backface culling
+	if ( triangle.normal.z > 0.f ) // positive Z is forward -> away from the screen
+	{
+		return true;
+	}
+
+	return IsOutsideView( triangle );
+}
+
+bool Renderer::IsOutsideView( const TriangleOut& triangle ) noexcept
+{
+	// Frustum Culling
+	if ( triangle.v0.position.z > 1.f || triangle.v0.position.z < 0.f )
+	{
+		return true;
+	}
+	if ( triangle.v1.position.z > 1.f || triangle.v1.position.z < 0.f )
+	{
 		return true;
 	}
 	if ( triangle.v2.position.z > 1.f || triangle.v2.position.z < 0.f )
@@ -647,27 +1923,27 @@ bool Renderer::IsCullable( const TriangleOut& triangle ) noexcept
 	}
 
 	// ScreenSpace Culling
-	if ( triangle.v0.position.x < 0.f || triangle.v0.position.x > m_Width )
+	if ( triangle.v0.position.x < 0.f || triangle.v0.position.x > m_RenderWidth )
 	{
 		return true;
 	}
-	if ( triangle.v1.position.x < 0.f || triangle.v1.position.x > m_Width )
+	if ( triangle.v1.position.x < 0.f || triangle.v1.position.x > m_RenderWidth )
 	{
 		return true;
 	}
-	if ( triangle.v2.position.x < 0.f || triangle.v2.position.x > m_Width )
+	if ( triangle.v2.position.x < 0.f || triangle.v2.position.x > m_RenderWidth )
 	{
 		return true;
 	}
-	if ( triangle.v0.position.y < 0.f || triangle.v0.position.y > m_Height )
+	if ( triangle.v0.position.y < 0.f || triangle.v0.position.y > m_RenderHeight )
 	{
 		return true;
 	}
-	if ( triangle.v1.position.y < 0.f || triangle.v1.position.y > m_Height )
+	if ( triangle.v1.position.y < 0.f || triangle.v1.position.y > m_RenderHeight )
 	{
 		return true;
 	}
-	if ( triangle.v2.position.y < 0.f || triangle.v2.position.y > m_Height )
+	if ( triangle.v2.position.y < 0.f || triangle.v2.position.y > m_RenderHeight )
 	{
 		return true;
 	}
@@ -677,7 +1953,85 @@ bool Renderer::IsCullable( const TriangleOut& triangle ) noexcept
 
 void Renderer::InitScene( Scene* pScene )
 {
-	pScene->Initialize( m_pDevice, ( static_cast<float>( m_Width ) / m_Height ) );
+	pScene->Initialize( m_pDevice, ( static_cast<float>( m_Width ) / m_Height ), m_AssetLoader );
+
+	// Without workers nothing loads beside the frames, so everything loads up front
+	if ( m_pJobSystem->GetThreadCount() == 1 )
+	{
+		FinishLoading( pScene );
+	}
+}
+
+void Renderer::FinishLoading( Scene* pScene )
+{
+	// Every load is done after waiting, applying a mesh can only queue maps that are already in
+	while ( pScene->IsLoading() )
+	{
+		m_AssetLoader.WaitIdle();
+		pScene->ApplyLoadedAssets( m_pDevice );
+	}
+}
+
+void Renderer::SetLightingMode( LightingMode lightingMode )
+{
+	m_LightingMode = lightingMode;
+	InvalidateFrame();
+}
+
+void Renderer::SetMultisampling( bool useMultisampling )
+{
+	m_UseMultisampling = useMultisampling;
+	ResizeSampleBuffers();
+	InvalidateFrame();
+}
+
+void Renderer::SetIncrementalRendering( bool useIncrementalRendering )
+{
+	m_UseIncrementalRendering = useIncrementalRendering;
+	InvalidateFrame();
+}
+
+void Renderer::SetDynamicResolution( bool useDynamicResolution )
+{
+	m_UseDynamicResolution = useDynamicResolution;
+	m_RenderScale = 1.f;
+}
+
+void Renderer::SetVariableRateShading( bool useVariableRateShading )
+{
+	m_UseVariableRateShading = useVariableRateShading;
+	InvalidateFrame();
+}
+
+void Renderer::SetFrameBudget( float milliseconds )
+{
+	m_FrameBudget = milliseconds / 1000.f;
+}
+
+void Renderer::SetMathPrecision( MathPrecision precision )
+{
+	m_MathPrecision = precision;
+	InvalidateFrame();
+}
+
+SDL_Surface* Renderer::GetFrameSurface() const
+{
+	return m_pBackBuffer;
+}
+
+const FrameTimings& Renderer::GetFrameTimings() const
+{
+	return m_FrameTimings;
+}
+
+void Renderer::InitializeSoftware( uint32_t pixelFormat )
+{
+	m_pBackBuffer = SDL_CreateRGBSurfaceWithFormat( 0, m_Width, m_Height, 32, pixelFormat );
+	m_pBackBufferPixels = reinterpret_cast<uint32_t*>( m_pBackBuffer->pixels );
+	m_pPixelFormat = m_pBackBuffer->format;
+	m_RenderWidth = m_Width;
+	m_RenderHeight = m_Height;
+	ResizeRenderBuffers();
 }
 
 void Renderer::InitializeDirectX()
@@ -12,16 +12,34 @@
 #include <d3dx11effect.h>
 
 // Framework Headers
+#include <array>
+#include <functional>
 #include "Timer.h"
 #include "Scene.h"
 #include "Shading.h"
+#include "AssetLoader.h"
+#include "FrameTimings.h"
+#include "FrameArena.h"
+#include "JobSystem.h"
+#include "Rasterization.h"
+#include "VectorStream.h"
 
 namespace dae
 {
+enum class PresentMode
+{
+	blit,	   // Rasterize into an offscreen surface, then blit to the window surface
+	direct,	   // Rasterize straight into the window surface
+	streaming, // Rasterize into a locked streaming texture, presented with vsync
+	threaded,  // Rasterize into one of two offscreen frames, the main thread blits one while the workers fill the other
+	count,
+};
+
 class Renderer final
 {
 public:
-	Renderer( SDL_Window* pWindow );
+	Renderer( SDL_Window* pWindow, JobSystem& jobSystem );
+	Renderer( int width, int height, JobSystem& jobSystem ); // Headless: software only, renders into an offscreen surface
 	~Renderer() noexcept;
 
 	Renderer( const Renderer& ) = delete;
@@ -32,11 +50,28 @@ public:
 	void Update( const Timer& timer );
 	void HandleKeyUp( SDL_KeyboardEvent key );
 
-	void Render( Scene* pScene );
+	// update gets the scene ready for the next frame, software runs it on this thread beside the frame's tasks
+	// Hardware renders first and updates after
+	void Render( Scene* pScene, const std::function<void()>& update = {} );
 	void RenderHW( Scene* pScene );
-	void RenderSW( Scene* pScene );
+	void RenderSW( Scene* pScene, const std::function<void()>& update );
 
+	// Starts loading the scene, Render swaps in what finished before every frame
 	void InitScene( Scene* pScene );
+	void FinishLoading( Scene* pScene ); // Blocks until the scene has every asset, for renders that must match
+
+	// Setters
+	void SetLightingMode( LightingMode lightingMode );
+	void SetMathPrecision( MathPrecision precision );
+	void SetMultisampling( bool useMultisampling ); // 4x in software, hardware is unaffected
+	void SetIncrementalRendering( bool useIncrementalRendering ); // Software only redraws what moved
+	void SetDynamicResolution( bool useDynamicResolution );		  // Software render size follows the frame budget
+	void SetFrameBudget( float milliseconds );
+	void SetVariableRateShading( bool useVariableRateShading ); // Software shades flat areas once per 2x2 or 4x4
+
+	// Getters
+	SDL_Surface* GetFrameSurface() const; // Last software frame when presenting through blit
+	const FrameTimings& GetFrameTimings() const; // Per-stage times of the last software frame
 
 private:
 	int m_Width{};
@@ -50,6 +85,12 @@ private:
 	SDL_Window* m_pWindow{};
 	//
 
+	// JOBS: NON-OWNING
+	JobSystem* m_pJobSystem{};
+	//
+
+	AssetLoader m_AssetLoader{ *m_pJobSystem };
+
 	// HARDWARE RESOURCES: OWNING
 	ID3D11Device* m_pDevice{};
 	ID3D11DeviceContext* m_pDeviceContext{};
@@ -70,36 +111,225 @@ private:
 	void InitializeDirectX();
 	//
 
+	void InitializeSoftware( uint32_t pixelFormat );
+
 	// SOFTWARE RENDERER
 	SDL_Surface* m_pFrontBuffer{ nullptr };
 	SDL_Surface* m_pBackBuffer{ nullptr };
 	uint32_t* m_pBackBufferPixels{};
+	const SDL_PixelFormat* m_pPixelFormat{}; // Format of whatever m_pBackBufferPixels points to this frame
+
+	PresentMode m_PresentMode{ PresentMode::direct };
+	SDL_Renderer* m_pSDLRenderer{};
+	SDL_Texture* m_pStreamingTexture{};
+	SDL_PixelFormat* m_pStreamingFormat{};
+	bool m_ResumeStreaming{ false }; // Streaming was paused for the hardware backend
+	//
+
+	// THREADED PRESENT: frame n goes into slot n % presentFrameCount
+	// The workers only ever write slots, the main thread blits frame n - 1 to the window while they rasterize frame n
+	// SDL wants the window surface on the thread that created the window, so no other thread touches it
+	static constexpr uint64_t presentFrameCount{ 2 };
+	std::array<SDL_Surface*, presentFrameCount> m_pPresentFrames{};
+	uint64_t m_SubmittedFrameCount{}; // Main thread only, like the presented count
+	uint64_t m_PresentedFrameCount{};
+	const uint32_t* m_pPreviousSlotPixels{}; // Last submitted frame, what shading rates and undrawn pixels come from
+	bool CreatePresentFrames();
+	void DestroyPresentFrames(); // Drops whatever is still queued, present it first to keep it
+	void PresentQueuedFrame();	 // Newest submitted frame, older ones still queued are skipped
+	//
+
+	// DYNAMIC RESOLUTION: software rasterizes at a fraction of the window size, upscaled while presenting
+	// Every software buffer below is sized for the render resolution
+	int m_RenderWidth{};
+	int m_RenderHeight{};
+	bool m_UseDynamicResolution{ false };
+	float m_FrameBudget{ 1.f / 60.f };			  // Seconds from clearing to presenting, present waits excluded
+	float m_RenderScale{ 1.f };					  // Per axis, the controller output, applied in whole steps
+	std::vector<uint32_t> m_ScaledFrameBuffer{};  // Back buffer format, empty at full resolution
+	std::vector<uint32_t> m_UpscaleRowScratch{};
+	uint32_t* m_pFramePixels{};					  // Scaled frame buffer or the back buffer itself at full resolution
+	const uint32_t* m_pPreviousFramePixels{};	  // Where the last frame's pixels are, shading rates read them
+	bool IsUpscaling() const;
+	void ApplyRenderScale();
+	void UpdateRenderScale( float frameTime ); // Feeds the controller one full frame
+	void ResizeRenderBuffers();
+	PixelRect GetUpscaledRect( const PixelRect& renderRect ) const; // Window pixels that sample from renderRect
+	//
+
+	std::vector<float> m_DepthBufferPixels{}; // GetSampleCount() depths per pixel
+
+	// MULTISAMPLING: coverage and depth per sample, shading once per pixel per triangle
+	// Samples of a pixel are stored next to each other, resolved into the back buffer before presenting
+	bool m_UseMultisampling{ false };
+	std::vector<uint32_t> m_SampleColorBuffer{}; // Back buffer format, empty when single sampling
+	uint32_t* m_pSampleColors{};				  // Sample buffer or the back buffer itself when single sampling
+	int GetSampleCount() const;
+	void ResizeSampleBuffers();
+	//
+
+	// INCREMENTAL RENDERING: the last frame stays in the buffers, only the screen area of meshes that moved is redrawn
+	// The camera, the scene settings and every renderer key invalidate the whole frame
+	struct MeshFrameState final
+	{
+		uint32_t worldVersion{};
+		PixelRect screenBounds{}; // Empty when out of view
+	};
+	bool m_UseIncrementalRendering{ true };
+	bool m_IsFrameValid{ false };
+	const Scene* m_pFrameScene{};
+	uint32_t m_FrameCameraVersion{};
+	uint32_t m_FrameSceneVersion{};
+	std::vector<MeshFrameState> m_MeshFrameStates{};
+	std::vector<MeshFrameState> m_TransparentMeshFrameStates{};
+	PixelRect m_ScissorRect{}; // Nothing outside it is cleared, rasterized or presented this frame
+	// Full screen when nothing can be reused, empty when the last frame can be presented again
+	PixelRect UpdateDirtyRect( const Scene* pScene );
+	PixelRect GetScreenBounds( const BoundingBox& worldBounds, const Matrix& viewProjection ) const;
+	void InvalidateFrame();
+	//
+
+	// VARIABLE RATE SHADING: coverage and depth stay per sample, shading runs once per block of covered pixels
+	// Rates are picked per tile from the last frame, a change shows up one frame late
+	static constexpr int shadingTileSize{ 8 };
+	bool m_UseVariableRateShading{ false };
+	bool m_IsPreviousFrameReadable{ false }; // Whether the frame pixels and depths still hold the last frame
+	std::vector<uint8_t> m_ShadingRates{};	 // Per tile, log2 of the block side
+	int GetShadingTileCountX() const;
+	void UpdateShadingRates( bool hasPreviousFrame ); // Before clearing, only for the tiles in m_ScissorRect
+	uint8_t GetShadingRate( const PixelRect& tileRect ) const;
+	void ShadeBlocks( const Mesh& mesh, const PixelRect& rect ); // rect starts on a tile row
+	//
+
+	// FRAME SNAPSHOT: what the frame's tasks read of the scene, copied before they start
+	// The scene is the side updates write, this the side the tasks read, so the next update can run beside them
+	// Mesh geometry and maps never change after loading and stay shared
+	struct FrameSnapshot final
+	{
+		Camera camera{};
+		Vector3 lightDirection{};
+		FilterMode filterMode{};
+	};
+	FrameSnapshot m_Frame{};
+	//
+
+	// FRAME GRAPH: the software frame as tasks on the job system
+	// Every copy of a mesh goes vertex -> bin -> raster, the next copy is projected and binned while this one rasterizes
+	// Raster, shade and blend tasks touch the same pixels and run in submission order, each spreads over the threads itself
+	static constexpr int binTileSize{ 64 };
+	static constexpr size_t binSlotCount{ 2 }; // Copies that can be binned ahead of the one rasterizing
+	struct FrameCopy final
+	{
+		const Mesh* pMesh{};
+		Matrix world{}; // Copied like the snapshot
+		uint8_t lod{};
+	};
+	struct TriangleBins final
+	{
+		explicit TriangleBins( std::pmr::memory_resource* pResource )
+			: triangles{ pResource }
+			, triangleBounds{ pResource }
+			, tiles{ pResource }
+		{
+		}
+
+		std::pmr::vector<TriangleOut> triangles;
+		std::pmr::vector<PixelRect> triangleBounds;			// Already inside the scissor rect
+		std::pmr::vector<std::pmr::vector<uint32_t>> tiles; // Triangles touching each bin tile, in submission order
+	};
+	// Everything below lives one frame, the bins are filled on the worker threads' own sub-arenas
+	FrameArena m_FrameArena{ *m_pJobSystem };
+	TaskGraph m_FrameGraph{ &m_FrameArena };
+	std::pmr::vector<FrameCopy> m_FrameCopies{ &m_FrameArena };
+	std::array<TriangleBins, binSlotCount> m_TriangleBins{ TriangleBins{ &m_FrameArena },
+														   TriangleBins{ &m_FrameArena } };
+	const std::vector<UINT>* m_pCopyIndices{}; // Vertex output of the last projected copy, indexing m_VertexOutBuffer
+	IndexRange m_CopyIndexRange{};
+	int GetBinTileCountX() const;
+	void ResetFrameArena(); // Drops the last frame's graph, copies and bins first, they point into the arena
+	void ProjectCopy( const FrameCopy& copy );
+	void BinCopy( const FrameCopy& copy, TriangleBins& bins ); // Culls and bins the triangles ProjectCopy left
+	void RasterizeBins( const FrameCopy& copy, const TriangleBins& bins ); // Tiles in parallel
+	void ShadeMesh( const Mesh& mesh ); // Shades and clears m_PixelCoverage in m_ScissorRect
 	//
 
-	std::vector<float> m_DepthBufferPixels{};
-	std::vector<std::pair<bool, VertexOut>> m_PixelAttributeBuffer{};
+	// Per pixel attributes of the triangle that owns the samples in its coverage mask, shaded after each mesh
+	std::vector<VertexOut> m_PixelAttributeBuffer{};
+	std::vector<uint8_t> m_PixelCoverage{};
 
 	std::vector<VertexOut> m_VertexOutBuffer{};
+	RenderCommandList m_RenderCommands{};
+	std::vector<Matrix> m_VisibleWorldBuffer{}; // World matrices of the visible copies of the current mesh
+	std::vector<uint8_t> m_VisibleLodBuffer{};	  // LOD each of those copies uses
+	std::vector<uint32_t> m_VisibleMeshletBuffer{}; // Meshlets of the current copy that survived culling
+	VertexStreams m_MeshletVertexBuffer{};			  // Their vertices, back to back
+	std::vector<UINT> m_MeshletIndexBuffer{};		  // Their triangles, indexing the vertices above
+
+	// Transparent pass scratch
+	struct BlendTriangle final
+	{
+		uint32_t sortKey{}; // Ascending -> back to front
+		std::array<uint32_t, 3> vertexIndices{};
+	};
+	std::vector<BlendTriangle> m_BlendTriangles{};
+	std::vector<BlendTriangle> m_BlendTriangleSortBuffer{};
+	std::vector<uint32_t> m_BlendSourceRow{}; // One row of a triangle, mapped to the back buffer format
+	std::vector<uint8_t> m_BlendAlphaRow{};	  // 0 for every pixel the triangle does not cover
+	//
+
+	// Projection scratch, reused by every mesh
+	Vector4Stream m_ProjectedPositionStream{};
+	Vector3Stream m_WorldPositionStream{};
+	Vector3Stream m_NormalStream{};
+	Vector3Stream m_TangentStream{};
+	//
 
 	LightingMode m_LightingMode{ LightingMode::combined };
+	MathPrecision m_MathPrecision{ MathPrecision::exact };
+
+	FrameTimings m_FrameTimings{};
 
 	bool m_ShowDepthBuffer{};
 	bool m_UseNormalMap{ true };
 	bool m_ShowBoundingBox{ false };
 
-	void Project( const std::vector<Vertex>& verticesIn,
+	Matrix GetProjectionMatrix( const Camera& camera ) const;
+	void Project( const VertexStreams& verticesIn,
 				  std::vector<VertexOut>& verticesOut,
 				  const Camera& camera,
 				  const Matrix& modelToWorld,
-				  const Matrix& worldToCamera ) const noexcept;
-	void RasterizeMesh( const Mesh& mesh, const Scene* pScene, const Matrix& worldToCamera );
-	void ShadePixel( int px, int py, const VertexOut& attributes );
+				  const Matrix& worldToCamera ) noexcept;
+	// Rasterizes one pixel of the triangle into the pixel attribute buffer
+	// Only pixels whose samples end up split between two triangles get shaded here, the rest is left to ShadeMesh
+	void RasterizePixel( const Mesh& mesh, const TriangleOut& triangle, int px, int py );
+	// Fills the meshlet vertex and index buffers with the meshlets of the LOD that survive culling
+	void GatherVisibleMeshlets( const Mesh& mesh, const Camera& camera, const Matrix& world, uint8_t lod );
+	uint32_t ShadePixel( const Mesh& mesh, const VertexOut& attributes ); // In back buffer format
+	void WriteSamples( int pixelIndex, uint8_t coverage, uint32_t color );
+	// Mask of the samples inside the triangle that pass the depth test, outputs the weights to shade the pixel with
+	uint8_t GetSampleCoverage(
+		const TriangleOut& triangle, int px, int py, bool writeDepth, Vector3& baryCentricPosition );
+	// Depth tested without depth writes, blended src_alpha / inv_src_alpha like PartialCoverage.fx
+	void RasterizeTransparentMesh( const TransparentMesh& mesh, const Matrix& world );
+	void RasterizeBlendedTriangle( const TriangleOut& triangle, const Texture& diffuseMap, FilterMode filterMode );
 
-	bool IsInPixel( const TriangleOut& triangle, int px, int py, Vector3& baryCentricPosition ) noexcept;
 	bool IsCullable( const TriangleOut& triangle ) noexcept;
+	bool IsOutsideView( const TriangleOut& triangle ) noexcept; // IsCullable without the backface test
 
 	void CycleLightingMode();
 	void IncrementLightingMode();
+
+	// Presenting
+	void BeginFrameSW();
+	void PresentSW( const PixelRect& presentRect ); // Only presentRect reaches the window
+	void PresentPreviousFrameSW();
+	bool CanRenderDirect() const;
+	void CreateStreamingResources();
+	void DestroyStreamingResources(); // Leaves the window without a surface, all the destructor needs
+	void StopStreaming();			  // Destroys the streaming resources and takes the window surface back
+	void UpdateStreamingForBackend(); // Streaming pauses as blit while hardware presents, resumes after
+	void CyclePresentMode();
+	void IncrementPresentMode();
 	//
 };
 } // namespace dae
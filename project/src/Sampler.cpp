@@ -109,8 +109,21 @@ void Sampler::Cycle()
 	Update();
 }
 
+void Sampler::SetFilterMode( FilterMode filterMode )
+{
+	m_CurrentFilterMode = filterMode;
+
+	Update();
+}
+
 void Sampler::Update()
 {
+	// Software-only effects have no sampler variable to update
+	if ( !m_pSamplerVariable )
+	{
+		return;
+	}
+
 	switch ( m_CurrentFilterMode )
 	{
 	case FilterMode::point:
@@ -2,6 +2,7 @@
 #define SAMPLERSTATE_H
 #define WIN32_LEAN_AND_MEAN
 #include <d3dx11effect.h>
+#include "FilterMode.h"
 
 class Sampler
 {
@@ -14,15 +15,10 @@ public:
 	Sampler& operator=( Sampler&& rhs );
 	~Sampler();
 
-	void Cycle();
+	using FilterMode = ::FilterMode;
 
-	enum class FilterMode
-	{
-		point,
-		linear,
-		anisotropic,
-		count,
-	};
+	void Cycle();
+	void SetFilterMode( FilterMode filterMode );
 
 private:
 	// SOFTWARE RESOURCES
@@ -1,19 +1,34 @@
 #include <SDL_keyboard.h>
 #include <d3dx11effect.h>
+#include <algorithm>
 #include <bit>
 #include "Scene.h"
 #include "Error.h"
-#include "Utils.h"
+#include "Profiler.h"
 
 namespace dae
 {
+namespace
+{
+const std::string vehicleObjPath{ "./resources/vehicle.obj" };
+const std::wstring opaqueEffectPath{ L"./resources/Opaque.fx" };
+const std::array<std::string, static_cast<size_t>( MeshMap::count )> vehicleMapPaths{
+	"./resources/vehicle_diffuse.png",
+	"./resources/vehicle_normal.png",
+	"./resources/vehicle_specular.png",
+	"./resources/vehicle_gloss.png",
+};
+} // namespace
+
 void Scene::Update( Timer* pTimer )
 {
+	PROFILE_FUNCTION();
 	// Update Camera
 	m_Camera.Update( pTimer );
 
 	for ( auto& mesh : m_Meshes )
 	{
+		mesh.UpdateLods( m_Camera.GetPosition(), m_Camera.GetFov(), m_EnableLods );
 		mesh.SetWorldViewProjection( m_Camera.GetPosition(), m_Camera.GetViewMatrix(), m_Camera.GetProjectionMatrix() );
 	}
 
@@ -26,25 +41,117 @@ void Scene::Update( Timer* pTimer )
 
 void Scene::Draw( ID3D11DeviceContext* pDeviceContext )
 {
-	if ( m_Meshes.empty() && m_TransparentMeshes.empty() )
+	if ( m_Meshes.empty() && m_TransparentMeshes.empty() && !IsLoading() )
 	{
 		throw error::scene::SceneIsEmpty();
 	}
 
-	// Draw normal meshes
-	for ( auto& mesh : m_Meshes )
+	// Whole meshes outside the view never reach the input assembler
+	BuildRenderCommands( m_RenderCommands );
+	for ( const RenderCommand& command : m_RenderCommands.GetCommands() )
+	{
+		switch ( command.pass )
+		{
+		case RenderPass::opaque:
+			m_Meshes[command.meshIndex].Draw( pDeviceContext );
+			break;
+
+		case RenderPass::transparent:
+			m_TransparentMeshes[command.meshIndex].Draw( pDeviceContext );
+			break;
+
+		default:
+			break;
+		}
+	}
+}
+
+void Scene::BuildRenderCommands( RenderCommandList& commands )
+{
+	PROFILE_FUNCTION();
+	commands.Clear();
+
+	const Frustum& frustum{ m_Camera.GetFrustum() };
+	const Matrix& worldToView{ m_Camera.GetViewMatrix() };
+	const float inverseFar{ 1.f / m_Camera.GetFar() };
+	auto getDepth{ [&]( const BoundingSphere& sphere ) {
+		return worldToView.TransformPoint( sphere.center ).z * inverseFar;
+	} };
+
+	// Every mesh owns its effect and maps, so the material is identified by the mesh
+	m_VisibleMeshIndices.clear();
+	m_MeshHierarchy.QueryFrustum( frustum, m_VisibleMeshIndices );
+	for ( const uint32_t meshIdx : m_VisibleMeshIndices )
 	{
-		mesh.Draw( pDeviceContext );
+		const Mesh& mesh{ m_Meshes[meshIdx] };
+		if ( !mesh.IsVisible( frustum ) )
+		{
+			continue;
+		}
+
+		const uint16_t materialId{ static_cast<uint16_t>( meshIdx ) };
+		commands.Add( { RenderCommandList::MakeOpaqueKey( materialId, getDepth( mesh.GetWorldSphere() ) ),
+						meshIdx,
+						materialId,
+						RenderPass::opaque } );
 	}
 
-	// Draw transparent meshes
 	if ( m_EnableTransparentMeshes )
 	{
-		for ( auto& transparentMesh : m_TransparentMeshes )
+		m_VisibleMeshIndices.clear();
+		m_TransparentMeshHierarchy.QueryFrustum( frustum, m_VisibleMeshIndices );
+		for ( const uint32_t meshIdx : m_VisibleMeshIndices )
 		{
-			transparentMesh.Draw( pDeviceContext );
+			const TransparentMesh& transparentMesh{ m_TransparentMeshes[meshIdx] };
+			if ( !transparentMesh.IsVisible( frustum ) )
+			{
+				continue;
+			}
+
+			commands.Add(
+				{ RenderCommandList::MakeTransparentKey( getDepth( transparentMesh.GetWorldSphere() ) ),
+				  meshIdx,
+				  static_cast<uint16_t>( meshIdx ),
+				  RenderPass::transparent } );
 		}
 	}
+
+	commands.Sort();
+}
+
+std::unique_ptr<Scene> Scene::Create( const std::string& name, VertexFormat vertexFormat )
+{
+	std::unique_ptr<Scene> pScene{};
+	if ( name == "vehicle" )
+	{
+		pScene = std::make_unique<VehicleScene>();
+	}
+	else if ( name == "fleet" )
+	{
+		pScene = std::make_unique<FleetScene>();
+	}
+	else
+	{
+		throw error::scene::UnknownScene();
+	}
+
+	pScene->m_VertexFormat = vertexFormat;
+	return pScene;
+}
+
+void Scene::SetFilterMode( FilterMode filterMode )
+{
+	for ( auto& mesh : m_Meshes )
+	{
+		mesh.SetFilteringMode( filterMode );
+	}
+	for ( auto& mesh : m_TransparentMeshes )
+	{
+		mesh.SetFilteringMode( filterMode );
+	}
+
+	m_CurrentFilterMode = filterMode;
+	++m_StateVersion;
 }
 
 const Camera& Scene::GetCamera() const
@@ -52,16 +159,155 @@ const Camera& Scene::GetCamera() const
 	return m_Camera;
 }
 
+Camera& Scene::GetCamera()
+{
+	return m_Camera;
+}
+
 const std::vector<Mesh>& Scene::GetMeshes() const
 {
 	return m_Meshes;
 }
 
+const std::vector<TransparentMesh>& Scene::GetTransparentMeshes() const
+{
+	return m_TransparentMeshes;
+}
+
+int Scene::PickMesh( const Ray& ray, float maxDistance ) const
+{
+	BoundingVolumeHierarchy::RayHit hit{};
+	if ( !m_MeshHierarchy.QueryRay( ray, maxDistance, hit ) )
+	{
+		return -1;
+	}
+	return static_cast<int>( hit.itemIndex );
+}
+
 Vector3 Scene::GetLightDirection() const
 {
 	return { 0.577, -0.577, 0.577 };
 }
 
+FilterMode Scene::GetFilterMode() const
+{
+	return m_CurrentFilterMode;
+}
+
+uint32_t Scene::GetStateVersion() const
+{
+	return m_StateVersion;
+}
+
+void Scene::ApplyLoadedAssets( ID3D11Device* pDevice )
+{
+	for ( size_t assetIdx{}; assetIdx < m_PendingAssets.size(); )
+	{
+		if ( !m_PendingAssets[assetIdx].isReady() )
+		{
+			++assetIdx;
+			continue;
+		}
+
+		// Out of the list before applying, which may add to it and may throw
+		const std::function<void( ID3D11Device* )> apply{ std::move( m_PendingAssets[assetIdx].apply ) };
+		m_PendingAssets.erase( m_PendingAssets.begin() + assetIdx );
+		apply( pDevice );
+		++m_StateVersion;
+	}
+}
+
+bool Scene::IsLoading() const
+{
+	return !m_PendingAssets.empty();
+}
+
+void Scene::LoadMesh( AssetLoader& assetLoader,
+					  const std::string& objPath,
+					  const std::wstring& effectPath,
+					  const MeshMapPaths& mapPaths,
+					  const std::function<void( Mesh& )>& place )
+{
+	AssetHandle<Mesh> meshHandle{
+		assetLoader.LoadMesh( objPath, D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST, m_VertexFormat ) };
+	std::vector<AssetHandle<Texture>> mapHandles{};
+	for ( const std::string& mapPath : mapPaths )
+	{
+		mapHandles.push_back( assetLoader.LoadTexture( mapPath ) );
+	}
+
+	m_PendingAssets.push_back(
+		{ [meshHandle]() { return meshHandle.IsReady(); },
+		  [this, meshHandle, effectPath, mapHandles, place]( ID3D11Device* pDevice ) mutable {
+			  Mesh mesh{ meshHandle.Take() };
+			  mesh.FinishLoading( pDevice, effectPath );
+			  mesh.SetFilteringMode( m_CurrentFilterMode );
+			  place( mesh );
+			  mesh.UpdateLods( m_Camera.GetPosition(), m_Camera.GetFov(), m_EnableLods );
+			  mesh.SetWorldViewProjection(
+				  m_Camera.GetPosition(), m_Camera.GetViewMatrix(), m_Camera.GetProjectionMatrix() );
+
+			  const size_t meshIdx{ m_Meshes.size() };
+			  m_Meshes.push_back( std::move( mesh ) );
+			  BuildHierarchies();
+
+			  // Maps that finished first are applied right after, in the same call
+			  for ( size_t mapIdx{}; mapIdx < mapHandles.size(); ++mapIdx )
+			  {
+				  AssetHandle<Texture> mapHandle{ mapHandles[mapIdx] };
+				  m_PendingAssets.push_back(
+					  { [mapHandle]() { return mapHandle.IsReady(); },
+						[this, meshIdx, mapIdx, mapHandle]( ID3D11Device* pDevice ) mutable {
+							m_Meshes[meshIdx].SetMap( pDevice, static_cast<MeshMap>( mapIdx ), mapHandle.Take() );
+						} } );
+			  }
+		  } } );
+}
+
+void Scene::LoadTransparentMesh( AssetLoader& assetLoader,
+								 const std::string& objPath,
+								 const std::wstring& effectPath,
+								 const std::string& diffuseMapPath,
+								 const std::function<void( TransparentMesh& )>& place )
+{
+	AssetHandle<TransparentMesh> meshHandle{
+		assetLoader.LoadTransparentMesh( objPath, D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST ) };
+	AssetHandle<Texture> mapHandle{ assetLoader.LoadTexture( diffuseMapPath ) };
+
+	m_PendingAssets.push_back(
+		{ [meshHandle]() { return meshHandle.IsReady(); },
+		  [this, meshHandle, effectPath, mapHandle, place]( ID3D11Device* pDevice ) mutable {
+			  TransparentMesh mesh{ meshHandle.Take() };
+			  mesh.FinishLoading( pDevice, effectPath );
+			  mesh.SetFilteringMode( m_CurrentFilterMode );
+			  place( mesh );
+			  mesh.SetWorldViewProjection( m_Camera.GetViewMatrix(), m_Camera.GetProjectionMatrix() );
+
+			  const size_t meshIdx{ m_TransparentMeshes.size() };
+			  m_TransparentMeshes.push_back( std::move( mesh ) );
+			  BuildHierarchies();
+
+			  m_PendingAssets.push_back( { [mapHandle]() { return mapHandle.IsReady(); },
+										   [this, meshIdx, mapHandle]( ID3D11Device* pDevice ) mutable {
+											   m_TransparentMeshes[meshIdx].SetDiffuseMap( pDevice, mapHandle.Take() );
+										   } } );
+		  } } );
+}
+
+void Scene::ToggleLods()
+{
+	// The meshes pick their levels again on the next update
+	m_EnableLods = !m_EnableLods;
+	if ( m_EnableLods )
+	{
+		std::cout << "Enabled LODs\n";
+	}
+	else
+	{
+		std::cout << "Disabled LODs\n";
+	}
+}
+
 void Scene::CycleFilteringMode()
 {
 	for ( auto& mesh : m_Meshes )
@@ -74,6 +320,7 @@ void Scene::CycleFilteringMode()
 	}
 
 	IncrementFilterMode();
+	++m_StateVersion;
 
 	switch ( m_CurrentFilterMode )
 	{
@@ -101,14 +348,50 @@ void Scene::IncrementFilterMode()
 		std::bit_cast<int, Sampler::FilterMode>( Sampler::FilterMode::count ) );
 }
 
-void VehicleScene::Update( Timer* pTimer )
+void Scene::BuildHierarchies()
+{
+	std::vector<BoundingBox> meshBounds{};
+	meshBounds.reserve( m_Meshes.size() );
+	for ( const auto& mesh : m_Meshes )
+	{
+		meshBounds.push_back( mesh.GetWorldBounds() );
+	}
+	m_MeshHierarchy.Build( meshBounds );
+
+	meshBounds.clear();
+	for ( const auto& transparentMesh : m_TransparentMeshes )
+	{
+		meshBounds.push_back( transparentMesh.GetWorldBounds() );
+	}
+	m_TransparentMeshHierarchy.Build( meshBounds );
+}
+
+void Scene::UpdateMeshBounds( size_t meshIdx )
 {
-	const Matrix rotation{ Matrix::CreateRotationY( pTimer->GetElapsed() * 0.25f * PI ) };
+	m_MeshHierarchy.UpdateItem( static_cast<uint32_t>( meshIdx ), m_Meshes[meshIdx].GetWorldBounds() );
+}
+
+void Scene::UpdateTransparentMeshBounds( size_t meshIdx )
+{
+	m_TransparentMeshHierarchy.UpdateItem( static_cast<uint32_t>( meshIdx ),
+										   m_TransparentMeshes[meshIdx].GetWorldBounds() );
+}
 
+void VehicleScene::Update( Timer* pTimer )
+{
 	if ( m_RotateVehicle )
 	{
-		m_Meshes[0].ApplyMatrix( rotation );
-		m_TransparentMeshes[0].ApplyMatrix( rotation );
+		m_VehicleYaw += pTimer->GetElapsed() * 0.25f * PI;
+		if ( !m_Meshes.empty() )
+		{
+			m_Meshes[0].SetWorld( GetVehicleWorld() );
+			UpdateMeshBounds( 0 );
+		}
+		if ( !m_TransparentMeshes.empty() )
+		{
+			m_TransparentMeshes[0].SetWorld( GetVehicleWorld() );
+			UpdateTransparentMeshBounds( 0 );
+		}
 	}
 
 	Scene::Update( pTimer );
@@ -132,6 +415,7 @@ void VehicleScene::HandleKeyUp( SDL_KeyboardEvent key )
 
 	case SDL_SCANCODE_F3:
 		m_EnableTransparentMeshes = !m_EnableTransparentMeshes;
+		++m_StateVersion;
 		if ( m_EnableTransparentMeshes )
 		{
 			std::cout << "Enabled transparent meshes\n";
@@ -146,12 +430,21 @@ void VehicleScene::HandleKeyUp( SDL_KeyboardEvent key )
 		CycleFilteringMode();
 		break;
 
+	case SDL_SCANCODE_L:
+		ToggleLods();
+		break;
+
 	default:
 		break;
 	}
 }
 
-void VehicleScene::Initialize( ID3D11Device* pDevice, float aspectRatio )
+Matrix VehicleScene::GetVehicleWorld() const
+{
+	return Matrix::CreateRotationY( m_VehicleYaw ) * Matrix::CreateTranslation( 0.f, 0.f, 50.f );
+}
+
+void VehicleScene::Initialize( ID3D11Device*, float aspectRatio, AssetLoader& assetLoader )
 {
 	m_Camera = Camera{ { 0.f, 0.f, 0.f }, 45.f, aspectRatio, 0.1f, 100.f };
 
@@ -162,38 +455,85 @@ void VehicleScene::Initialize( ID3D11Device* pDevice, float aspectRatio )
 	// Comment if on C++26 -> non-magic number solution above
 	m_LightDir = { 0.577f, -0.577f, 0.577f };
 
-	std::vector<Vertex> vertices{};
-	std::vector<uint32_t> indices{};
+	// Vehicle first, the scene is mostly vehicle
+	LoadMesh( assetLoader, vehicleObjPath, opaqueEffectPath, vehicleMapPaths, [this]( Mesh& vehicle ) {
+		vehicle.SetWorld( GetVehicleWorld() );
+	} );
 
-	Utils::ParseOBJ( "./resources/vehicle.obj", vertices, indices );
-	const D3D11_PRIMITIVE_TOPOLOGY topology{ D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST };
-	const std::wstring effectPath{ L"./resources/Opaque.fx" };
-	const std::string diffuseMapPath{ "./resources/vehicle_diffuse.png" };
-	const std::string normalMapPath{ "./resources/vehicle_normal.png" };
-	const std::string specularMapPath{ "./resources/vehicle_specular.png" };
-	const std::string glossMapPath{ "./resources/vehicle_gloss.png" };
+	const std::string fireObjPath{ "./resources/fireFX.obj" };
+	const std::wstring partialCoverageEffectPath{ L"./resources/PartialCoverage.fx" };
+	const std::string fireDiffuseMapPath{ "./resources/fireFX_diffuse.png" };
+	LoadTransparentMesh(
+		assetLoader, fireObjPath, partialCoverageEffectPath, fireDiffuseMapPath, [this]( TransparentMesh& fire ) {
+			fire.SetWorld( GetVehicleWorld() );
+		} );
+}
 
-	Mesh vehicle{
-		pDevice, vertices, indices, topology, effectPath, diffuseMapPath, normalMapPath, specularMapPath, glossMapPath,
-	};
+void FleetScene::Update( Timer* pTimer )
+{
+	if ( m_RotateFleet && !m_Meshes.empty() )
+	{
+		// Spin the whole grid around its own center, the instances never have to be touched
+		m_FleetYaw += pTimer->GetElapsed() * 0.05f * PI;
+		m_Meshes[0].SetWorld( Matrix::CreateRotationY( m_FleetYaw ) * Matrix::CreateTranslation( m_FleetCenter ) );
+		UpdateMeshBounds( 0 );
+	}
 
-	vehicle.ApplyMatrix( Matrix::CreateTranslation( 0.f, 0.f, 50.f ) );
+	Scene::Update( pTimer );
+}
 
-	m_Meshes.push_back( std::move( vehicle ) );
+void FleetScene::HandleKeyUp( SDL_KeyboardEvent key )
+{
+	switch ( key.keysym.scancode )
+	{
+	case SDL_SCANCODE_F2:
+		m_RotateFleet = !m_RotateFleet;
+		if ( m_RotateFleet )
+		{
+			std::cout << "Enabled rotation\n";
+		}
+		else
+		{
+			std::cout << "Disabled rotation\n";
+		}
+		break;
 
-	vertices.clear();
-	indices.clear();
+	case SDL_SCANCODE_F4:
+		CycleFilteringMode();
+		break;
 
-	Utils::ParseOBJ( "./resources/fireFX.obj", vertices, indices );
-	const std::wstring partialCoverageEffectPath{ L"./resources/PartialCoverage.fx" };
-	const std::string fireDiffuseMapPath{ "./resources/fireFX_diffuse.png" };
+	case SDL_SCANCODE_L:
+		ToggleLods();
+		break;
 
-	TransparentMesh fire{
-		pDevice, vertices, indices, topology, partialCoverageEffectPath, fireDiffuseMapPath,
-	};
+	default:
+		break;
+	}
+}
+
+void FleetScene::Initialize( ID3D11Device*, float aspectRatio, AssetLoader& assetLoader )
+{
+	m_Camera = Camera{ { 0.f, 60.f, -40.f }, 45.f, aspectRatio, 0.1f, 1000.f };
+	m_Camera.SetRotation( 0.f, -0.35f );
+	m_LightDir = { 0.577f, -0.577f, 0.577f };
 
-	fire.ApplyMatrix( Matrix::CreateTranslation( 0.f, 0.f, 50.f ) );
+	// Grid centered on the origin of the mesh, every copy turned a little further than the last
+	std::vector<Matrix> instanceWorlds{};
+	instanceWorlds.reserve( columnCount * rowCount );
+	for ( int rowIdx{}; rowIdx < rowCount; ++rowIdx )
+	{
+		for ( int columnIdx{}; columnIdx < columnCount; ++columnIdx )
+		{
+			const float x{ ( columnIdx - ( columnCount - 1 ) * 0.5f ) * spacing };
+			const float z{ ( rowIdx - ( rowCount - 1 ) * 0.5f ) * spacing };
+			const float yaw{ static_cast<float>( instanceWorlds.size() ) * 0.1f };
+			instanceWorlds.push_back( Matrix::CreateRotationY( yaw ) * Matrix::CreateTranslation( x, 0.f, z ) );
+		}
+	}
 
-	m_TransparentMeshes.push_back( std::move( fire ) );
+	LoadMesh( assetLoader, vehicleObjPath, opaqueEffectPath, vehicleMapPaths, [this, instanceWorlds]( Mesh& fleet ) {
+		fleet.SetInstances( instanceWorlds );
+		fleet.SetWorld( Matrix::CreateRotationY( m_FleetYaw ) * Matrix::CreateTranslation( m_FleetCenter ) );
+	} );
 }
 } // namespace dae
@@ -1,8 +1,15 @@
 #ifndef SCENE_H
 #define SCENE_H
 #include <SDL_events.h>
+#include <array>
+#include <functional>
+#include <memory>
+#include <string>
+#include "AssetLoader.h"
+#include "BoundingVolumeHierarchy.h"
 #include "Camera.h"
 #include "Mesh.h"
+#include "RenderCommands.h"
 
 namespace dae
 {
@@ -15,12 +22,36 @@ public:
 	virtual void HandleKeyUp( SDL_KeyboardEvent key ) = 0;
 	virtual void Draw( ID3D11DeviceContext* pDeviceContext );
 
-	virtual void Initialize( ID3D11Device* pDevice, float aspectRatio ) = 0;
+	// Only starts loading the meshes, they join the scene through ApplyLoadedAssets
+	virtual void Initialize( ID3D11Device* pDevice, float aspectRatio, AssetLoader& assetLoader ) = 0;
+
+	// Creates a scene by name, throws error::scene::UnknownScene
+	// Opaque meshes get loaded in vertexFormat once the scene is initialized
+	static std::unique_ptr<Scene> Create( const std::string& name, VertexFormat vertexFormat = VertexFormat::full );
+
+	void SetFilterMode( FilterMode filterMode );
 
 	// Software
 	const Camera& GetCamera() const;
+	Camera& GetCamera();
 	const std::vector<Mesh>& GetMeshes() const;
+	const std::vector<TransparentMesh>& GetTransparentMeshes() const;
+	// One command per visible mesh, sorted and ready for either backend
+	void BuildRenderCommands( RenderCommandList& commands );
 	Vector3 GetLightDirection() const;
+	FilterMode GetFilterMode() const;
+	// Changes with every setting that affects the image, camera and mesh movement have their own versions
+	uint32_t GetStateVersion() const;
+	//
+
+	// Closest opaque mesh whose bounds the ray enters, -1 if none
+	int PickMesh( const Ray& ray, float maxDistance ) const;
+
+	// ASSET LOADING: a mesh joins the scene once its geometry is in, its maps are placeholders until they are too
+	// Between frames, on the thread that owns the device, every asset applied counts as a state change
+	// A failed load is dropped and its exception rethrown here, the rest is applied on the next call
+	void ApplyLoadedAssets( ID3D11Device* pDevice );
+	bool IsLoading() const;
 	//
 
 protected:
@@ -30,15 +61,53 @@ protected:
 	Vector3 m_LightDir{};
 
 	bool m_EnableTransparentMeshes{ true };
+	bool m_EnableLods{ true };
+	VertexFormat m_VertexFormat{ VertexFormat::full };
 	Sampler::FilterMode m_CurrentFilterMode{};
+	uint32_t m_StateVersion{};
+
+	// One tree per mesh vector, item i is mesh i
+	BoundingVolumeHierarchy m_MeshHierarchy{};
+	BoundingVolumeHierarchy m_TransparentMeshHierarchy{};
+	std::vector<uint32_t> m_VisibleMeshIndices{}; // Draw scratch
+	//
+
+	RenderCommandList m_RenderCommands{}; // Hardware draw list, rebuilt every Draw
+
+	// Loads still out, applied in the order they finish
+	struct PendingAsset final
+	{
+		std::function<bool()> isReady{};
+		std::function<void( ID3D11Device* pDevice )> apply{};
+	};
+	std::vector<PendingAsset> m_PendingAssets{};
+	using MeshMapPaths = std::array<std::string, static_cast<size_t>( MeshMap::count )>; // In MeshMap order
+	// place positions the mesh before it joins the scene, it may have missed any number of updates
+	void LoadMesh( AssetLoader& assetLoader,
+				   const std::string& objPath,
+				   const std::wstring& effectPath,
+				   const MeshMapPaths& mapPaths,
+				   const std::function<void( Mesh& )>& place );
+	void LoadTransparentMesh( AssetLoader& assetLoader,
+							  const std::string& objPath,
+							  const std::wstring& effectPath,
+							  const std::string& diffuseMapPath,
+							  const std::function<void( TransparentMesh& )>& place );
 
 	void CycleFilteringMode();
 	void IncrementFilterMode();
+	void ToggleLods();
+
+	// Call once the meshes are loaded, and again after adding or removing any
+	void BuildHierarchies();
+	// Call after moving a mesh, refits its path in the tree
+	void UpdateMeshBounds( size_t meshIdx );
+	void UpdateTransparentMeshBounds( size_t meshIdx );
 };
 
 class TestScene : public Scene
 {
-	virtual void Initialize( ID3D11Device* pDevice, float aspectRatio ) override;
+	virtual void Initialize( ID3D11Device* pDevice, float aspectRatio, AssetLoader& assetLoader ) override;
 };
 
 class VehicleScene : public Scene
@@ -47,10 +116,31 @@ public:
 	virtual void Update( Timer* pTimer ) override;
 	virtual void HandleKeyUp( SDL_KeyboardEvent key ) override;
 
-	virtual void Initialize( ID3D11Device* pDevice, float aspectRatio ) override;
+	virtual void Initialize( ID3D11Device* pDevice, float aspectRatio, AssetLoader& assetLoader ) override;
 
 private:
 	bool m_RotateVehicle{ true };
+	float m_VehicleYaw{}; // The fire can come in after the vehicle turned, both are placed from this
+	Matrix GetVehicleWorld() const;
+};
+
+// Hundreds of copies of the vehicle drawn as instances of a single mesh
+class FleetScene : public Scene
+{
+public:
+	virtual void Update( Timer* pTimer ) override;
+	virtual void HandleKeyUp( SDL_KeyboardEvent key ) override;
+
+	virtual void Initialize( ID3D11Device* pDevice, float aspectRatio, AssetLoader& assetLoader ) override;
+
+private:
+	static constexpr int columnCount{ 25 };
+	static constexpr int rowCount{ 20 };
+	static constexpr float spacing{ 24.f };
+
+	bool m_RotateFleet{ true };
+	float m_FleetYaw{};
+	Vector3 m_FleetCenter{ 0.f, 0.f, 250.f };
 };
 } // namespace dae
 
@@ -14,9 +14,11 @@ ColorRGB GetPixelColor( const VertexOut& pixelVertex,
 						const Camera& camera,
 						const Vector3& lightDirection,
 						const LightingMode& lightingMode,
-						bool useNormalMap )
+						bool useNormalMap,
+						FilterMode filterMode,
+						MathPrecision precision )
 {
-	const ColorRGB diffuseColor{ diffuseMap.Sample( pixelVertex.uv ) };
+	const ColorRGB diffuseColor{ diffuseMap.Sample( pixelVertex.uv, filterMode ) };
 
 	if ( lightDirection == Vector3{ 0.f, 0.f, 0.f } )
 	{
@@ -26,23 +28,27 @@ ColorRGB GetPixelColor( const VertexOut& pixelVertex,
 	Vector3 sampledNormal{};
 	if ( useNormalMap )
 	{
-		const Vector3 binormal{ Vector3::Cross( pixelVertex.normal, pixelVertex.tangent ).Normalized() };
+		const Vector3 binormal{
+			fastMath::Normalized( Vector3::Cross( pixelVertex.normal, pixelVertex.tangent ), precision )
+		};
 		const Matrix tangentAxisSpace{ pixelVertex.tangent, binormal, pixelVertex.normal, {} };
-		ColorRGB sampledNormalColor{ ( normalMap.Sample( pixelVertex.uv ) ) };
+		ColorRGB sampledNormalColor{ ( normalMap.Sample( pixelVertex.uv, filterMode ) ) };
 		sampledNormal = { sampledNormalColor.r, sampledNormalColor.g, sampledNormalColor.b };
 		sampledNormal = ( sampledNormal * 2.f ) - Vector3{ 1.f, 1.f, 1.f };
 		sampledNormal = tangentAxisSpace.TransformVector( sampledNormal );
-		sampledNormal.Normalize();
+		fastMath::Normalize( sampledNormal, precision );
 	}
 	else
 	{
 		sampledNormal = pixelVertex.normal;
 	}
 
-	const ColorRGB sampledSpecularity{ specularMap.Sample( pixelVertex.uv ) };
-	const float sampledGloss{ glossMap.Sample( pixelVertex.uv ).r }; // Assuming map is greyscale
+	const ColorRGB sampledSpecularity{ specularMap.Sample( pixelVertex.uv, filterMode ) };
+	const float sampledGloss{ glossMap.Sample( pixelVertex.uv, filterMode ).r }; // Assuming map is greyscale
 
-	const Vector3 toCameraDir{ Vector3( pixelVertex.worldPosition, camera.GetPosition() ).Normalized() };
+	const Vector3 toCameraDir{
+		fastMath::Normalized( Vector3( pixelVertex.worldPosition, camera.GetPosition() ), precision )
+	};
 
 	ColorRGB finalColor{};
 
@@ -54,7 +60,7 @@ ColorRGB GetPixelColor( const VertexOut& pixelVertex,
 	const float observedArea{ lightUtils::GetObservedArea( lightDirection, sampledNormal ) };
 	const ColorRGB lambertDiffuse{ ( diffuseColor * diffuseReflectance ) / PI };
 	const ColorRGB phongSpecular{ lightUtils::GetPhong(
-		sampledSpecularity, sampledGloss * shininess, lightDirection, toCameraDir, sampledNormal ) };
+		sampledSpecularity, sampledGloss * shininess, lightDirection, toCameraDir, sampledNormal, precision ) };
 	const ColorRGB brdf{ lambertDiffuse + phongSpecular + ambientLight };
 
 	switch ( lightingMode )
@@ -95,11 +101,12 @@ ColorRGB GetPhong( ColorRGB specularReflectance,
 				   float phongExponent,
 				   const Vector3& lightIncomingDir,
 				   const Vector3& toCameraDir,
-				   const Vector3& normal )
+				   const Vector3& normal,
+				   MathPrecision precision )
 {
 	const Vector3 reflectLight{ Vector3::Reflect( -lightIncomingDir, normal ) };
 	const float closingFactor{ std::max( Vector3::Dot( reflectLight, -toCameraDir ), 0.f ) };
-	return specularReflectance * pow( closingFactor, phongExponent );
+	return specularReflectance * fastMath::Pow( closingFactor, phongExponent, precision );
 }
 } // namespace lightUtils
 } // namespace dae
@@ -2,8 +2,9 @@
 #define SHADING_H
 #include "Camera.h"
 #include "ColorRGB.h"
+#include "FastMath.h"
 #include "Structs.h"
-#include "Mesh.h"
+#include "Texture.h"
 
 // Everything related to shading
 
@@ -32,7 +33,9 @@ ColorRGB GetPixelColor( const VertexOut& pixelVertex,
 						const Camera& camera,
 						const Vector3& lightDirection,
 						const LightingMode& lightingMode,
-						bool useNormalMap = true );
+						bool useNormalMap = true,
+						FilterMode filterMode = FilterMode::point,
+						MathPrecision precision = MathPrecision::exact );
 
 namespace lightUtils
 {
@@ -41,7 +44,8 @@ ColorRGB GetPhong( ColorRGB specularReflectance,
 				   float phongExponent,
 				   const Vector3& lightIncomingDir,
 				   const Vector3& toCameraDir,
-				   const Vector3& normal );
+				   const Vector3& normal,
+				   MathPrecision precision = MathPrecision::exact );
 } // namespace lightUtils
 } // namespace dae
 
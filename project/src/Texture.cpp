@@ -1,14 +1,51 @@
 #include "Texture.h"
+#include <array>
+#include <utility>
 #include <SDL_image.h>
+#ifndef SOFTWARE_ONLY
+#	include <d3d11.h>
+#endif
 #include "Error.h"
+#include "Profiler.h"
 
 namespace dae
 {
 Texture::Texture( ID3D11Device* pDevice, const std::string& texturePath )
 {
-	HRESULT result{};
+	PROFILE_ZONE( "LoadTexture" );
 
 	m_pSurface = IMG_Load( texturePath.c_str() );
+	if ( !m_pSurface )
+	{
+		throw error::file::CouldNotOpenFile();
+	}
+
+	// No device -> software rendering only, keep the surface and skip the GPU upload
+	CreateDeviceResources( pDevice );
+}
+
+Texture Texture::CreateSolid( uint8_t r, uint8_t g, uint8_t b, uint8_t a )
+{
+	// Same byte order GetTexel reads and the GPU upload expects
+	Texture texture{};
+	texture.m_pSurface = SDL_CreateRGBSurfaceWithFormat( 0, 1, 1, 32, SDL_PIXELFORMAT_RGBA32 );
+	if ( !texture.m_pSurface )
+	{
+		throw error::texture::ResourceCreateFail();
+	}
+	*static_cast<uint32_t*>( texture.m_pSurface->pixels ) = SDL_MapRGBA( texture.m_pSurface->format, r, g, b, a );
+	return texture;
+}
+
+void Texture::CreateDeviceResources( ID3D11Device* pDevice )
+{
+	if ( !pDevice || m_pResource )
+	{
+		return;
+	}
+
+#ifndef SOFTWARE_ONLY
+	HRESULT result{};
 
 	DXGI_FORMAT format{ DXGI_FORMAT_R8G8B8A8_UNORM };
 	D3D11_TEXTURE2D_DESC desc{};
@@ -43,6 +80,7 @@ Texture::Texture( ID3D11Device* pDevice, const std::string& texturePath )
 	{
 		throw error::texture::ResourceViewCreateFail();
 	}
+#endif
 }
 
 Texture::Texture( Texture&& rhs )
@@ -69,20 +107,17 @@ Texture& Texture::operator=( Texture&& rhs )
 		return *this;
 	}
 
-	m_pResource = rhs.m_pResource;
-	rhs.m_pResource = nullptr;
-
-	m_pResourceView = rhs.m_pResourceView;
-	rhs.m_pResourceView = nullptr;
-
-	m_pSurface = rhs.m_pSurface;
-	rhs.m_pSurface = nullptr;
+	// Swapped, so rhs releases what this held, placeholders get replaced this way
+	std::swap( m_pResource, rhs.m_pResource );
+	std::swap( m_pResourceView, rhs.m_pResourceView );
+	std::swap( m_pSurface, rhs.m_pSurface );
 
 	return *this;
 }
 
 Texture::~Texture() noexcept
 {
+#ifndef SOFTWARE_ONLY
 	if ( m_pResourceView )
 	{
 		m_pResourceView->Release();
@@ -92,6 +127,7 @@ Texture::~Texture() noexcept
 	{
 		m_pResource->Release();
 	}
+#endif
 
 	if ( m_pSurface )
 	{
@@ -104,23 +140,76 @@ ID3D11ShaderResourceView* Texture::GetSRV() const
 	return m_pResourceView;
 }
 
-ColorRGB Texture::Sample( const Vector2& uv ) const
+ColorRGB Texture::Sample( const Vector2& uv, FilterMode filterMode ) const
+{
+	float alpha{};
+	return Sample( uv, alpha, filterMode );
+}
+
+ColorRGB Texture::Sample( const Vector2& uv, float& alpha, FilterMode filterMode ) const
+{
+	const int pixelWidth{ m_pSurface->w };
+	const int pixelHeight{ m_pSurface->h };
+
+	if ( filterMode == FilterMode::point )
+	{
+		// Convert UV coordinates to texture coordinates
+		const int uvpx{ static_cast<int>( std::round( uv.x * pixelWidth ) ) };
+		const int uvpy{ static_cast<int>( std::round( uv.y * pixelHeight ) ) };
+
+		return GetTexel( uvpx, uvpy, alpha );
+	}
+
+	// Bilinear: blend the 4 texels surrounding the sample point, texel centers sit at +0.5
+	const float texelX{ uv.x * pixelWidth - 0.5f };
+	const float texelY{ uv.y * pixelHeight - 0.5f };
+	const int texelLeft{ static_cast<int>( std::floor( texelX ) ) };
+	const int texelTop{ static_cast<int>( std::floor( texelY ) ) };
+	const float weightX{ texelX - texelLeft };
+	const float weightY{ texelY - texelTop };
+
+	std::array<float, 4> alphas{};
+	const ColorRGB top{ ColorRGB::Lerp( GetTexel( texelLeft, texelTop, alphas[0] ),
+										GetTexel( texelLeft + 1, texelTop, alphas[1] ),
+										weightX ) };
+	const ColorRGB bottom{ ColorRGB::Lerp( GetTexel( texelLeft, texelTop + 1, alphas[2] ),
+										   GetTexel( texelLeft + 1, texelTop + 1, alphas[3] ),
+										   weightX ) };
+
+	const float alphaTop{ alphas[0] + ( alphas[1] - alphas[0] ) * weightX };
+	const float alphaBottom{ alphas[2] + ( alphas[3] - alphas[2] ) * weightX };
+	alpha = alphaTop + ( alphaBottom - alphaTop ) * weightY;
+	return ColorRGB::Lerp( top, bottom, weightY );
+}
+
+ColorRGB Texture::GetTexel( int x, int y, float& alpha ) const
 {
 	uint32_t* surfacePixels{ reinterpret_cast<uint32_t*>( m_pSurface->pixels ) };
 
-	// Convert UV coordinates to texture coordinates
+	// Wrap addressing, same as the hardware sampler states
 	const int pixelWidth{ m_pSurface->w };
 	const int pixelHeight{ m_pSurface->h };
-	const int uvpx{ static_cast<int>( std::round( uv.x * pixelWidth ) ) };
-	const int uvpy{ static_cast<int>( std::round( uv.y * pixelHeight ) ) };
+	x %= pixelWidth;
+	y %= pixelHeight;
+	if ( x < 0 )
+	{
+		x += pixelWidth;
+	}
+	if ( y < 0 )
+	{
+		y += pixelHeight;
+	}
 
-	const int pixelIndex{ uvpx + uvpy * pixelWidth };
+	const int pixelIndex{ x + y * pixelWidth };
 	uint32_t pixel{ surfacePixels[pixelIndex] };
 	const uint8_t pixelR{ *reinterpret_cast<const uint8_t*>( &pixel ) }; // Capture first 8 bits -> Red
 	pixel = pixel >> 8;													 // Shift right to capture next
 	const uint8_t pixelG{ *reinterpret_cast<const uint8_t*>( &pixel ) }; // Capture first 8 bits -> Green
 	pixel = pixel >> 8;													 // Shift right to capture next
 	const uint8_t pixelB{ *reinterpret_cast<const uint8_t*>( &pixel ) }; // Capture first 8 bits -> Blue
+	pixel = pixel >> 8;													 // Shift right to capture next
+	const uint8_t pixelA{ *reinterpret_cast<const uint8_t*>( &pixel ) }; // Capture first 8 bits -> Alpha
+	alpha = m_pSurface->format->Amask ? pixelA / 255.f : 1.f;
 
 	// Convert unsigned int RGB to float RGB
 	const ColorRGB color{ pixelR / 255.f, pixelG / 255.f, pixelB / 255.f };
@@ -2,8 +2,13 @@
 #define TEXTURE_H
 #include <string>
 #include <SDL_surface.h>
-#include <d3d11.h>
 #include "Structs.h"
+#include "FilterMode.h"
+
+// Forward declared so software only targets don't need the D3D11 headers
+struct ID3D11Device;
+struct ID3D11Texture2D;
+struct ID3D11ShaderResourceView;
 
 namespace dae
 {
@@ -12,6 +17,8 @@ class Texture
 public:
 	Texture() = default;
 	Texture( ID3D11Device* pDevice, const std::string& texturePath );
+	// One texel of the given color, stands in for a map that is still loading
+	static Texture CreateSolid( uint8_t r, uint8_t g, uint8_t b, uint8_t a = 255 );
 	Texture( const Texture& ) = delete;
 	Texture( Texture&& rhs );
 	~Texture() noexcept;
@@ -19,10 +26,16 @@ public:
 	Texture& operator=( const Texture& ) = delete;
 	Texture& operator=( Texture&& rhs );
 
+	// Decoding needs no device, so a texture loaded without one gets uploaded here on the thread that owns it
+	// Does nothing without a device or when already uploaded
+	void CreateDeviceResources( ID3D11Device* pDevice );
+
 	ID3D11ShaderResourceView* GetSRV() const;
 
 	// Software Rendering
-	ColorRGB Sample( const Vector2& uv ) const;
+	ColorRGB Sample( const Vector2& uv, FilterMode filterMode = FilterMode::point ) const;
+	// Same filtering applied to alpha as well, 1 for textures without an alpha channel
+	ColorRGB Sample( const Vector2& uv, float& alpha, FilterMode filterMode = FilterMode::point ) const;
 	//
 
 private:
@@ -31,6 +44,8 @@ private:
 
 	// Software rendering
 	SDL_Surface* m_pSurface{};
+
+	ColorRGB GetTexel( int x, int y, float& alpha ) const;
 	//
 };
 } // namespace dae
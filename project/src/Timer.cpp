@@ -1,4 +1,5 @@
 #include "Timer.h"
+#include <cfloat>
 #include <iostream>
 #include <numeric>
 #include <fstream>
@@ -60,6 +61,11 @@ void Timer::StartBenchmark(int numFrames)
 	std::cout << "**BENCHMARK STARTED**\n";
 }
 
+void Timer::SetFixedElapsed(float elapsed)
+{
+	m_FixedElapsedTime = elapsed;
+}
+
 void Timer::Update()
 {
 	if (m_IsStopped)
@@ -84,6 +90,11 @@ void Timer::Update()
 		m_ElapsedTime = m_ElapsedUpperBound;
 	}
 
+	if (m_FixedElapsedTime > 0.0f)
+	{
+		m_ElapsedTime = m_FixedElapsedTime;
+	}
+
 	m_TotalTime = (float)(((m_CurrentTime - m_PausedTime) - m_BaseTime) * m_SecondsPerCount);
 
 	//FPS LOGIC
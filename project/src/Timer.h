@@ -17,6 +17,7 @@ public:
 	Timer& operator=( Timer&& ) noexcept = delete;
 
 	void StartBenchmark( int numFrames = 10 );
+	void SetFixedElapsed( float elapsed ); // Non-zero -> every Update advances exactly this much
 
 	void Reset();
 	void Start();
@@ -60,6 +61,7 @@ private:
 	float m_SecondsPerCount = 0.0f;
 	float m_ElapsedUpperBound = 0.03f;
 	float m_FPSTimer = 0.0f;
+	float m_FixedElapsedTime = 0.0f;
 
 	bool m_IsStopped = true;
 	bool m_ForceElapsedUpperBound = false;
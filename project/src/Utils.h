@@ -3,6 +3,7 @@
 #include <cstdint>
 #include <fstream>
 #include <vector>
+#include "Profiler.h"
 #include "Structs.h"
 
 namespace dae
@@ -17,6 +18,7 @@ static bool ParseOBJ( const std::string& filename,
 					  std::vector<uint32_t>& indices,
 					  bool flipAxisAndWinding = true )
 {
+	PROFILE_ZONE( "ParseOBJ" );
 	std::ifstream file( filename );
 	if ( !file )
 		return false;
@@ -0,0 +1,437 @@
+#include "VectorStream.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace dae
+{
+#pragma region Vector2Stream
+size_t Vector2Stream::Size() const
+{
+	return x.size();
+}
+
+void Vector2Stream::Resize( size_t size )
+{
+	x.resize( size );
+	y.resize( size );
+}
+
+void Vector2Stream::Reserve( size_t capacity )
+{
+	x.reserve( capacity );
+	y.reserve( capacity );
+}
+
+void Vector2Stream::PushBack( const Vector2& v )
+{
+	x.push_back( v.x );
+	y.push_back( v.y );
+}
+
+Vector2 Vector2Stream::Get( size_t index ) const
+{
+	return { x[index], y[index] };
+}
+
+void Vector2Stream::Set( size_t index, const Vector2& v )
+{
+	x[index] = v.x;
+	y[index] = v.y;
+}
+#pragma endregion
+
+#pragma region Vector3Stream
+size_t Vector3Stream::Size() const
+{
+	return x.size();
+}
+
+void Vector3Stream::Resize( size_t size )
+{
+	x.resize( size );
+	y.resize( size );
+	z.resize( size );
+}
+
+void Vector3Stream::Reserve( size_t capacity )
+{
+	x.reserve( capacity );
+	y.reserve( capacity );
+	z.reserve( capacity );
+}
+
+void Vector3Stream::PushBack( const Vector3& v )
+{
+	x.push_back( v.x );
+	y.push_back( v.y );
+	z.push_back( v.z );
+}
+
+Vector3 Vector3Stream::Get( size_t index ) const
+{
+	return { x[index], y[index], z[index] };
+}
+
+void Vector3Stream::Set( size_t index, const Vector3& v )
+{
+	x[index] = v.x;
+	y[index] = v.y;
+	z[index] = v.z;
+}
+#pragma endregion
+
+#pragma region Vector4Stream
+size_t Vector4Stream::Size() const
+{
+	return x.size();
+}
+
+void Vector4Stream::Resize( size_t size )
+{
+	x.resize( size );
+	y.resize( size );
+	z.resize( size );
+	w.resize( size );
+}
+
+void Vector4Stream::Reserve( size_t capacity )
+{
+	x.reserve( capacity );
+	y.reserve( capacity );
+	z.reserve( capacity );
+	w.reserve( capacity );
+}
+
+void Vector4Stream::PushBack( const Vector4& v )
+{
+	x.push_back( v.x );
+	y.push_back( v.y );
+	z.push_back( v.z );
+	w.push_back( v.w );
+}
+
+Vector4 Vector4Stream::Get( size_t index ) const
+{
+	return { x[index], y[index], z[index], w[index] };
+}
+
+void Vector4Stream::Set( size_t index, const Vector4& v )
+{
+	x[index] = v.x;
+	y[index] = v.y;
+	z[index] = v.z;
+	w[index] = v.w;
+}
+#pragma endregion
+
+size_t VertexStreams::Size() const
+{
+	return positions.Size();
+}
+
+void VertexStreams::Resize( size_t size )
+{
+	positions.Resize( size );
+	colors.Resize( size );
+	uvs.Resize( size );
+	normals.Resize( size );
+	tangents.Resize( size );
+}
+
+namespace streamUtils
+{
+namespace
+{
+// The loops live in their own functions: __restrict is only reliably honored on parameters,
+// without it the compiler gives up on the alias checks between this many arrays
+// Matrix rows are copied into locals first -> the loops are free of calls and vectorize
+void TransformKernel( const Matrix& m,
+					  float w,
+					  size_t count,
+					  const float* __restrict pInX,
+					  const float* __restrict pInY,
+					  const float* __restrict pInZ,
+					  float* __restrict pOutX,
+					  float* __restrict pOutY,
+					  float* __restrict pOutZ )
+{
+	const Vector4 r0{ m[0] };
+	const Vector4 r1{ m[1] };
+	const Vector4 r2{ m[2] };
+	const Vector4 r3{ m[3] };
+
+	for ( size_t index{}; index < count; ++index )
+	{
+		const float x{ pInX[index] };
+		const float y{ pInY[index] };
+		const float z{ pInZ[index] };
+
+		pOutX[index] = r0.x * x + r1.x * y + r2.x * z + r3.x * w;
+		pOutY[index] = r0.y * x + r1.y * y + r2.y * z + r3.y * w;
+		pOutZ[index] = r0.z * x + r1.z * y + r2.z * z + r3.z * w;
+	}
+}
+
+void TransformKernel( const Matrix& m,
+					  size_t count,
+					  const float* __restrict pInX,
+					  const float* __restrict pInY,
+					  const float* __restrict pInZ,
+					  const float* __restrict pInW, // nullptr -> w = 1
+					  float* __restrict pOutX,
+					  float* __restrict pOutY,
+					  float* __restrict pOutZ,
+					  float* __restrict pOutW )
+{
+	const Vector4 r0{ m[0] };
+	const Vector4 r1{ m[1] };
+	const Vector4 r2{ m[2] };
+	const Vector4 r3{ m[3] };
+
+	if ( !pInW )
+	{
+		for ( size_t index{}; index < count; ++index )
+		{
+			const float x{ pInX[index] };
+			const float y{ pInY[index] };
+			const float z{ pInZ[index] };
+
+			pOutX[index] = r0.x * x + r1.x * y + r2.x * z + r3.x;
+			pOutY[index] = r0.y * x + r1.y * y + r2.y * z + r3.y;
+			pOutZ[index] = r0.z * x + r1.z * y + r2.z * z + r3.z;
+			pOutW[index] = r0.w * x + r1.w * y + r2.w * z + r3.w;
+		}
+		return;
+	}
+
+	for ( size_t index{}; index < count; ++index )
+	{
+		const float x{ pInX[index] };
+		const float y{ pInY[index] };
+		const float z{ pInZ[index] };
+		const float w{ pInW[index] };
+
+		pOutX[index] = r0.x * x + r1.x * y + r2.x * z + r3.x * w;
+		pOutY[index] = r0.y * x + r1.y * y + r2.y * z + r3.y * w;
+		pOutZ[index] = r0.z * x + r1.z * y + r2.z * z + r3.z * w;
+		pOutW[index] = r0.w * x + r1.w * y + r2.w * z + r3.w * w;
+	}
+}
+
+void NormalizeKernel( size_t count, float* __restrict pX, float* __restrict pY, float* __restrict pZ )
+{
+	for ( size_t index{}; index < count; ++index )
+	{
+		const float sqrMagnitude{ pX[index] * pX[index] + pY[index] * pY[index] + pZ[index] * pZ[index] };
+		const float inverseMagnitude{ sqrMagnitude > 0.f ? 1.f / std::sqrt( sqrMagnitude ) : 0.f };
+
+		pX[index] *= inverseMagnitude;
+		pY[index] *= inverseMagnitude;
+		pZ[index] *= inverseMagnitude;
+	}
+}
+
+void DotKernel( size_t count,
+				const float* __restrict pAX,
+				const float* __restrict pAY,
+				const float* __restrict pAZ,
+				const float* __restrict pBX,
+				const float* __restrict pBY,
+				const float* __restrict pBZ,
+				float* __restrict pOut )
+{
+	for ( size_t index{}; index < count; ++index )
+	{
+		pOut[index] = pAX[index] * pBX[index] + pAY[index] * pBY[index] + pAZ[index] * pBZ[index];
+	}
+}
+
+void CrossKernel( size_t count,
+				  const float* __restrict pAX,
+				  const float* __restrict pAY,
+				  const float* __restrict pAZ,
+				  const float* __restrict pBX,
+				  const float* __restrict pBY,
+				  const float* __restrict pBZ,
+				  float* __restrict pOutX,
+				  float* __restrict pOutY,
+				  float* __restrict pOutZ )
+{
+	for ( size_t index{}; index < count; ++index )
+	{
+		pOutX[index] = pAY[index] * pBZ[index] - pAZ[index] * pBY[index];
+		pOutY[index] = pAZ[index] * pBX[index] - pAX[index] * pBZ[index];
+		pOutZ[index] = pAX[index] * pBY[index] - pAY[index] * pBX[index];
+	}
+}
+
+// One component at a time, Vector3 and Vector4 lerps both run through this
+void LerpKernel( size_t count, const float* __restrict pA, const float* __restrict pB, float t, float* __restrict pOut )
+{
+	for ( size_t index{}; index < count; ++index )
+	{
+		pOut[index] = pA[index] + ( pB[index] - pA[index] ) * t;
+	}
+}
+} // namespace
+
+void TransformPoints( const Matrix& m, const Vector3Stream& points, Vector3Stream& out )
+{
+	out.Resize( points.Size() );
+	TransformKernel(
+		m, 1.f, points.Size(), points.x.data(), points.y.data(), points.z.data(), out.x.data(), out.y.data(), out.z.data() );
+}
+
+void TransformPoints( const Matrix& m, const Vector3Stream& points, Vector4Stream& out )
+{
+	out.Resize( points.Size() );
+	TransformKernel( m,
+					 points.Size(),
+					 points.x.data(),
+					 points.y.data(),
+					 points.z.data(),
+					 nullptr,
+					 out.x.data(),
+					 out.y.data(),
+					 out.z.data(),
+					 out.w.data() );
+}
+
+void TransformPoints( const Matrix& m, const Vector4Stream& points, Vector4Stream& out )
+{
+	out.Resize( points.Size() );
+	TransformKernel( m,
+					 points.Size(),
+					 points.x.data(),
+					 points.y.data(),
+					 points.z.data(),
+					 points.w.data(),
+					 out.x.data(),
+					 out.y.data(),
+					 out.z.data(),
+					 out.w.data() );
+}
+
+void TransformVectors( const Matrix& m, const Vector3Stream& vectors, Vector3Stream& out )
+{
+	out.Resize( vectors.Size() );
+	TransformKernel( m,
+					 0.f,
+					 vectors.Size(),
+					 vectors.x.data(),
+					 vectors.y.data(),
+					 vectors.z.data(),
+					 out.x.data(),
+					 out.y.data(),
+					 out.z.data() );
+}
+
+void Normalize( Vector3Stream& vectors )
+{
+	NormalizeKernel( vectors.Size(), vectors.x.data(), vectors.y.data(), vectors.z.data() );
+}
+
+void Dot( const Vector3Stream& a, const Vector3Stream& b, FloatStream& out )
+{
+	assert( a.Size() == b.Size() && "Streams differ in size" );
+	out.resize( a.Size() );
+	DotKernel( a.Size(), a.x.data(), a.y.data(), a.z.data(), b.x.data(), b.y.data(), b.z.data(), out.data() );
+}
+
+void Cross( const Vector3Stream& a, const Vector3Stream& b, Vector3Stream& out )
+{
+	assert( a.Size() == b.Size() && "Streams differ in size" );
+	out.Resize( a.Size() );
+	CrossKernel( a.Size(),
+				 a.x.data(),
+				 a.y.data(),
+				 a.z.data(),
+				 b.x.data(),
+				 b.y.data(),
+				 b.z.data(),
+				 out.x.data(),
+				 out.y.data(),
+				 out.z.data() );
+}
+
+void Lerp( const Vector3Stream& a, const Vector3Stream& b, float t, Vector3Stream& out )
+{
+	assert( a.Size() == b.Size() && "Streams differ in size" );
+	out.Resize( a.Size() );
+	LerpKernel( a.Size(), a.x.data(), b.x.data(), t, out.x.data() );
+	LerpKernel( a.Size(), a.y.data(), b.y.data(), t, out.y.data() );
+	LerpKernel( a.Size(), a.z.data(), b.z.data(), t, out.z.data() );
+}
+
+void Lerp( const Vector4Stream& a, const Vector4Stream& b, float t, Vector4Stream& out )
+{
+	assert( a.Size() == b.Size() && "Streams differ in size" );
+	out.Resize( a.Size() );
+	LerpKernel( a.Size(), a.x.data(), b.x.data(), t, out.x.data() );
+	LerpKernel( a.Size(), a.y.data(), b.y.data(), t, out.y.data() );
+	LerpKernel( a.Size(), a.z.data(), b.z.data(), t, out.z.data() );
+	LerpKernel( a.Size(), a.w.data(), b.w.data(), t, out.w.data() );
+}
+
+VertexStreams ToStreams( const std::vector<Vertex>& vertices )
+{
+	VertexStreams streams{};
+	streams.positions.Reserve( vertices.size() );
+	streams.colors.Reserve( vertices.size() );
+	streams.uvs.Reserve( vertices.size() );
+	streams.normals.Reserve( vertices.size() );
+	streams.tangents.Reserve( vertices.size() );
+
+	for ( const Vertex& vertex : vertices )
+	{
+		streams.positions.PushBack( vertex.position );
+		streams.colors.PushBack( { vertex.color.r, vertex.color.g, vertex.color.b } );
+		streams.uvs.PushBack( vertex.uv );
+		streams.normals.PushBack( vertex.normal );
+		streams.tangents.PushBack( vertex.tangent );
+	}
+
+	return streams;
+}
+
+std::vector<Vertex> ToVertices( const VertexStreams& streams )
+{
+	std::vector<Vertex> vertices( streams.Size() );
+	for ( size_t index{}; index < vertices.size(); ++index )
+	{
+		Vertex& vertex{ vertices[index] };
+		vertex.position = streams.positions.Get( index );
+		vertex.color = { streams.colors.x[index], streams.colors.y[index], streams.colors.z[index] };
+		vertex.uv = streams.uvs.Get( index );
+		vertex.normal = streams.normals.Get( index );
+		vertex.tangent = streams.tangents.Get( index );
+	}
+
+	return vertices;
+}
+
+void CopyRange( const VertexStreams& source, size_t first, size_t count, VertexStreams& destination, size_t destinationFirst )
+{
+	assert( first + count <= source.Size() && destinationFirst + count <= destination.Size() && "Range out of bounds" );
+	auto copyStream{ [&]( const FloatStream& from, FloatStream& to ) {
+		std::copy_n( from.begin() + first, count, to.begin() + destinationFirst );
+	} };
+
+	copyStream( source.positions.x, destination.positions.x );
+	copyStream( source.positions.y, destination.positions.y );
+	copyStream( source.positions.z, destination.positions.z );
+	copyStream( source.colors.x, destination.colors.x );
+	copyStream( source.colors.y, destination.colors.y );
+	copyStream( source.colors.z, destination.colors.z );
+	copyStream( source.uvs.x, destination.uvs.x );
+	copyStream( source.uvs.y, destination.uvs.y );
+	copyStream( source.normals.x, destination.normals.x );
+	copyStream( source.normals.y, destination.normals.y );
+	copyStream( source.normals.z, destination.normals.z );
+	copyStream( source.tangents.x, destination.tangents.x );
+	copyStream( source.tangents.y, destination.tangents.y );
+	copyStream( source.tangents.z, destination.tangents.z );
+}
+} // namespace streamUtils
+} // namespace dae
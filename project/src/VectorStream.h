@@ -0,0 +1,130 @@
+#ifndef VECTORSTREAM_H
+#define VECTORSTREAM_H
+// Structure of arrays counterparts of Vector2/3/4 for batch processing
+// Every component lives in its own aligned array, so the kernels in streamUtils are plain loops
+// the compiler vectorizes at the full width of the target (SSE, or AVX when enabled)
+#include <cstddef>
+#include <new>
+#include <vector>
+#include "Matrix.h"
+#include "Structs.h"
+
+namespace dae
+{
+template <typename T, size_t Alignment>
+class AlignedAllocator // Not final, std::vector derives from its allocator
+{
+public:
+	using value_type = T;
+
+	template <typename U>
+	struct rebind
+	{
+		using other = AlignedAllocator<U, Alignment>;
+	};
+
+	AlignedAllocator() = default;
+	template <typename U>
+	AlignedAllocator( const AlignedAllocator<U, Alignment>& ) noexcept
+	{
+	}
+
+	T* allocate( size_t count )
+	{
+		return static_cast<T*>( ::operator new( count * sizeof( T ), std::align_val_t{ Alignment } ) );
+	}
+
+	void deallocate( T* pData, size_t ) noexcept
+	{
+		::operator delete( pData, std::align_val_t{ Alignment } );
+	}
+
+	template <typename U>
+	bool operator==( const AlignedAllocator<U, Alignment>& ) const noexcept
+	{
+		return true;
+	}
+};
+
+constexpr size_t streamAlignment{ 32 }; // One AVX register
+using FloatStream = std::vector<float, AlignedAllocator<float, streamAlignment>>;
+
+struct Vector2Stream final
+{
+	FloatStream x{};
+	FloatStream y{};
+
+	size_t Size() const;
+	void Resize( size_t size );
+	void Reserve( size_t capacity );
+	void PushBack( const Vector2& v );
+
+	Vector2 Get( size_t index ) const;
+	void Set( size_t index, const Vector2& v );
+};
+
+struct Vector3Stream final
+{
+	FloatStream x{};
+	FloatStream y{};
+	FloatStream z{};
+
+	size_t Size() const;
+	void Resize( size_t size );
+	void Reserve( size_t capacity );
+	void PushBack( const Vector3& v );
+
+	Vector3 Get( size_t index ) const;
+	void Set( size_t index, const Vector3& v );
+};
+
+struct Vector4Stream final
+{
+	FloatStream x{};
+	FloatStream y{};
+	FloatStream z{};
+	FloatStream w{};
+
+	size_t Size() const;
+	void Resize( size_t size );
+	void Reserve( size_t capacity );
+	void PushBack( const Vector4& v );
+
+	Vector4 Get( size_t index ) const;
+	void Set( size_t index, const Vector4& v );
+};
+
+// Every attribute of a std::vector<Vertex>, split into streams
+struct VertexStreams final
+{
+	Vector3Stream positions{};
+	Vector3Stream colors{}; // r, g, b in x, y, z
+	Vector2Stream uvs{};
+	Vector3Stream normals{};
+	Vector3Stream tangents{};
+
+	size_t Size() const;
+	void Resize( size_t size );
+};
+
+namespace streamUtils
+{
+// Outputs are resized to match the inputs and must not be one of the input streams
+void TransformPoints( const Matrix& m, const Vector3Stream& points, Vector3Stream& out );  // w = 1
+void TransformPoints( const Matrix& m, const Vector3Stream& points, Vector4Stream& out );  // w = 1, keeps the projected w
+void TransformPoints( const Matrix& m, const Vector4Stream& points, Vector4Stream& out );
+void TransformVectors( const Matrix& m, const Vector3Stream& vectors, Vector3Stream& out ); // w = 0
+
+void Normalize( Vector3Stream& vectors ); // Zero length vectors stay zero
+void Dot( const Vector3Stream& a, const Vector3Stream& b, FloatStream& out );
+void Cross( const Vector3Stream& a, const Vector3Stream& b, Vector3Stream& out );
+void Lerp( const Vector3Stream& a, const Vector3Stream& b, float t, Vector3Stream& out );
+void Lerp( const Vector4Stream& a, const Vector4Stream& b, float t, Vector4Stream& out );
+
+VertexStreams ToStreams( const std::vector<Vertex>& vertices );
+std::vector<Vertex> ToVertices( const VertexStreams& streams );
+// Copies count vertices from source[first] to destination[destinationFirst], destination has to be large enough
+void CopyRange( const VertexStreams& source, size_t first, size_t count, VertexStreams& destination, size_t destinationFirst );
+} // namespace streamUtils
+} // namespace dae
+#endif
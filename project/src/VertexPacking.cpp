@@ -0,0 +1,229 @@
+#include "VertexPacking.h"
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cmath>
+
+namespace dae
+{
+namespace
+{
+constexpr float unormMax{ 65535.f };
+constexpr float snormMax{ 32767.f };
+
+// Bounds this thin on an axis would divide by zero, every position there packs to 0
+constexpr float minPositionScale{ 1e-6f };
+
+uint16_t ToUnorm( float value )
+{
+	return static_cast<uint16_t>( std::lround( std::clamp( value, 0.f, 1.f ) * unormMax ) );
+}
+
+int16_t ToSnorm( float value )
+{
+	return static_cast<int16_t>( std::lround( std::clamp( value, -1.f, 1.f ) * snormMax ) );
+}
+
+// -32768 and -32767 both mean -1, as in D3D11
+float FromSnorm( int16_t value )
+{
+	return std::max( value / snormMax, -1.f );
+}
+
+std::array<int16_t, 2> PackDirection( const Vector3& direction )
+{
+	const Vector2 encoded{ EncodeOctahedral( direction ) };
+	return { ToSnorm( encoded.x ), ToSnorm( encoded.y ) };
+}
+
+Vector3 UnpackDirection( const std::array<int16_t, 2>& direction )
+{
+	return DecodeOctahedral( { FromSnorm( direction[0] ), FromSnorm( direction[1] ) } );
+}
+
+// DecodeOctahedral without the normalize, for callers that normalize after transforming anyway
+// Written to compile without branches, the signs of packed directions are as good as random
+void UnfoldOctahedral( const std::array<int16_t, 2>& encoded, float* pX, float* pY, float* pZ )
+{
+	constexpr float inverseSnormMax{ 1.f / snormMax };
+	constexpr int16_t snormMin{ -32767 };
+	const float x{ std::max( encoded[0], snormMin ) * inverseSnormMax };
+	const float y{ std::max( encoded[1], snormMin ) * inverseSnormMax };
+	const float z{ 1.f - std::abs( x ) - std::abs( y ) };
+	const float fold{ ( std::abs( z ) - z ) * 0.5f }; // max( -z, 0 ), which compiles to a branch
+	*pX = x - std::copysign( fold, x );
+	*pY = y - std::copysign( fold, y );
+	*pZ = z;
+}
+} // namespace
+
+PositionDequantization PositionDequantization::FromBounds( const BoundingBox& bounds )
+{
+	const Vector3 size{ bounds.max - bounds.min };
+	return { bounds.min,
+			 { std::max( size.x, minPositionScale ),
+			   std::max( size.y, minPositionScale ),
+			   std::max( size.z, minPositionScale ) } };
+}
+
+PackedVertex PackVertex( const Vertex& vertex, const PositionDequantization& dequantization )
+{
+	const Vector3 normalized{ vertex.position - dequantization.offset };
+
+	PackedVertex packed{};
+	packed.position = { ToUnorm( normalized.x / dequantization.scale.x ),
+						ToUnorm( normalized.y / dequantization.scale.y ),
+						ToUnorm( normalized.z / dequantization.scale.z ),
+						0 };
+	packed.normal = PackDirection( vertex.normal );
+	packed.tangent = PackDirection( vertex.tangent );
+	packed.uv = { FloatToHalf( vertex.uv.x ), FloatToHalf( vertex.uv.y ) };
+	return packed;
+}
+
+Vertex UnpackVertex( const PackedVertex& vertex, const PositionDequantization& dequantization )
+{
+	Vertex unpacked{};
+	unpacked.position = { dequantization.offset.x + vertex.position[0] / unormMax * dequantization.scale.x,
+						  dequantization.offset.y + vertex.position[1] / unormMax * dequantization.scale.y,
+						  dequantization.offset.z + vertex.position[2] / unormMax * dequantization.scale.z };
+	unpacked.uv = { HalfToFloat( vertex.uv[0] ), HalfToFloat( vertex.uv[1] ) };
+	unpacked.normal = UnpackDirection( vertex.normal );
+	unpacked.tangent = UnpackDirection( vertex.tangent );
+	return unpacked;
+}
+
+std::vector<PackedVertex> PackVertices( const std::vector<Vertex>& vertices,
+										const PositionDequantization& dequantization )
+{
+	std::vector<PackedVertex> packed{};
+	packed.reserve( vertices.size() );
+	for ( const Vertex& vertex : vertices )
+	{
+		packed.push_back( PackVertex( vertex, dequantization ) );
+	}
+	return packed;
+}
+
+void UnpackRange( const std::vector<PackedVertex>& source,
+				  size_t first,
+				  size_t count,
+				  const PositionDequantization& dequantization,
+				  VertexStreams& destination,
+				  size_t destinationFirst )
+{
+	assert( first + count <= source.size() && destinationFirst + count <= destination.Size() &&
+			"Range out of bounds" );
+	const Vector3 scale{ dequantization.scale / unormMax };
+	const PackedVertex* pSource{ source.data() + first };
+
+	// Plain pointers, through the vectors every store would reload them
+	float* pPositionX{ destination.positions.x.data() + destinationFirst };
+	float* pPositionY{ destination.positions.y.data() + destinationFirst };
+	float* pPositionZ{ destination.positions.z.data() + destinationFirst };
+	float* pUvX{ destination.uvs.x.data() + destinationFirst };
+	float* pUvY{ destination.uvs.y.data() + destinationFirst };
+	float* pNormalX{ destination.normals.x.data() + destinationFirst };
+	float* pNormalY{ destination.normals.y.data() + destinationFirst };
+	float* pNormalZ{ destination.normals.z.data() + destinationFirst };
+	float* pTangentX{ destination.tangents.x.data() + destinationFirst };
+	float* pTangentY{ destination.tangents.y.data() + destinationFirst };
+	float* pTangentZ{ destination.tangents.z.data() + destinationFirst };
+	for ( size_t index{}; index < count; ++index )
+	{
+		const PackedVertex& vertex{ pSource[index] };
+		pPositionX[index] = dequantization.offset.x + vertex.position[0] * scale.x;
+		pPositionY[index] = dequantization.offset.y + vertex.position[1] * scale.y;
+		pPositionZ[index] = dequantization.offset.z + vertex.position[2] * scale.z;
+		pUvX[index] = HalfToFloat( vertex.uv[0] );
+		pUvY[index] = HalfToFloat( vertex.uv[1] );
+		UnfoldOctahedral( vertex.normal, pNormalX + index, pNormalY + index, pNormalZ + index );
+		UnfoldOctahedral( vertex.tangent, pTangentX + index, pTangentY + index, pTangentZ + index );
+	}
+
+	std::fill_n( destination.colors.x.data() + destinationFirst, count, 0.f );
+	std::fill_n( destination.colors.y.data() + destinationFirst, count, 0.f );
+	std::fill_n( destination.colors.z.data() + destinationFirst, count, 0.f );
+}
+
+uint16_t FloatToHalf( float value )
+{
+	constexpr uint32_t infinityBits{ 255u << 23 };
+	constexpr uint32_t halfOverflowBits{ ( 127u + 16u ) << 23 }; // 2^16, everything from here on rounds to infinity
+	constexpr uint32_t halfNormalBits{ 113u << 23 };			 // 2^-14, the smallest normal half
+	constexpr uint32_t denormalMagicBits{ ( ( 127u - 15u ) + ( 23u - 10u ) + 1u ) << 23 };
+
+	uint32_t bits{ std::bit_cast<uint32_t>( value ) };
+	const uint32_t sign{ bits & 0x80000000u };
+	bits ^= sign;
+
+	uint32_t half{};
+	if ( bits >= halfOverflowBits )
+	{
+		half = bits > infinityBits ? 0x7e00u : 0x7c00u; // NaN stays NaN
+	}
+	else if ( bits < halfNormalBits )
+	{
+		// Adding the magic number lines the ten mantissa bits up at the bottom, the float add does the rounding
+		const float aligned{ std::bit_cast<float>( bits ) + std::bit_cast<float>( denormalMagicBits ) };
+		half = std::bit_cast<uint32_t>( aligned ) - denormalMagicBits;
+	}
+	else
+	{
+		const uint32_t isMantissaOdd{ ( bits >> 13 ) & 1u };
+		bits += ( ( 15u - 127u ) << 23 ) + 0xfffu + isMantissaOdd; // Rebias the exponent, round half to even
+		half = bits >> 13;
+	}
+
+	return static_cast<uint16_t>( half | ( sign >> 16 ) );
+}
+
+float HalfToFloat( uint16_t half )
+{
+	constexpr uint32_t shiftedExponentMask{ 0x7c00u << 13 };
+	constexpr uint32_t denormalMagicBits{ 113u << 23 };
+
+	uint32_t bits{ ( half & 0x7fffu ) << 13 };
+	const uint32_t exponent{ bits & shiftedExponentMask };
+	bits += ( 127u - 15u ) << 23;
+
+	if ( exponent == shiftedExponentMask ) // Infinity or NaN
+	{
+		bits += ( 128u - 16u ) << 23;
+	}
+	else if ( !exponent ) // Zero or denormal, renormalized by a float subtract
+	{
+		bits += 1u << 23;
+		bits = std::bit_cast<uint32_t>( std::bit_cast<float>( bits ) - std::bit_cast<float>( denormalMagicBits ) );
+	}
+
+	return std::bit_cast<float>( bits | ( ( half & 0x8000u ) << 16 ) );
+}
+
+Vector2 EncodeOctahedral( const Vector3& direction )
+{
+	const float length{ std::abs( direction.x ) + std::abs( direction.y ) + std::abs( direction.z ) };
+	if ( length == 0.f )
+	{
+		return {};
+	}
+
+	// Onto the octahedron, then the lower half folds out over the corners
+	const Vector2 upper{ direction.x / length, direction.y / length };
+	if ( direction.z >= 0.f )
+	{
+		return upper;
+	}
+	return { ( 1.f - std::abs( upper.y ) ) * ( upper.x >= 0.f ? 1.f : -1.f ),
+			 ( 1.f - std::abs( upper.x ) ) * ( upper.y >= 0.f ? 1.f : -1.f ) };
+}
+
+Vector3 DecodeOctahedral( const Vector2& encoded )
+{
+	Vector3 direction{ encoded.x, encoded.y, 1.f - std::abs( encoded.x ) - std::abs( encoded.y ) };
+	const float fold{ std::max( -direction.z, 0.f ) };
+	direction.x += direction.x >= 0.f ? -fold : fold;
+	direction.y += direction.y >= 0.f ? -fold : fold;
+	return direction.Normalized();
+}
+} // namespace dae
@@ -0,0 +1,62 @@
+#ifndef VERTEXPACKING_H
+#define VERTEXPACKING_H
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "BoundingVolumes.h"
+#include "VectorStream.h"
+
+// Compact vertex storage, 20 bytes against the 56 of Vertex
+// Positions are normalized within the mesh bounds, normal and tangent are octahedral, uvs are half floats
+// Vertex color is left out, neither backend shades with it
+
+namespace dae
+{
+enum class VertexFormat
+{
+	full,	// Vertex as loaded, 32-bit floats throughout
+	packed, // PackedVertex, decoded in the vertex stage of either backend
+};
+
+// Layout matches the packed input layout in Effect
+struct PackedVertex final
+{
+	std::array<uint16_t, 4> position{}; // UNORM within the bounds, the fourth only pads to a format D3D11 reads
+	std::array<int16_t, 2> normal{};	// SNORM octahedral
+	std::array<int16_t, 2> tangent{};	// SNORM octahedral
+	std::array<uint16_t, 2> uv{};		// Half floats
+};
+static_assert( sizeof( PackedVertex ) == 20, "PackedVertex has to match the packed input layout" );
+
+// Model space position = offset + normalized position * scale
+struct PositionDequantization final
+{
+	Vector3 offset{};
+	Vector3 scale{};
+
+	static PositionDequantization FromBounds( const BoundingBox& bounds );
+};
+
+PackedVertex PackVertex( const Vertex& vertex, const PositionDequantization& dequantization );
+Vertex UnpackVertex( const PackedVertex& vertex, const PositionDequantization& dequantization ); // Color is black
+std::vector<PackedVertex> PackVertices( const std::vector<Vertex>& vertices,
+										const PositionDequantization& dequantization );
+
+// Decodes count vertices from source[first] into destination[destinationFirst], destination has to be large enough
+// Normals and tangents come out unnormalized, Renderer::Project normalizes them once transformed
+void UnpackRange( const std::vector<PackedVertex>& source,
+				  size_t first,
+				  size_t count,
+				  const PositionDequantization& dequantization,
+				  VertexStreams& destination,
+				  size_t destinationFirst );
+
+// Round to nearest even, out of range values become infinity
+uint16_t FloatToHalf( float value );
+float HalfToFloat( uint16_t half );
+
+// Unit direction to a point in [-1, 1]^2 and back, the decoded direction is normalized
+Vector2 EncodeOctahedral( const Vector3& direction );
+Vector3 DecodeOctahedral( const Vector2& encoded );
+} // namespace dae
+#endif
@@ -21,6 +21,11 @@
 // Project includes
 #include "Timer.h"
 #include "Renderer.h"
+#include "CommandLine.h"
+#include "Headless.h"
+#include "JobSystem.h"
+#include "Benchmark.h"
+#include "Profiler.h"
 #if defined( _DEBUG )
 #	include "LeakDetector.h"
 #endif
@@ -47,53 +52,60 @@ void DisplayHelp()
 			  << "[F11]: Toggle FPS\n"
 			  << "[F12]: Show Help (This)\n\n"
 
-			  << "[F3]: Toggle Fire Effect (Hardware Only)\n"
-			  << "[F4]: Cycle Sampling Method (Hardware Only)\n\n"
+			  << "[F3]: Toggle Fire Effect\n"
+			  << "[F4]: Cycle Sampling Method\n"
+			  << "[L]: Toggle Mesh LODs\n\n"
 
 			  << "[F5]: Cycle Shading Mode(Software Only)\n"
 			  << "[F6]: Toggle Normal Map(Software Only)\n"
 			  << "[F7]: Toggle Depth Buffer Visualization (Software Only)\n"
-			  << "[F8]: Toggle Bounding Box Visualization (Software Only)\n";
+			  << "[F8]: Toggle Bounding Box Visualization (Software Only)\n"
+			  << "[F9]: Cycle Present Mode (Software Only)\n\n"
+
+			  << "[M]: Toggle Fast Math (Software Only)\n"
+			  << "[N]: Toggle 4x MSAA (Software Only)\n"
+			  << "[I]: Toggle Incremental Rendering (Software Only)\n"
+			  << "[R]: Toggle Dynamic Resolution (Software Only)\n"
+			  << "[V]: Toggle Variable Rate Shading (Software Only)\n"
+			  << "[Middle Mouse]: Pick Mesh Under Cursor\n"
+			  << "[P]: Write Profiler Trace (Profiling Builds Only)\n";
 }
 
-int main( int argc, char* args[] )
+// Everything that uses the window, destroyed before the window is
+int RunWindowed( SDL_Window* pWindow, const LaunchOptions& options )
 {
-	// Unreferenced parameters
-	(void)argc;
-	(void)args;
-
-// Leak detection
-#if defined( _DEBUG )
-	LeakDetector detector{};
-#endif
-
-	// Create window + surfaces
-	SDL_Init( SDL_INIT_VIDEO );
-
-	const uint32_t width = 640;
-	const uint32_t height = 480;
-
-	const SDL_WindowFlags windowFlags{};
-
-	SDL_Window* pWindow = SDL_CreateWindow(
-		"DirectX - Luna Pype/GD11", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, width, height, windowFlags );
-
-	if ( !pWindow )
-		return 1;
+	const uint32_t width = options.width;
+	const uint32_t height = options.height;
 
 	// Initialize "framework"
 	Timer timer{};
-	Renderer renderer{ pWindow };
+	JobSystem jobSystem{ options.threadCount };
+	Renderer renderer{ pWindow, jobSystem };
 
 	// Initialize scene
 	std::vector<std::unique_ptr<Scene>> scenePtrs{}; // allows for multiple scenes in a project
-	scenePtrs.push_back( std::make_unique<VehicleScene>() );
-	error::utils::HandleThrowingFunction( [&]() {
+	const bool failedInit{ error::utils::HandleThrowingFunction( [&]() {
+		scenePtrs.push_back( Scene::Create( options.sceneName, options.vertexFormat ) );
 		for ( auto& pScene : scenePtrs )
 		{
 			renderer.InitScene( pScene.get() );
+			pScene->SetFilterMode( options.filterMode );
 		}
-	} );
+	} ) };
+	if ( failedInit )
+	{
+		return 1;
+	}
+	renderer.SetLightingMode( options.lightingMode );
+	renderer.SetMathPrecision( options.mathPrecision );
+	renderer.SetMultisampling( options.useMultisampling );
+	renderer.SetIncrementalRendering( options.useIncrementalRendering );
+	renderer.SetVariableRateShading( options.useVariableRateShading );
+	if ( options.frameBudgetMs > 0.f )
+	{
+		renderer.SetFrameBudget( options.frameBudgetMs );
+		renderer.SetDynamicResolution( true );
+	}
 	// TODO:Add scene switching
 	size_t sceneIdx{ 0 };
 
@@ -101,6 +113,10 @@ int main( int argc, char* args[] )
 
 	// Start loop
 	timer.Start();
+	if ( options.usePipelining )
+	{
+		scenePtrs[sceneIdx]->Update( &timer );
+	}
 	float printTimer = 0.f;
 	bool isLooping = true;
 	DisplayHelp();
@@ -135,17 +151,45 @@ int main( int argc, char* args[] )
 				{
 					DisplayHelp();
 				}
+
+				if ( e.key.keysym.scancode == SDL_SCANCODE_P )
+				{
+					profiler::DumpChromeTrace( options.tracePath.empty() ? "trace.json" : options.tracePath );
+				}
+				break;
+			case SDL_MOUSEBUTTONUP:
+				if ( e.button.button == SDL_BUTTON_MIDDLE )
+				{
+					const float ndcX{ 2.f * ( e.button.x + 0.5f ) / width - 1.f };
+					const float ndcY{ 1.f - 2.f * ( e.button.y + 0.5f ) / height };
+					const Camera& camera{ scenePtrs[sceneIdx]->GetCamera() };
+					const int meshIdx{ scenePtrs[sceneIdx]->PickMesh( camera.GetRay( ndcX, ndcY ), camera.GetFar() ) };
+					if ( meshIdx >= 0 )
+					{
+						std::cout << "Picked mesh " << meshIdx << '\n';
+					}
+					else
+					{
+						std::cout << "Picked nothing\n";
+					}
+				}
 				break;
 			default:;
 			}
 		}
 
-		//--------- Update ---------
+		//--------- Update + Render ---------
 		// hardwareRenderer.Update( timer );
-		scenePtrs[sceneIdx]->Update( &timer );
-
-		//--------- Render ---------
-		renderer.Render( scenePtrs[sceneIdx].get() );
+		if ( options.usePipelining )
+		{
+			// Draws what the last iteration updated while the next update runs
+			renderer.Render( scenePtrs[sceneIdx].get(), [&]() { scenePtrs[sceneIdx]->Update( &timer ); } );
+		}
+		else
+		{
+			scenePtrs[sceneIdx]->Update( &timer );
+			renderer.Render( scenePtrs[sceneIdx].get() );
+		}
 
 		//--------- Timer ----------
 		timer.Update();
@@ -158,5 +202,66 @@ int main( int argc, char* args[] )
 	}
 	timer.Stop();
 
+	if ( !options.tracePath.empty() )
+	{
+		profiler::DumpChromeTrace( options.tracePath );
+	}
+
+	return 0;
+}
+
+int main( int argc, char* args[] )
+{
+// Leak detection
+#if defined( _DEBUG )
+	LeakDetector detector{};
+#endif
+
+	// Parse command line
+	LaunchOptions options{};
+	if ( error::utils::HandleThrowingFunction( [&]() { options = ParseCommandLine( argc, args ); } ) )
+	{
+		DisplayUsage();
+		return 1;
+	}
+
+	if ( options.showHelp )
+	{
+		DisplayUsage();
+		return 0;
+	}
+
+	if ( options.isBenchmark )
+	{
+		return RunBenchmark( options );
+	}
+
+	if ( options.isPrecisionComparison )
+	{
+		return RunPrecisionComparison( options );
+	}
+
+	if ( options.isHeadless )
+	{
+		return RunHeadless( options );
+	}
+
+	// Create window + surfaces
+	SDL_Init( SDL_INIT_VIDEO );
+	profiler::SetThreadName( "Main" );
+
+	const uint32_t width = options.width;
+	const uint32_t height = options.height;
+
+	const SDL_WindowFlags windowFlags{};
+
+	SDL_Window* pWindow = SDL_CreateWindow(
+		"DirectX - Luna Pype/GD11", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, width, height, windowFlags );
+
+	if ( !pWindow )
+		return 1;
+
+	const int exitCode{ RunWindowed( pWindow, options ) };
 	ShutDown( pWindow );
+	return exitCode;
 }